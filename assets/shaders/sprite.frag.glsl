@@ -1,9 +1,9 @@
-#version 460
+#version 450
 
 in vec4 tint;
-in vec2 texture_coord;
+in vec3 texture_coord;
 
-uniform sampler2D sprite_sheet;
+uniform sampler2DArray sprite_sheet;
 
 out vec4 colour;
 
@@ -0,0 +1,84 @@
+#version 450
+
+layout (local_size_x = 64) in;
+
+// Sprites are copied as raw words, so the pass only needs to know where the
+// corners of a sprite are, not the rest of the renderer's format.
+layout (std430, binding = 0) readonly buffer input_sprites
+{
+    uint sprites[];
+};
+
+layout (std430, binding = 1) writeonly buffer visible_sprites
+{
+    uint visible[];
+};
+
+// Layout mandated by glDrawArraysIndirect.
+layout (std430, binding = 2) buffer draw_command
+{
+    uint count;
+    uint instance_count;
+    uint first;
+    uint base_instance;
+};
+
+uniform uint sprite_count;
+uniform uint words_per_sprite;
+
+// Instances start with their centre and half size. Expanded quads start with
+// the bottom left vertex, followed by the top right one vertex_words later.
+uniform bool instanced;
+uniform uint vertex_words;
+
+uniform vec2 view_min;
+uniform vec2 view_max;
+
+vec2 read_vec2(uint word)
+{
+    return vec2(uintBitsToFloat(sprites[word]), uintBitsToFloat(sprites[word + 1]));
+}
+
+void main()
+{
+    uint sprite = gl_GlobalInvocationID.x;
+    if (sprite >= sprite_count)
+    {
+        return;
+    }
+
+    uint first_word = sprite * words_per_sprite;
+
+    vec2 lower;
+    vec2 upper;
+    if (instanced)
+    {
+        vec2 centre = read_vec2(first_word);
+        vec2 half_size = read_vec2(first_word + 2);
+        lower = centre - half_size;
+        upper = centre + half_size;
+    }
+    else
+    {
+        vec2 bottom_left = read_vec2(first_word);
+        vec2 top_right = read_vec2(first_word + vertex_words);
+        lower = min(bottom_left, top_right);
+        upper = max(bottom_left, top_right);
+    }
+
+    if (any(greaterThan(lower, view_max)) || any(lessThan(upper, view_min)))
+    {
+        return;
+    }
+
+    // Survivors are not kept in order, which only matters for sprites that
+    // overlap each other.
+    uint slot = instanced ? atomicAdd(instance_count, 1u)
+                          : atomicAdd(count, 6u) / 6u;
+
+    uint visible_word = slot * words_per_sprite;
+    for (uint word = 0; word < words_per_sprite; ++word)
+    {
+        visible[visible_word + word] = sprites[first_word + word];
+    }
+}
@@ -0,0 +1,27 @@
+#version 450
+
+layout (location = 0) in vec2 centre;
+layout (location = 1) in vec2 half_size;
+layout (location = 2) in vec4 colour;
+layout (location = 3) in vec4 uv_bounds;
+layout (location = 4) in float layer;
+
+uniform mat4 projection;
+
+out vec4 tint;
+out vec3 texture_coord;
+
+// Same winding as the expanded vertex path: BL, TR, TL, BL, BR, TR.
+const vec2 corners[6] = vec2[](
+    vec2(0, 1), vec2(1, 0), vec2(0, 0),
+    vec2(0, 1), vec2(1, 1), vec2(1, 0)
+);
+
+void main()
+{
+    vec2 corner = corners[gl_VertexID];
+
+    gl_Position = projection * vec4(mix(centre - half_size, centre + half_size, corner), 0, 1);
+    tint = colour;
+    texture_coord = vec3(mix(uv_bounds.xy, uv_bounds.zw, corner), layer);
+}
@@ -0,0 +1,65 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#ifndef YABOC_INCLUDE_YABOC_APP_OPTIONS_H
+#define YABOC_INCLUDE_YABOC_APP_OPTIONS_H
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string_view>
+
+namespace yaboc::app
+{
+constexpr int          default_headless_frames{120};
+constexpr std::uint8_t default_channel_tolerance{2};
+constexpr double       default_max_differing_pixels{0.001};
+
+// Used when it exists and no other pack is given.
+constexpr std::string_view default_pack_file{"yaboc.pack"};
+
+struct options final
+{
+	bool headless{};
+	int  frames{default_headless_frames};
+	// Where to write the headless frames, and where to find the goldens to
+	// compare them against.
+	std::filesystem::path capture_directory{};
+	std::filesystem::path golden_directory{};
+	std::uint8_t          channel_tolerance{default_channel_tolerance};
+	// Fraction of the pixels of a frame that may exceed the tolerance.
+	double max_differing_pixels{default_max_differing_pixels};
+	// Where to dump the timings of every frame.
+	std::filesystem::path profile_csv{};
+	// Where linked shader programs are kept between runs. Windowed runs fall
+	// back to the user's preference directory, headless ones to no cache.
+	std::filesystem::path shader_cache{};
+	bool                  no_shader_cache{};
+	// Print where the time went before the first frame.
+	bool startup_timeline{};
+	// Cooked assets to use instead of the loose files. Windowed runs fall
+	// back to default_pack_file, headless ones to the loose files.
+	std::filesystem::path pack{};
+};
+
+void print_usage(std::string_view program);
+
+// Empty if an argument is unknown, or its value is missing or malformed.
+[[nodiscard]]
+auto parse_options(std::span<char*> arguments) -> std::optional<options>;
+} // namespace yaboc::app
+
+#endif // YABOC_INCLUDE_YABOC_APP_OPTIONS_H
@@ -0,0 +1,156 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#ifndef YABOC_INCLUDE_YABOC_ASSETS_ASSET_PACK_H
+#define YABOC_INCLUDE_YABOC_ASSETS_ASSET_PACK_H
+
+#include "yaboc/assets/level_grid.h"
+#include "yaboc/assets/pack_format.h"
+
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string_view>
+
+namespace yaboc::assets
+{
+// The frames of a sprite sheet, as cooked from its TexturePacker JSON.
+struct frame_table_view final
+{
+	std::span<packed_frame const> frames{};
+	std::string_view              names{};
+	std::string_view              texture{};
+	int                           width{};
+	int                           height{};
+
+	[[nodiscard]]
+	auto name(packed_frame const& frame) const -> std::string_view
+	{
+		return names.substr(frame.name_offset, frame.name_size);
+	}
+};
+
+struct texture_level_view final
+{
+	int                         width{};
+	int                         height{};
+	// Laid out as the texture's format says, see texture_format.
+	std::span<std::byte const> pixels{};
+};
+
+// A texture and its whole mip chain, ready to be handed to GL.
+class texture_view final
+{
+	packed_texture_header const*          m_header{};
+	std::span<packed_texture_level const> m_levels{};
+	std::span<std::byte const>            m_blob{};
+
+public:
+	texture_view(packed_texture_header const&          header,
+	             std::span<packed_texture_level const> levels,
+	             std::span<std::byte const>            blob)
+	    : m_header{&header}
+	    , m_levels{levels}
+	    , m_blob{blob}
+	{}
+
+	[[nodiscard]]
+	auto format() const -> texture_format
+	{
+		return m_header->format;
+	}
+
+	[[nodiscard]]
+	auto width() const -> int
+	{
+		return m_header->width;
+	}
+
+	[[nodiscard]]
+	auto height() const -> int
+	{
+		return m_header->height;
+	}
+
+	[[nodiscard]]
+	auto level_count() const -> std::size_t
+	{
+		return std::size(m_levels);
+	}
+
+	[[nodiscard]]
+	auto level(std::size_t index) const -> texture_level_view
+	{
+		auto const& level = m_levels[index];
+		return {.width = level.width,
+		        .height = level.height,
+		        .pixels = m_blob.subspan(level.offset, level.size)};
+	}
+};
+
+// A pack written by yaboc_cook, mapped into memory. Every view points
+// straight into the mapping and stays valid for as long as the pack does.
+class asset_pack final
+{
+	std::byte const* m_data{};
+	std::size_t      m_size{};
+	// Only used on Windows, where the mapping needs its own handle.
+	void* m_mapping_handle{};
+
+	std::span<pack_entry const> m_entries{};
+	std::string_view            m_names{};
+
+	[[nodiscard]]
+	auto find(std::string_view name, pack_entry_kind kind) const
+	    -> std::optional<std::span<std::byte const>>;
+
+	[[nodiscard]]
+	auto entry_name(pack_entry const& entry) const -> std::string_view;
+
+	void unmap();
+
+public:
+	~asset_pack();
+
+	// Throws std::runtime_error if the file cannot be mapped, or was not
+	// written by this version of yaboc_cook.
+	explicit asset_pack(std::filesystem::path const& path);
+
+	asset_pack(asset_pack const&) = delete;
+	auto operator=(asset_pack const&) -> asset_pack& = delete;
+
+	asset_pack(asset_pack&& other) noexcept;
+	auto operator=(asset_pack&& other) noexcept -> asset_pack&;
+
+	// Each returns std::nullopt if the pack has no such entry, or the entry
+	// is malformed.
+	[[nodiscard]]
+	auto sprite_frames(std::string_view name) const
+	    -> std::optional<frame_table_view>;
+
+	[[nodiscard]]
+	auto texture(std::string_view name) const -> std::optional<texture_view>;
+
+	[[nodiscard]]
+	auto level(std::string_view name) const -> std::optional<level_grid>;
+
+	[[nodiscard]]
+	auto shader(std::string_view name) const
+	    -> std::optional<std::string_view>;
+};
+} // namespace yaboc::assets
+
+#endif // YABOC_INCLUDE_YABOC_ASSETS_ASSET_PACK_H
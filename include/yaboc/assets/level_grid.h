@@ -0,0 +1,65 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#ifndef YABOC_INCLUDE_YABOC_ASSETS_LEVEL_GRID_H
+#define YABOC_INCLUDE_YABOC_ASSETS_LEVEL_GRID_H
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <span>
+#include <vector>
+
+namespace yaboc::assets
+{
+// The brick type of every cell of a level, row by row. Type 0 is a gap.
+struct level_grid final
+{
+	int                           columns{};
+	int                           rows{};
+	std::span<std::uint8_t const> cells{};
+
+	[[nodiscard]]
+	auto at(int column, int row) const -> std::uint8_t
+	{
+		assert(column >= 0 && column < columns && row >= 0 && row < rows);
+		return cells[static_cast<std::size_t>(row) *
+		                 static_cast<std::size_t>(columns) +
+		             static_cast<std::size_t>(column)];
+	}
+};
+
+// A level read from its text form, for when there is no cooked pack.
+struct level_data final
+{
+	int                       columns{};
+	int                       rows{};
+	std::vector<std::uint8_t> cells{};
+
+	[[nodiscard]]
+	auto grid() const -> level_grid
+	{
+		return {.columns = columns, .rows = rows, .cells = cells};
+	}
+};
+
+// One row per line, with whitespace between the brick types. Short rows are
+// padded with gaps.
+[[nodiscard]]
+auto parse_level(std::istream& text) -> level_data;
+} // namespace yaboc::assets
+
+#endif // YABOC_INCLUDE_YABOC_ASSETS_LEVEL_GRID_H
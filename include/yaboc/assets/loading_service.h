@@ -0,0 +1,69 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#ifndef YABOC_INCLUDE_YABOC_ASSETS_LOADING_SERVICE_H
+#define YABOC_INCLUDE_YABOC_ASSETS_LOADING_SERVICE_H
+
+#include "yaboc/assets/asset_pack.h"
+#include "yaboc/assets/level_grid.h"
+#include "yaboc/core/thread_pool.h"
+#include "yaboc/graphics/image.h"
+
+#include <chrono>
+#include <cstddef>
+#include <future>
+#include <string>
+#include <vector>
+
+namespace yaboc::assets
+{
+// Reads and decodes assets on worker threads while the game keeps running.
+// Requests may be made from any thread. Their results are meant to be polled
+// with is_ready() once a frame, so that no frame ever waits for a file.
+// Failures are thrown from the future's get().
+class loading_service final
+{
+	asset_pack const* m_pack{};
+
+	core::thread_pool m_workers;
+
+public:
+	static constexpr std::size_t default_thread_count{2};
+
+	// Levels come from the pack when it has them. The pack must outlive the
+	// service.
+	explicit loading_service(asset_pack const* pack,
+	                         std::size_t thread_count = default_thread_count);
+
+	[[nodiscard]]
+	auto load_level(std::string path) -> std::future<level_data>;
+
+	// Decoded to RGBA8, in the order of the paths.
+	[[nodiscard]]
+	auto load_images(std::vector<std::string> paths)
+	    -> std::future<std::vector<graphics::image>>;
+};
+
+// True once a request has finished, without waiting for it.
+template <class T>
+[[nodiscard]]
+auto is_ready(std::future<T> const& result) -> bool
+{
+	return result.valid() && result.wait_for(std::chrono::seconds{0}) ==
+	                             std::future_status::ready;
+}
+} // namespace yaboc::assets
+
+#endif // YABOC_INCLUDE_YABOC_ASSETS_LOADING_SERVICE_H
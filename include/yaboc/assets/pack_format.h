@@ -0,0 +1,154 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#ifndef YABOC_INCLUDE_YABOC_ASSETS_PACK_FORMAT_H
+#define YABOC_INCLUDE_YABOC_ASSETS_PACK_FORMAT_H
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// The layout of a cooked asset pack, shared by yaboc_cook and the runtime.
+// Everything is little-endian and used in place, so only plain structs with
+// explicit padding belong here. Bump pack_version whenever any of them
+// changes.
+//
+//   pack_header
+//   blobs, each starting on a pack_alignment boundary
+//   pack_entry[entry_count], sorted by name
+//   names of the entries, back to back
+namespace yaboc::assets
+{
+static_assert(std::endian::native == std::endian::little,
+              "asset packs are read in place");
+
+inline constexpr std::array<char, 4> pack_magic{'Y', 'P', 'A', 'K'};
+inline constexpr std::uint32_t       pack_version{2};
+// Enough for any GL upload and for a cache line.
+inline constexpr std::size_t pack_alignment{64};
+
+enum class pack_entry_kind : std::uint32_t
+{
+	// packed_frame_table_header, packed_frame[frame_count], names
+	sprite_frames,
+	// packed_texture_header, packed_texture_level[level_count], texels
+	texture,
+	// packed_level_header, one brick type per cell, row by row
+	level,
+	// GLSL source, null terminated
+	shader
+};
+
+struct pack_header final
+{
+	std::array<char, 4> magic{pack_magic};
+	std::uint32_t       version{pack_version};
+	std::uint32_t       entry_count{};
+	std::uint32_t       names_size{};
+	std::uint64_t       directory_offset{};
+};
+
+struct pack_entry final
+{
+	// Into the names following the directory. Names are the paths the loose
+	// files have in the source tree, such as assets/shaders/sprite.frag.glsl.
+	std::uint32_t   name_offset{};
+	std::uint32_t   name_size{};
+	pack_entry_kind kind{};
+	std::uint32_t   padding{};
+	std::uint64_t   offset{};
+	std::uint64_t   size{};
+};
+
+struct packed_frame_table_header final
+{
+	std::uint32_t frame_count{};
+	std::uint32_t names_size{};
+	// Path of the texture entry the frames are in.
+	std::uint32_t texture_name_offset{};
+	std::uint32_t texture_name_size{};
+	std::int32_t  width{};
+	std::int32_t  height{};
+};
+
+struct packed_frame final
+{
+	std::int32_t  min_x{};
+	std::int32_t  min_y{};
+	std::int32_t  max_x{};
+	std::int32_t  max_y{};
+	std::int32_t  size_x{};
+	std::int32_t  size_y{};
+	std::uint32_t name_offset{};
+	std::uint32_t name_size{};
+};
+
+enum class texture_format : std::uint32_t
+{
+	// Four bytes per texel, row by row.
+	rgba8,
+	// BPTC: 16 bytes per 4x4 block, blocks row by row. Levels smaller than a
+	// block still take a whole one.
+	bc7
+};
+
+struct packed_texture_header final
+{
+	texture_format format{};
+	std::int32_t   width{};
+	std::int32_t   height{};
+	std::uint32_t  level_count{};
+};
+
+struct packed_texture_level final
+{
+	std::int32_t  width{};
+	std::int32_t  height{};
+	// From the start of the blob.
+	std::uint64_t offset{};
+	std::uint64_t size{};
+};
+
+struct packed_level_header final
+{
+	std::int32_t columns{};
+	std::int32_t rows{};
+};
+
+[[nodiscard]]
+constexpr auto align_to_pack(std::uint64_t offset) -> std::uint64_t
+{
+	return (offset + pack_alignment - 1) / pack_alignment * pack_alignment;
+}
+
+namespace detail
+{
+template <class T>
+inline constexpr bool packable = std::is_trivially_copyable_v<T> &&
+                                 std::has_unique_object_representations_v<T>;
+} // namespace detail
+
+static_assert(detail::packable<pack_header>);
+static_assert(detail::packable<pack_entry>);
+static_assert(detail::packable<packed_frame_table_header>);
+static_assert(detail::packable<packed_frame>);
+static_assert(detail::packable<packed_texture_header>);
+static_assert(detail::packable<packed_texture_level>);
+static_assert(detail::packable<packed_level_header>);
+} // namespace yaboc::assets
+
+#endif // YABOC_INCLUDE_YABOC_ASSETS_PACK_FORMAT_H
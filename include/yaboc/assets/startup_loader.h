@@ -0,0 +1,89 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#ifndef YABOC_INCLUDE_YABOC_ASSETS_STARTUP_LOADER_H
+#define YABOC_INCLUDE_YABOC_ASSETS_STARTUP_LOADER_H
+
+#include "yaboc/assets/asset_pack.h"
+#include "yaboc/assets/level_grid.h"
+#include "yaboc/core/thread_pool.h"
+#include "yaboc/graphics/image.h"
+#include "yaboc/profiling/startup_timeline.h"
+#include "yaboc/sprite/sprite_sheet.h"
+#include "yaboc/sprite/sprite_sheet_array.h"
+
+#include <cstddef>
+#include <future>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace yaboc::assets
+{
+// The assets the game starts with. Packs name their entries after these
+// paths too.
+constexpr std::string_view sprite_sheet_file{
+    "assets/data/sprites/sprite_sheet.json"};
+constexpr std::string_view level_file{"assets/data/levels/level_01.txt"};
+
+// Reads and decodes the startup assets on worker threads, so that the main
+// thread can bring up SDL and OpenGL in the meantime. Assets found in the
+// pack are used in place and need no work at all.
+class startup_loader final
+{
+	struct sprite_sheet_files final
+	{
+		std::vector<sprite::sprite_sheet> sheets{};
+		std::vector<graphics::image>      images{};
+		std::vector<texture_view>         textures{};
+	};
+
+	// One for the sprite sheets and one for the level.
+	static constexpr std::size_t thread_count{2};
+
+	profiling::startup_timeline* m_timeline{};
+	asset_pack const*            m_pack{};
+
+	// First, so that it outlives the futures.
+	core::thread_pool m_workers{thread_count};
+
+	std::future<sprite_sheet_files> m_sprite_sheets{};
+	std::future<level_data>         m_level{};
+	std::optional<level_grid>       m_cooked_level{};
+	level_data                      m_parsed_level{};
+
+	template <class T>
+	auto wait(std::future<T>& result, std::string name) -> T;
+
+	static auto cooked_sprite_sheets(asset_pack const* pack)
+	    -> std::optional<sprite_sheet_files>;
+
+public:
+	// The pack, if any, must outlive the loader.
+	startup_loader(profiling::startup_timeline& timeline,
+	               asset_pack const*            pack);
+
+	// Waits for the files and uploads them; needs the GL context.
+	[[nodiscard]]
+	auto sprite_sheets() -> sprite::sprite_sheet_array;
+
+	// Valid for as long as the loader and the pack are.
+	[[nodiscard]]
+	auto level() -> level_grid;
+};
+} // namespace yaboc::assets
+
+#endif // YABOC_INCLUDE_YABOC_ASSETS_STARTUP_LOADER_H
@@ -0,0 +1,182 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#ifndef YABOC_INCLUDE_YABOC_CORE_PERFECT_HASH_H
+#define YABOC_INCLUDE_YABOC_CORE_PERFECT_HASH_H
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+// A minimal perfect hash over a fixed set of strings: every key maps to its
+// own index below the number of keys, after two hashes and no probing. It is
+// built by hash and displace. Keys are put into as many buckets as there are
+// keys, and each bucket, largest first, gets the first seed that sends all of
+// its keys to free indices. A table from index to the key's position in the
+// original set then gives the position itself.
+//
+// Strings that are not keys map to some position as well, so compare with
+// the key found there before trusting it.
+namespace yaboc::core
+{
+[[nodiscard]]
+constexpr auto perfect_hash_mix(std::string_view text, std::uint32_t seed)
+    -> std::uint32_t
+{
+	// FNV-1a, finished like MurmurHash3 so that every seed gives unrelated
+	// results.
+	std::uint32_t hash{2'166'136'261U ^ seed};
+	for (auto const character: text)
+	{
+		hash ^= static_cast<std::uint8_t>(character);
+		hash *= 16'777'619U;
+	}
+	hash ^= hash >> 16;
+	hash *= 0x85EB'CA6BU;
+	hash ^= hash >> 13;
+	hash *= 0xC2B2'AE35U;
+	hash ^= hash >> 16;
+	return hash;
+}
+
+// The index of key, given the seeds build_perfect_hash() chose. There must be
+// at least one.
+[[nodiscard]]
+constexpr auto perfect_hash_index(std::span<std::uint32_t const> seeds,
+                                  std::string_view               key)
+    -> std::size_t
+{
+	assert(!std::empty(seeds));
+	auto const count = std::size(seeds);
+	auto const bucket = perfect_hash_mix(key, 0) % count;
+	return perfect_hash_mix(key, seeds[bucket]) % count;
+}
+
+// The position in the original keys of the key that text would be.
+[[nodiscard]]
+constexpr auto perfect_hash_position(std::span<std::uint32_t const> seeds,
+                                     std::span<std::uint32_t const> positions,
+                                     std::string_view               text)
+    -> std::size_t
+{
+	return positions[perfect_hash_index(seeds, text)];
+}
+
+// Fills one seed and one position per key. Throws std::invalid_argument if a
+// key appears twice, as no seed could ever tell the copies apart.
+constexpr void build_perfect_hash(std::span<std::string_view const> keys,
+                                  std::span<std::uint32_t>          seeds,
+                                  std::span<std::uint32_t>          positions)
+{
+	assert(std::size(seeds) == std::size(keys));
+	assert(std::size(positions) == std::size(keys));
+	auto const count = std::size(keys);
+
+	std::vector<std::vector<std::size_t>> buckets(count);
+	for (std::size_t key{}; key < count; ++key)
+	{
+		buckets[perfect_hash_mix(keys[key], 0) % count].push_back(key);
+	}
+
+	std::vector<std::size_t> order(count);
+	std::iota(std::begin(order), std::end(order), std::size_t{});
+	// Ties in bucket order, as the seeds depend on it.
+	std::ranges::sort(order, [&buckets](std::size_t left, std::size_t right) {
+		auto const left_size = std::size(buckets[left]);
+		auto const right_size = std::size(buckets[right]);
+		return left_size != right_size ? left_size > right_size : left < right;
+	});
+
+	std::vector<bool>        taken(count);
+	std::vector<std::size_t> indices{};
+	for (auto const bucket: order)
+	{
+		auto const& members = buckets[bucket];
+		if (std::empty(members))
+		{
+			break;
+		}
+
+		for (auto first = std::begin(members); first != std::end(members);
+		     ++first)
+		{
+			if (std::any_of(std::next(first),
+			                std::end(members),
+			                [&](std::size_t other) {
+				                return keys[other] == keys[*first];
+			                }))
+			{
+				throw std::invalid_argument{"perfect hash keys must be unique"};
+			}
+		}
+
+		for (std::uint32_t seed{1};; ++seed)
+		{
+			indices.clear();
+			auto const placed = std::ranges::all_of(members, [&](auto key) {
+				auto const index = perfect_hash_mix(keys[key], seed) % count;
+				if (taken[index] ||
+				    std::ranges::find(indices, index) != std::end(indices))
+				{
+					return false;
+				}
+				indices.push_back(index);
+				return true;
+			});
+
+			if (placed)
+			{
+				for (std::size_t member{}; member < std::size(members);
+				     ++member)
+				{
+					taken[indices[member]] = true;
+					positions[indices[member]] =
+					    static_cast<std::uint32_t>(members[member]);
+				}
+				seeds[bucket] = seed;
+				break;
+			}
+		}
+	}
+}
+
+template <std::size_t Count>
+struct static_perfect_hash final
+{
+	std::array<std::uint32_t, Count> seeds{};
+	std::array<std::uint32_t, Count> positions{};
+};
+
+// The same, done while compiling.
+template <std::size_t Count>
+[[nodiscard]]
+consteval auto
+make_perfect_hash(std::array<std::string_view, Count> const& keys)
+    -> static_perfect_hash<Count>
+{
+	static_perfect_hash<Count> hash{};
+	build_perfect_hash(keys, hash.seeds, hash.positions);
+	return hash;
+}
+} // namespace yaboc::core
+
+#endif // YABOC_INCLUDE_YABOC_CORE_PERFECT_HASH_H
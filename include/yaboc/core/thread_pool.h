@@ -0,0 +1,197 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#ifndef YABOC_INCLUDE_YABOC_CORE_THREAD_POOL_H
+#define YABOC_INCLUDE_YABOC_CORE_THREAD_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <latch>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace yaboc::core
+{
+// Every worker has a queue of its own, and one more takes the tasks submitted
+// from outside the pool. A worker runs its newest task first, as whatever it
+// touches is likely still in cache, and once its queue is empty steals the
+// oldest task of another.
+class thread_pool final
+{
+	struct task_queue final
+	{
+		std::mutex                        mutex{};
+		std::deque<std::function<void()>> tasks{};
+	};
+
+	std::vector<task_queue>  m_queues;
+	std::atomic<std::size_t> m_queued{};
+
+	// Idle workers sleep here until something is queued.
+	std::mutex                  m_mutex{};
+	std::condition_variable_any m_wake{};
+
+	// Last, so the workers are joined before the queues go away.
+	std::vector<std::jthread> m_workers{};
+
+	void run(std::size_t index, std::stop_token const& stop);
+
+	// Returns an empty function if every queue is empty.
+	auto take(std::size_t index) -> std::function<void()>;
+
+public:
+	~thread_pool();
+
+	// Defaults to one thread per core besides the calling one.
+	explicit thread_pool(std::size_t thread_count = default_thread_count());
+
+	thread_pool(thread_pool const&) = delete;
+	auto operator=(thread_pool const&) -> thread_pool& = delete;
+
+	thread_pool(thread_pool&&) = delete;
+	auto operator=(thread_pool&&) -> thread_pool& = delete;
+
+	// A task that throws ends the program; async() hands the exception back
+	// instead.
+	void submit(std::function<void()> task);
+
+	// Runs fn on a worker. The future holds its result, or the exception it
+	// threw.
+	template <class Fn>
+	[[nodiscard]]
+	auto async(Fn&& fn) -> std::future<std::invoke_result_t<std::decay_t<Fn>>>;
+
+	// Calls fn(begin, end) over [0, count) in chunks of at most grain and
+	// returns once every chunk is done. The calling thread takes chunks too,
+	// so this makes progress even when every worker is busy. If fn throws, no
+	// further chunks are started and the first exception is rethrown here
+	// once the chunks already running have finished.
+	template <class Fn>
+	void parallel_for(std::size_t count, std::size_t grain, Fn&& fn);
+
+	// Runs one queued task on the calling thread. Returns false if there was
+	// none.
+	auto run_pending_task() -> bool;
+
+	// Runs queued tasks until done is reached or none are left, then blocks
+	// on it. A task that waits for others this way cannot starve them of
+	// workers, even when they were queued behind it.
+	void wait(std::latch& done);
+
+	[[nodiscard]]
+	auto size() const -> std::size_t
+	{
+		// Not m_workers, which is still filling while the first ones run.
+		return std::size(m_queues) - 1;
+	}
+
+	// The calling thread's index among the workers, or size() for threads
+	// outside the pool.
+	[[nodiscard]]
+	auto worker_index() const -> std::size_t;
+
+	[[nodiscard]]
+	static auto default_thread_count() -> std::size_t
+	{
+		auto const cores = std::thread::hardware_concurrency();
+		return cores > 1 ? cores - 1 : 1;
+	}
+};
+
+template <class Fn>
+auto thread_pool::async(Fn&& fn)
+    -> std::future<std::invoke_result_t<std::decay_t<Fn>>>
+{
+	using result = std::invoke_result_t<std::decay_t<Fn>>;
+
+	// std::function needs something it can copy.
+	auto task =
+	    std::make_shared<std::packaged_task<result()>>(std::forward<Fn>(fn));
+	auto future = task->get_future();
+	submit([task = std::move(task)] { (*task)(); });
+	return future;
+}
+
+template <class Fn>
+void thread_pool::parallel_for(std::size_t count, std::size_t grain, Fn&& fn)
+{
+	grain = std::max(grain, std::size_t{1});
+	auto const chunks = (count + grain - 1) / grain;
+	if (chunks == 0)
+	{
+		return;
+	}
+
+	std::atomic<std::size_t> next_chunk{};
+	std::mutex               error_mutex{};
+	std::exception_ptr       error{};
+
+	auto work = [&next_chunk, &error_mutex, &error, &fn, chunks, count, grain] {
+		try
+		{
+			for (auto chunk = next_chunk++; chunk < chunks;
+			     chunk = next_chunk++)
+			{
+				auto const begin = chunk * grain;
+				fn(begin, std::min(begin + grain, count));
+			}
+		}
+		catch (...)
+		{
+			next_chunk = chunks;
+
+			std::scoped_lock lock{error_mutex};
+			if (!error)
+			{
+				error = std::current_exception();
+			}
+		}
+	};
+
+	// Helpers hold on to this frame, so wait for all of them rather than just
+	// for the chunks to run out.
+	auto const helpers = std::min(chunks - 1, size());
+	std::latch helpers_done{static_cast<std::ptrdiff_t>(helpers)};
+
+	for (std::size_t i{}; i < helpers; ++i)
+	{
+		submit([&work, &helpers_done] {
+			work();
+			helpers_done.count_down();
+		});
+	}
+
+	work();
+	wait(helpers_done);
+
+	if (error)
+	{
+		std::rethrow_exception(error);
+	}
+}
+} // namespace yaboc::core
+
+#endif // YABOC_INCLUDE_YABOC_CORE_THREAD_POOL_H
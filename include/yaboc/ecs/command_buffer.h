@@ -0,0 +1,96 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#ifndef YABOC_ECS_COMMAND_BUFFER_H
+#define YABOC_ECS_COMMAND_BUFFER_H
+
+#include "entt/entt.hpp"
+
+#include <functional>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace yaboc::ecs
+{
+// Structural changes recorded while systems run alongside each other, and
+// applied to the registry once none are running, see scheduler. Creating or
+// destroying entities, or adding and removing components, would otherwise
+// reshuffle the pools other systems are iterating.
+class command_buffer final
+{
+	std::vector<entt::entity>                         m_destroyed{};
+	std::vector<std::function<void(entt::registry&)>> m_commands{};
+
+public:
+	// Skipped if the entity is gone by the time the buffer is applied, say
+	// because two systems destroyed it.
+	void destroy(entt::entity entity);
+
+	template <class Component, class... Args>
+	void emplace_or_replace(entt::entity entity, Args&&... args);
+
+	template <class... Components>
+	void remove(entt::entity entity);
+
+	// Anything else, such as creating entities.
+	void record(std::function<void(entt::registry&)> command);
+
+	// Applies the commands in the order they were recorded, then destroys
+	// the entities, and empties the buffer. Commands for an entity destroyed
+	// in the same buffer are therefore still safe.
+	void apply(entt::registry& registry);
+
+	void clear();
+
+	[[nodiscard]]
+	auto empty() const -> bool
+	{
+		return m_destroyed.empty() && m_commands.empty();
+	}
+};
+
+template <class Component, class... Args>
+void command_buffer::emplace_or_replace(entt::entity entity, Args&&... args)
+{
+	m_commands.emplace_back(
+	    [entity, args = std::make_tuple(std::forward<Args>(args)...)](
+	        entt::registry& registry) mutable {
+		    if (!registry.valid(entity))
+		    {
+			    return;
+		    }
+		    std::apply(
+		        [&registry, entity](auto&&... values) {
+			        registry.emplace_or_replace<Component>(
+			            entity, std::move(values)...);
+		        },
+		        std::move(args));
+	    });
+}
+
+template <class... Components>
+void command_buffer::remove(entt::entity entity)
+{
+	m_commands.emplace_back([entity](entt::registry& registry) {
+		if (registry.valid(entity))
+		{
+			registry.remove<Components...>(entity);
+		}
+	});
+}
+} // namespace yaboc::ecs
+
+#endif // YABOC_ECS_COMMAND_BUFFER_H
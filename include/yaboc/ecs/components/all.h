@@ -17,11 +17,11 @@
 #define YASIC_ECS_COMPONENTS_ALL_H
 
 #include "yaboc/ecs/components/tags.h"
+#include "yaboc/sprite/blend_mode.h"
 
 #include "entt/entt.hpp"
 #include "glm/glm.hpp"
 
-#include <cstddef>
 #include <cstdint>
 
 namespace yaboc::ecs::components
@@ -36,11 +36,45 @@ struct relationship final
 	entt::entity parent;
 };
 
+// Which way along each axis the entity goes, scaling its velocity.
+struct direction final
+{
+	float horizontal{};
+	float vertical{};
+};
+
+// Speed along each axis, in metres per second.
+struct velocity final
+{
+	float x{};
+	float y{};
+};
+
+// Which frame to draw. The frame's UVs are looked up in its sheet, and its
+// name and pixel bounds, which only loading and tools read, stay there too.
+struct sprite_frame final
+{
+	std::uint16_t id;
+	// Layer of the sheet in the sprite_sheet_array that id refers to.
+	std::uint16_t sheet;
+};
+
 struct sprite final
 {
-	std::size_t id;
-	glm::vec2   size;
-	glm::vec4   tint;
+	sprite_frame frame;
+	glm::vec2    size;
+	glm::vec4    tint;
+};
+
+static_assert(sizeof(sprite) == 28);
+
+// Feeds the render queue's sort key. Layers draw in ascending order; within a
+// layer, equal depths keep their submission order.
+struct render_order final
+{
+	std::uint8_t              layer;
+	yaboc::sprite::blend_mode blend;
+	std::uint32_t             depth;
 };
 
 enum class brick_type : std::uint8_t
@@ -0,0 +1,143 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#ifndef YABOC_ECS_RENDER_SNAPSHOT_H
+#define YABOC_ECS_RENDER_SNAPSHOT_H
+
+#include "yaboc/ecs/components/all.h"
+
+#include "entt/fwd.hpp"
+#include "glm/glm.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace yaboc::ecs
+{
+// The sprites of a snapshot, one array per field, so that a pass over them
+// only pulls in the fields it reads. Every array has the same length.
+struct render_list final
+{
+	std::vector<entt::entity>             entities{};
+	std::vector<glm::vec2>                positions{};
+	std::vector<glm::vec2>                sizes{};
+	std::vector<components::sprite_frame> frames{};
+	std::vector<glm::vec4>                tints{};
+	std::vector<components::render_order> orders{};
+
+	// Sprites that were not there before are unspecified until written.
+	void resize(std::size_t count);
+
+	[[nodiscard]]
+	auto size() const -> std::size_t
+	{
+		return std::size(entities);
+	}
+};
+
+// Changes to the static bricks, which are not part of every snapshot.
+// Positions already include the brick group offset.
+struct brick_edit final
+{
+	enum class kind : std::uint8_t
+	{
+		// Drop every brick, ahead of writing the whole level again.
+		clear,
+		// Add the brick, or overwrite it if it is already there.
+		write,
+		remove
+	};
+
+	kind               type{};
+	entt::entity       brick{};
+	glm::vec2          position{};
+	components::sprite sprite{};
+};
+
+// Everything the renderer needs from one simulation tick, so that it never
+// has to touch the registry.
+struct render_snapshot final
+{
+	std::uint64_t                         tick{};
+	std::chrono::steady_clock::time_point taken_at{};
+	// Time spent simulating the tick and taking the snapshot.
+	std::chrono::nanoseconds update_time{};
+
+	// Every sprite that is not a brick, in group order. Consecutive snapshots
+	// list an entity at the same index unless entities came or went.
+	render_list sprites{};
+
+	// Brick changes since the previous snapshot. They are taken out when the
+	// snapshot is published, see render_snapshot_exchange.
+	std::vector<brick_edit> brick_edits{};
+};
+
+// Hands snapshots from the simulation thread to the render thread. The
+// renderer always gets the two most recent ones to interpolate between;
+// snapshots it was too slow to see are skipped, but their brick edits and
+// update times are not. Snapshots are recycled, so that their vectors keep
+// their capacity and a steady state allocates nothing.
+class render_snapshot_exchange final
+{
+public:
+	struct frame final
+	{
+		render_snapshot const*   previous{};
+		render_snapshot const*   latest{};
+		std::vector<brick_edit>  brick_edits{};
+		std::chrono::nanoseconds update_time{};
+	};
+
+private:
+	std::mutex m_mutex{};
+
+	std::vector<std::unique_ptr<render_snapshot>> m_snapshots{};
+	std::vector<render_snapshot*>                 m_free{};
+
+	render_snapshot* m_previous{};
+	render_snapshot* m_latest{};
+	// The pair the render thread is reading.
+	render_snapshot const* m_read_previous{};
+	render_snapshot const* m_read_latest{};
+
+	std::vector<brick_edit>  m_brick_edits{};
+	std::chrono::nanoseconds m_update_time{};
+
+	void recycle(render_snapshot const* snapshot);
+
+public:
+	// A snapshot for the simulation thread to fill in; its contents are
+	// whatever it held last time.
+	[[nodiscard]]
+	auto acquire() -> render_snapshot&;
+
+	// The snapshot must come from acquire(), and is not touched again by the
+	// simulation thread.
+	void publish(render_snapshot& snapshot);
+
+	// Replaces the snapshots in latest_frame with the two most recent ones,
+	// which are the same if only one was published since, and hands over the
+	// brick edits and update time gathered since the last call. The previous
+	// snapshots in latest_frame must no longer be read. Returns false if
+	// nothing has been published yet.
+	auto take(frame& latest_frame) -> bool;
+};
+} // namespace yaboc::ecs
+
+#endif // YABOC_ECS_RENDER_SNAPSHOT_H
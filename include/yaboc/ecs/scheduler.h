@@ -0,0 +1,158 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#ifndef YABOC_ECS_SCHEDULER_H
+#define YABOC_ECS_SCHEDULER_H
+
+#include "yaboc/ecs/command_buffer.h"
+
+#include "entt/entt.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <latch>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace yaboc::core
+{
+class thread_pool;
+} // namespace yaboc::core
+
+namespace yaboc::ecs
+{
+// Runs systems on a thread pool, each as soon as the ones it depends on are
+// done. A system declares the components it reads, as const, and the ones it
+// writes. entt::organizer then orders any two systems that share a component
+// one of them writes, in the order they were added, and leaves the others
+// free to run at the same time.
+//
+// Systems make structural changes through the command buffer they are
+// handed, one per thread, and the buffers are applied after the last system
+// has run. That is the only sync point in run(), so a system that has to see
+// the entities another one creates or destroys belongs in a later run().
+// Other threads that share the pool may run systems too, while they wait on
+// it themselves, and get buffers of their own.
+class scheduler final
+{
+public:
+	using system_function =
+	    std::function<void(entt::registry&, command_buffer&)>;
+
+private:
+	struct registered_system final
+	{
+		scheduler*      owner{};
+		std::string     name{};
+		system_function update{};
+		// Creates the pools of the declared components up front, as systems
+		// running at the same time must not.
+		void (*prepare)(entt::registry&){};
+	};
+
+	static constexpr auto no_system = static_cast<std::size_t>(-1);
+
+	core::thread_pool* m_workers{};
+	entt::organizer    m_organizer{};
+	// A deque, so that the payloads handed to the organizer stay put.
+	std::deque<registered_system> m_systems{};
+	bool                          m_graph_changed{};
+
+	std::vector<entt::organizer::vertex>  m_graph{};
+	std::vector<std::size_t>              m_dependency_counts{};
+	std::vector<std::atomic<std::size_t>> m_waiting_for{};
+
+	// One per worker, then the one of the thread that called run().
+	std::vector<command_buffer> m_command_buffers{};
+	std::thread::id             m_caller{};
+
+	std::mutex                                          m_outside_mutex{};
+	std::unordered_map<std::thread::id, command_buffer> m_outside_buffers{};
+
+	std::atomic<bool>  m_failed{};
+	std::mutex         m_error_mutex{};
+	std::exception_ptr m_error{};
+
+	static void call(void const* payload, entt::registry& registry);
+
+	void build_graph();
+
+	void run_systems(entt::registry& registry);
+
+	// Runs the system and then, on the same thread, the first of those it was
+	// the last to unblock.
+	void run_from(std::size_t     index,
+	              entt::registry& registry,
+	              std::latch&     done);
+
+	// The buffer of the calling thread.
+	auto commands() -> command_buffer&;
+
+public:
+	// Without workers, or with a pool of none, the systems run one after
+	// another on the calling thread.
+	explicit scheduler(core::thread_pool* workers = nullptr);
+
+	scheduler(scheduler const&) = delete;
+	auto operator=(scheduler const&) -> scheduler& = delete;
+
+	// The organizer holds on to this.
+	scheduler(scheduler&&) = delete;
+	auto operator=(scheduler&&) -> scheduler& = delete;
+
+	// Components are listed as const if the system only reads them. A system
+	// may use the pool itself, say for a parallel_for.
+	template <class... Components>
+	void add(std::string name, system_function update);
+
+	// Runs every system once, then applies what they recorded. If a system
+	// throws, those that have not started yet are skipped, nothing recorded
+	// is applied, and the first exception is rethrown.
+	void run(entt::registry& registry);
+
+	[[nodiscard]]
+	auto size() const -> std::size_t
+	{
+		return std::size(m_systems);
+	}
+};
+
+template <class... Components>
+void scheduler::add(std::string name, system_function update)
+{
+	auto& added = m_systems.emplace_back(registered_system{
+	    .owner = this,
+	    .name = std::move(name),
+	    .update = std::move(update),
+	    .prepare = [](entt::registry& registry) {
+		    (static_cast<void>(
+		         registry.storage<std::remove_const_t<Components>>()),
+		     ...);
+	    }});
+
+	m_organizer.emplace<Components...>(&call, &added, added.name.c_str());
+	m_graph_changed = true;
+}
+} // namespace yaboc::ecs
+
+#endif // YABOC_ECS_SCHEDULER_H
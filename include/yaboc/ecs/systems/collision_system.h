@@ -0,0 +1,120 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#ifndef YABOC_ECS_SYSTEMS_COLLISION_SYSTEM_H
+#define YABOC_ECS_SYSTEMS_COLLISION_SYSTEM_H
+
+#include "yaboc/physics/aabb.h"
+#include "yaboc/physics/brick_grid.h"
+
+#include "entt/fwd.hpp"
+#include "glm/glm.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace yaboc::core
+{
+class thread_pool;
+} // namespace yaboc::core
+
+namespace yaboc::ecs::system
+{
+// A ball hitting a brick or a paddle. The normal points from the other
+// towards the ball.
+struct contact final
+{
+	entt::entity ball{};
+	entt::entity other{};
+	glm::vec2    normal{};
+	// When in the tick it happened, from 0 to 1.
+	float time{};
+};
+
+// Moves the balls, bouncing them off bricks and paddles. Each ball is swept
+// from where it is to where it would end up, and stops at the first thing in
+// its way, bounces, and carries on with the rest of the tick; so no speed or
+// tick length lets a ball pass through a brick. Balls that already overlap
+// something, say because the paddle moved into them, are pushed out first.
+//
+// Bricks are kept in a physics::brick_grid that follows registry signals, so
+// each sweep only tests the bricks in the cells it crosses, and those in one
+// batch. Like render_snapshot_system, it needs the brick tag to be added
+// last. Bricks that are hit are assumed to break, and are not hit again in
+// the same tick.
+class collision_system final
+{
+	struct ball final
+	{
+		entt::entity entity{};
+		glm::vec2    position{};
+		glm::vec2    size{};
+		glm::vec2    direction{};
+		glm::vec2    speed{};
+	};
+
+	// What one chunk of balls needs, kept so that a steady state allocates
+	// nothing.
+	struct scratch final
+	{
+		std::vector<entt::entity>  candidates{};
+		physics::aabb_batch        boxes{};
+		std::vector<std::uint32_t> hits{};
+		std::vector<entt::entity>  broken{};
+		std::vector<contact>       contacts{};
+	};
+
+	entt::registry*     m_registry{};
+	core::thread_pool*  m_workers{};
+	physics::brick_grid m_bricks;
+
+	std::vector<ball>         m_balls{};
+	std::vector<entt::entity> m_paddles{};
+	physics::aabb_batch       m_paddle_boxes{};
+	std::vector<scratch>      m_scratch{};
+
+	void move_ball(ball&     moving,
+	               float     dt,
+	               glm::vec2 brick_offset,
+	               scratch&  chunk) const;
+
+	void on_brick_created(entt::registry& registry, entt::entity brick);
+	void on_brick_destroyed(entt::registry& registry, entt::entity brick);
+
+public:
+	~collision_system();
+
+	// Bricks are brick_size, with their centres brick_pitch apart. Thousands
+	// of balls are split into chunks on the workers, if given.
+	collision_system(entt::registry&    registry,
+	                 glm::vec2          brick_pitch,
+	                 glm::vec2          brick_size,
+	                 core::thread_pool* workers = nullptr);
+
+	collision_system(collision_system const&) = delete;
+	auto operator=(collision_system const&) -> collision_system& = delete;
+
+	// The registry holds on to this for its signals.
+	collision_system(collision_system&&) = delete;
+	auto operator=(collision_system&&) -> collision_system& = delete;
+
+	// Moves every ball through dt seconds and replaces contacts with what
+	// they hit, in the order of the balls and then of time.
+	void operator()(float dt, std::vector<contact>& contacts);
+};
+} // namespace yaboc::ecs::system
+
+#endif // YABOC_ECS_SYSTEMS_COLLISION_SYSTEM_H
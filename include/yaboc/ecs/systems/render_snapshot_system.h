@@ -0,0 +1,78 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#ifndef YABOC_ECS_SYSTEMS_RENDER_SNAPSHOT_SYSTEM_H
+#define YABOC_ECS_SYSTEMS_RENDER_SNAPSHOT_SYSTEM_H
+
+#include "yaboc/ecs/render_snapshot.h"
+
+#include "entt/fwd.hpp"
+
+#include <vector>
+
+namespace yaboc::core
+{
+class thread_pool;
+} // namespace yaboc::core
+
+namespace yaboc::ecs::system
+{
+// Copies what the renderer needs out of the registry at the end of a tick.
+// Bricks never move, so instead of being copied every tick their changes are
+// picked up from registry signals and sent as brick edits.
+//
+// After the first snapshot, bricks are sent as they are created, so their
+// tag must be the last component added and the brick_group must already be
+// where the new bricks expect it.
+class render_snapshot_system final
+{
+	entt::registry*         m_registry{};
+	core::thread_pool*      m_workers{};
+	std::vector<brick_edit> m_brick_edits{};
+	bool                    m_rewrite_bricks{true};
+
+	void extract_sprites(render_list& sprites) const;
+
+	void write_bricks();
+
+	void write_brick(entt::entity brick);
+
+	void on_brick_created(entt::registry& registry, entt::entity brick);
+	void on_brick_destroyed(entt::registry& registry, entt::entity brick);
+	void on_sprite_updated(entt::registry& registry, entt::entity entity);
+
+public:
+	~render_snapshot_system();
+
+	// Large sprite counts are extracted in chunks on the workers, if given.
+	explicit render_snapshot_system(entt::registry&    registry,
+	                                core::thread_pool* workers = nullptr);
+
+	render_snapshot_system(render_snapshot_system const&) = delete;
+	auto operator=(render_snapshot_system const&)
+	    -> render_snapshot_system& = delete;
+
+	// The registry holds on to this for its signals.
+	render_snapshot_system(render_snapshot_system&&) = delete;
+	auto operator=(render_snapshot_system&&)
+	    -> render_snapshot_system& = delete;
+
+	// Overwrites the sprites of the snapshot and hands over the brick edits
+	// made since the last call.
+	void operator()(render_snapshot& snapshot);
+};
+} // namespace yaboc::ecs::system
+
+#endif // YABOC_ECS_SYSTEMS_RENDER_SNAPSHOT_SYSTEM_H
@@ -16,30 +16,78 @@
 #ifndef YABOC_ECS_SYSTEMS_SPRITE_RENDER_SYSTEM_H
 #define YABOC_ECS_SYSTEMS_SPRITE_RENDER_SYSTEM_H
 
-#include "yaboc/sprite/sprite_sheet.h"
+#include "yaboc/ecs/render_snapshot.h"
+#include "yaboc/sprite/render_queue.h"
+#include "yaboc/sprite/sprite_renderer.h"
+#include "yaboc/sprite/sprite_sheet_array.h"
+#include "yaboc/sprite/static_sprite_batch.h"
 
 #include "entt/fwd.hpp"
 #include "glad/gl.h"
 
+#include <cstdint>
 #include <memory>
+#include <span>
+#include <vector>
 
-namespace yaboc::sprite
+namespace yaboc::core
 {
-class sprite_renderer;
-} // namespace yaboc::sprite
+class thread_pool;
+} // namespace yaboc::core
 
 namespace yaboc::ecs::system
 {
+// Draws render snapshots, so that it can run on a thread of its own. Bricks
+// never move, so they are kept in a static batch that is patched from the
+// brick edits; everything else goes through the render queue each frame.
 class sprite_render_system final
 {
 	std::unique_ptr<sprite::sprite_renderer> m_renderer{};
-	sprite::sprite_sheet*                    m_sprite_sheet{};
+	sprite::sprite_sheet_array const*        m_sprite_sheets{};
+	sprite::render_queue                     m_render_queue{};
+	std::uint16_t                            m_sheets_key{};
+
+	sprite::static_sprite_batch m_static_bricks;
+	// Slot of each brick in m_static_bricks, indexed by entity, and the
+	// reverse mapping so that a swap-remove can fix up the moved brick.
+	std::vector<std::uint32_t> m_brick_slots{};
+	std::vector<entt::entity>  m_slot_bricks{};
+
+	// Expands long runs of queued sprites in parallel.
+	core::thread_pool* m_workers{};
+
+	[[nodiscard]]
+	auto subtexture(components::sprite_frame frame) const
+	    -> sprite::sprite_renderer::subtexture_bounds;
+
+	void clear_bricks();
+
+	void write_brick(brick_edit const& edit);
+
+	void remove_brick(entt::entity brick);
 
 public:
+	// The workers are typically shared with the simulation, and must
+	// outlive the system.
 	sprite_render_system(std::unique_ptr<sprite::sprite_renderer>&& renderer,
-	                     sprite::sprite_sheet*                      sheet);
+	                     sprite::sprite_sheet_array const*          sheets,
+	                     core::thread_pool&                         workers);
+
+	sprite_render_system(sprite_render_system const&) = delete;
+	auto operator=(sprite_render_system const&)
+	    -> sprite_render_system& = delete;
+
+	sprite_render_system(sprite_render_system&&) = delete;
+	auto operator=(sprite_render_system&&) -> sprite_render_system& = delete;
+
+	// Applies brick edits in the order they were made.
+	void apply(std::span<brick_edit const> edits);
 
-	void operator()(entt::registry& registry) const;
+	// Draws the sprites where they were at alpha between the two snapshots,
+	// which may be the same one.
+	void operator()(render_snapshot const& previous,
+	                render_snapshot const& current,
+	                float                  alpha);
 };
 } // namespace yaboc::ecs::system
 
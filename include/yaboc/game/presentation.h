@@ -0,0 +1,105 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#ifndef YABOC_INCLUDE_YABOC_GAME_PRESENTATION_H
+#define YABOC_INCLUDE_YABOC_GAME_PRESENTATION_H
+
+#include "yaboc/ecs/render_snapshot.h"
+#include "yaboc/ecs/systems/sprite_render_system.h"
+#include "yaboc/graphics/image.h"
+#include "yaboc/graphics/texture_streamer.h"
+#include "yaboc/profiling/frame_profiler.h"
+#include "yaboc/profiling/performance_hud.h"
+#include "yaboc/sprite/sprite_sheet_array.h"
+
+#include <cstddef>
+#include <future>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace yaboc::core
+{
+class thread_pool;
+} // namespace yaboc::core
+
+namespace yaboc::game
+{
+// Frames the HUD averages its timings over.
+constexpr std::size_t profile_average_frames{60};
+
+// Owns every OpenGL object. Once the context has been handed to the render
+// thread, it is only used from there.
+class presentation final
+{
+	sprite::sprite_sheet_array        m_sprite_sheets;
+	ecs::system::sprite_render_system m_render_system;
+
+	profiling::frame_profiler                 m_profiler{};
+	std::optional<profiling::performance_hud> m_hud{};
+
+	graphics::texture_streamer                m_texture_streamer;
+	std::future<std::vector<graphics::image>> m_reloaded_images{};
+
+	// Streams the reloaded images into their layers once they are decoded,
+	// and the mip chain is regenerated after the last one.
+	void stream_sprite_sheets();
+
+	void enqueue_sprite_sheets(std::vector<graphics::image>&& images);
+
+public:
+	presentation(sprite::sprite_sheet_array&& sprite_sheets,
+	             core::thread_pool&           workers,
+	             bool                         show_hud);
+
+	// Starts compiling the programs the constructor needs, so that the driver
+	// can work on them while the assets load.
+	static void prepare_shaders();
+
+	[[nodiscard]]
+	auto sprite_sheets() const -> sprite::sprite_sheet_array const&
+	{
+		return m_sprite_sheets;
+	}
+
+	// The images of the sprite sheets, in layer order.
+	[[nodiscard]]
+	auto sprite_sheet_paths() const -> std::vector<std::string>;
+
+	// Streams the images, read again from sprite_sheet_paths(), in over the
+	// next frames once they are decoded. Only for sheets uploaded from loose
+	// images, as cooked ones may be compressed.
+	void reload_sprite_sheets(std::future<std::vector<graphics::image>> images);
+
+	void toggle_hud();
+
+	[[nodiscard]]
+	auto hud_visible() const -> bool
+	{
+		return m_hud.has_value();
+	}
+
+	[[nodiscard]]
+	auto profiler() -> profiling::frame_profiler&
+	{
+		return m_profiler;
+	}
+
+	// Draws the state at alpha between the two snapshots of the frame.
+	void render(ecs::render_snapshot_exchange::frame const& frame, float alpha);
+};
+} // namespace yaboc::game
+
+#endif // YABOC_INCLUDE_YABOC_GAME_PRESENTATION_H
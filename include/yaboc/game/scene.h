@@ -0,0 +1,83 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#ifndef YABOC_INCLUDE_YABOC_GAME_SCENE_H
+#define YABOC_INCLUDE_YABOC_GAME_SCENE_H
+
+#include "yaboc/assets/level_grid.h"
+#include "yaboc/ecs/components/all.h"
+#include "yaboc/sprite/sprite_sheet.h"
+#include "yaboc/sprite/sprite_sheet_frames.h"
+
+#include "entt/fwd.hpp"
+#include "glm/glm.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace yaboc::game
+{
+namespace render_layer
+{
+constexpr std::uint8_t playfield{0};
+constexpr std::uint8_t paddle{1};
+constexpr std::uint8_t ball{2};
+} // namespace render_layer
+
+constexpr float     brick_gap{0.03125F};
+constexpr glm::vec2 brick_size{0.75F, 0.25F};
+// The reference resolution in metres.
+constexpr glm::vec2 playfield_size{10.0F, 5.625F};
+
+[[nodiscard]]
+auto sprite_frame(sprite::sprite_sheet const&     sheet,
+                  sprite::sprite_sheet_frames::id id)
+    -> ecs::components::sprite_frame;
+
+// Adds a brick for every filled cell of the level, and centres them.
+void load_level(entt::registry&               registry,
+                assets::level_grid const&     level,
+                ecs::components::sprite_frame frame);
+
+// Adds the paddle, the ball and the bricks of the level. Returns the paddle.
+auto create_scene(entt::registry&             registry,
+                  sprite::sprite_sheet const& sprite_sheet,
+                  assets::level_grid const&   level) -> entt::entity;
+
+// Swaps the bricks in the registry for those of another level a few at a
+// time, so that a level change never takes more than its budget out of a
+// tick. The old bricks go first, then the group moves, then the new bricks
+// arrive row by row.
+class staged_level final
+{
+	using clock = std::chrono::steady_clock;
+
+	assets::level_data            m_level{};
+	ecs::components::sprite_frame m_frame{};
+	std::size_t                   m_next_cell{};
+	bool                          m_group_moved{};
+
+public:
+	staged_level(assets::level_data&&          level,
+	             ecs::components::sprite_frame frame);
+
+	// Works until the deadline has passed. Returns true once the new level is
+	// complete.
+	auto commit(entt::registry& registry, clock::time_point deadline) -> bool;
+};
+} // namespace yaboc::game
+
+#endif // YABOC_INCLUDE_YABOC_GAME_SCENE_H
@@ -0,0 +1,107 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#ifndef YABOC_INCLUDE_YABOC_GAME_SIMULATION_H
+#define YABOC_INCLUDE_YABOC_GAME_SIMULATION_H
+
+#include "yaboc/assets/level_grid.h"
+#include "yaboc/ecs/command_buffer.h"
+#include "yaboc/ecs/components/all.h"
+#include "yaboc/ecs/render_snapshot.h"
+#include "yaboc/ecs/scheduler.h"
+#include "yaboc/ecs/systems/collision_system.h"
+#include "yaboc/ecs/systems/render_snapshot_system.h"
+#include "yaboc/game/scene.h"
+#include "yaboc/sprite/sprite_sheet.h"
+
+#include "entt/entt.hpp"
+#include "glm/glm.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <optional>
+#include <ratio>
+#include <vector>
+
+namespace yaboc::core
+{
+class thread_pool;
+} // namespace yaboc::core
+
+namespace yaboc::game
+{
+// The fixed step the simulation advances by.
+constexpr auto dt = std::chrono::duration<std::int64_t, std::ratio<1, 60>>{1};
+constexpr auto dt_f =
+    std::chrono::duration_cast<std::chrono::duration<float>>(dt);
+
+// Owns the registry, and runs on the main thread.
+class simulation final
+{
+	using clock = std::chrono::steady_clock;
+
+	core::thread_pool*                  m_workers{};
+	entt::registry                      m_registry{};
+	ecs::system::render_snapshot_system m_snapshot_system{m_registry,
+	                                                      m_workers};
+	ecs::system::collision_system       m_collision_system{
+	    m_registry, brick_size + glm::vec2{brick_gap}, brick_size, m_workers};
+	ecs::scheduler                      m_scheduler{m_workers};
+	entt::entity                        m_paddle{};
+	std::uint64_t                       m_tick{};
+
+	std::vector<ecs::system::contact> m_contacts{};
+
+	ecs::components::sprite_frame   m_brick_frame{};
+	std::future<assets::level_data> m_next_level{};
+	std::optional<staged_level>     m_staged_level{};
+
+	// Takes a loaded level in, within the tick's budget for it.
+	void advance_level_change(clock::time_point deadline);
+
+	// Pushes the ball out of a wall along its normal and sends it off away
+	// from it.
+	void bounce(entt::entity ball, glm::vec2 normal, float depth);
+
+	// Moves the balls, breaking the bricks they hit, and keeps them inside
+	// the playfield.
+	void move_balls(ecs::command_buffer& commands);
+
+	// Systems that share a component they write run in the order they are
+	// added here; the others may run at the same time.
+	void add_systems();
+
+public:
+	// The workers are shared with the presentation, and must outlive both.
+	simulation(sprite::sprite_sheet const& sprite_sheet,
+	           assets::level_grid const&   level,
+	           core::thread_pool&          workers);
+
+	// Replaces the current level with this one once it has loaded, spread
+	// over as many ticks as it takes. A level still on its way is dropped.
+	void load_level(std::future<assets::level_data>&& level);
+
+	void steer_paddle(float horizontal);
+
+	// Fills the snapshot with the current state, without advancing it.
+	void capture(ecs::render_snapshot& snapshot);
+
+	// Advances the simulation by one dt and captures the result.
+	void tick(ecs::render_snapshot& snapshot);
+};
+} // namespace yaboc::game
+
+#endif // YABOC_INCLUDE_YABOC_GAME_SIMULATION_H
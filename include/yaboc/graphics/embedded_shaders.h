@@ -0,0 +1,37 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#ifndef YABOC_INCLUDE_YABOC_GRAPHICS_EMBEDDED_SHADERS_H
+#define YABOC_INCLUDE_YABOC_GRAPHICS_EMBEDDED_SHADERS_H
+
+#include <span>
+#include <string_view>
+
+namespace yaboc::graphics
+{
+struct embedded_shader final
+{
+	// Relative to the project root, such as assets/shaders/sprite.frag.glsl.
+	std::string_view path;
+	std::string_view source;
+};
+
+// The shaders compiled into the executable. Defined in a source generated at
+// build time, see tools/cmake/EmbedShaders.cmake.
+[[nodiscard]]
+auto embedded_shaders() -> std::span<embedded_shader const>;
+} // namespace yaboc::graphics
+
+#endif // YABOC_INCLUDE_YABOC_GRAPHICS_EMBEDDED_SHADERS_H
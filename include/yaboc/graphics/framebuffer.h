@@ -0,0 +1,67 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#ifndef YABOC_INCLUDE_YABOC_GRAPHICS_FRAMEBUFFER_H
+#define YABOC_INCLUDE_YABOC_GRAPHICS_FRAMEBUFFER_H
+
+#include "yaboc/graphics/image.h"
+
+namespace yaboc::graphics
+{
+// An offscreen RGBA8 colour target, for contexts without a default
+// framebuffer or for reading frames back.
+class framebuffer final
+{
+	unsigned int m_framebuffer{};
+	unsigned int m_colour{};
+
+	int m_width{};
+	int m_height{};
+
+public:
+	~framebuffer();
+
+	framebuffer(int width, int height);
+
+	framebuffer(framebuffer const&) = delete;
+	auto operator=(framebuffer const&) -> framebuffer& = delete;
+
+	framebuffer(framebuffer&& other) noexcept;
+	auto operator=(framebuffer&& other) noexcept -> framebuffer&;
+
+	// Makes this the draw and read framebuffer and covers it with the
+	// viewport.
+	void bind() const;
+
+	// Blocks until everything drawn so far has finished. Rows are returned
+	// top row first, like the image files they are compared against.
+	[[nodiscard]]
+	auto read_pixels() const -> image;
+
+	[[nodiscard]]
+	auto width() const -> int
+	{
+		return m_width;
+	}
+
+	[[nodiscard]]
+	auto height() const -> int
+	{
+		return m_height;
+	}
+};
+} // namespace yaboc::graphics
+
+#endif // YABOC_INCLUDE_YABOC_GRAPHICS_FRAMEBUFFER_H
@@ -0,0 +1,108 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#ifndef YABOC_INCLUDE_YABOC_GRAPHICS_GPU_TIMER_QUERIES_H
+#define YABOC_INCLUDE_YABOC_GRAPHICS_GPU_TIMER_QUERIES_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace yaboc::graphics
+{
+// GL_TIME_ELAPSED queries for a fixed number of timers, with one set of
+// queries per frame in a small ring. A set is only read back when the ring
+// comes around to it again, and only if the GPU has already finished with it,
+// so collecting the timings never waits on the GPU.
+class gpu_timer_queries final
+{
+public:
+	struct resolved_frame final
+	{
+		std::uint64_t frame{};
+		// False if the GPU had not finished the frame, whose timings are then
+		// dropped.
+		bool available{};
+		// Zero for the timers that were not started in that frame.
+		std::span<std::chrono::nanoseconds const> elapsed{};
+	};
+
+	static constexpr std::size_t default_query_sets{2};
+
+private:
+	static constexpr auto no_timer = std::numeric_limits<std::size_t>::max();
+
+	struct query_set final
+	{
+		std::uint64_t frame{};
+		bool          recorded{};
+	};
+
+	std::size_t               m_num_timers{};
+	std::vector<unsigned int> m_queries{};
+	// Whether each query was started in the frame its set recorded.
+	std::vector<bool>      m_started{};
+	std::vector<query_set> m_sets{};
+	std::size_t            m_current_set{};
+	std::size_t            m_active_timer{no_timer};
+
+	std::vector<std::chrono::nanoseconds> m_elapsed{};
+	std::uint64_t                         m_dropped_frames{};
+
+	void release();
+
+	auto read_back(std::size_t set_index, bool wait) -> resolved_frame;
+
+public:
+	~gpu_timer_queries();
+
+	explicit gpu_timer_queries(std::size_t num_timers,
+	                           std::size_t num_sets = default_query_sets);
+
+	gpu_timer_queries(gpu_timer_queries const&) = delete;
+	auto operator=(gpu_timer_queries const&) -> gpu_timer_queries& = delete;
+
+	gpu_timer_queries(gpu_timer_queries&& other) noexcept;
+	auto operator=(gpu_timer_queries&& other) noexcept -> gpu_timer_queries&;
+
+	// Starts recording frame into the oldest set, and returns the timings of
+	// the frame that set held before. The span is valid until the next call.
+	[[nodiscard]]
+	auto begin_frame(std::uint64_t frame) -> std::optional<resolved_frame>;
+
+	// Returns the timings of the oldest frame that has not been returned yet,
+	// waiting for the GPU if need be, or nothing once every frame has been.
+	// For collecting the last frames before shutting down.
+	[[nodiscard]]
+	auto flush() -> std::optional<resolved_frame>;
+
+	// Timers cannot overlap; GL only allows one active GL_TIME_ELAPSED query.
+	void begin(std::size_t timer);
+
+	void end();
+
+	[[nodiscard]]
+	auto dropped_frames() const -> std::uint64_t
+	{
+		return m_dropped_frames;
+	}
+};
+} // namespace yaboc::graphics
+
+#endif // YABOC_INCLUDE_YABOC_GRAPHICS_GPU_TIMER_QUERIES_H
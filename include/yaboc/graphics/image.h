@@ -0,0 +1,64 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#ifndef YABOC_INCLUDE_YABOC_GRAPHICS_IMAGE_H
+#define YABOC_INCLUDE_YABOC_GRAPHICS_IMAGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <vector>
+
+namespace yaboc::graphics
+{
+// Tightly packed RGBA8 pixels, top row first.
+struct image final
+{
+	static constexpr std::size_t channels{4};
+
+	int                       width{};
+	int                       height{};
+	std::vector<std::uint8_t> pixels{};
+};
+
+struct image_difference final
+{
+	// The largest difference of any one channel.
+	std::uint8_t max_delta{};
+	// Pixels with a channel that differs by more than the tolerance.
+	std::size_t differing_pixels{};
+	bool        size_mismatch{};
+};
+
+[[nodiscard]]
+auto load_png(std::filesystem::path const& path) -> std::optional<image>;
+
+auto write_png(std::filesystem::path const& path, image const& picture) -> bool;
+
+// Half the size in each dimension, but at least 1x1, with every pixel the
+// average of the ones it covers. Repeated until 1x1 this gives a mip chain.
+[[nodiscard]]
+auto downsample(image const& picture) -> image;
+
+// Rasterisers are free to round differently, so exact matches are not
+// expected between drivers; channel_tolerance absorbs that.
+[[nodiscard]]
+auto compare_images(image const& expected,
+                    image const& actual,
+                    std::uint8_t channel_tolerance) -> image_difference;
+} // namespace yaboc::graphics
+
+#endif // YABOC_INCLUDE_YABOC_GRAPHICS_IMAGE_H
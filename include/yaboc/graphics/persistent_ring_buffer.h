@@ -0,0 +1,138 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#ifndef YABOC_INCLUDE_YABOC_GRAPHICS_PERSISTENT_RING_BUFFER_H
+#define YABOC_INCLUDE_YABOC_GRAPHICS_PERSISTENT_RING_BUFFER_H
+
+#include "glad/gl.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <span>
+
+namespace yaboc::graphics
+{
+// A persistently mapped buffer handed out as a ring. Every range that has been
+// handed to the GPU is protected by a fence, and a reservation only waits on
+// the fences of the ranges it would overwrite. The caller must have issued the
+// draws that read committed memory before the ring wraps or grows, which is
+// what fits() is for.
+class persistent_ring_buffer final
+{
+public:
+	struct statistics final
+	{
+		std::uint64_t            bytes_written{};
+		std::uint64_t            wraps{};
+		std::uint64_t            grows{};
+		std::uint64_t            frames{};
+		std::uint64_t            fence_waits{};
+		std::chrono::nanoseconds time_blocked{};
+	};
+
+	struct reservation final
+	{
+		std::span<std::byte> memory{};
+		std::size_t          offset{};
+	};
+
+private:
+	struct fenced_range final
+	{
+		GLsync        fence{nullptr};
+		std::size_t   begin{};
+		std::size_t   end{};
+		std::uint64_t frame{};
+	};
+
+	unsigned int         m_buffer{};
+	std::span<std::byte> m_mapped{};
+
+	std::size_t m_head{};
+	std::size_t m_unfenced_begin{};
+	std::size_t m_reserved_offset{};
+
+	std::size_t   m_frames_in_flight{};
+	std::uint64_t m_frame{};
+
+	std::deque<fenced_range> m_in_flight{};
+
+	statistics m_statistics{};
+
+	void allocate_storage(std::size_t size);
+
+	void release_storage();
+
+	void grow(std::size_t minimum_size);
+
+	void wait_for_range(std::size_t begin, std::size_t end);
+
+	void wait(GLsync fence);
+
+public:
+	~persistent_ring_buffer();
+
+	persistent_ring_buffer(std::size_t size, std::size_t frames_in_flight);
+
+	persistent_ring_buffer(persistent_ring_buffer const&) = delete;
+	auto operator=(persistent_ring_buffer const&)
+	    -> persistent_ring_buffer& = delete;
+
+	persistent_ring_buffer(persistent_ring_buffer&& other) noexcept;
+	auto operator=(persistent_ring_buffer&& other) noexcept
+	    -> persistent_ring_buffer&;
+
+	// True if a reservation of this size can be made without wrapping or
+	// growing the buffer.
+	[[nodiscard]]
+	auto fits(std::size_t size, std::size_t alignment) const -> bool;
+
+	// Returns writable memory at an offset that is a multiple of alignment.
+	// Only the part passed to commit() is considered used.
+	[[nodiscard]]
+	auto reserve(std::size_t size, std::size_t alignment) -> reservation;
+
+	void commit(std::size_t size);
+
+	// Fences everything committed since the previous fence.
+	void fence();
+
+	// Fences the frame and blocks until no more than frames_in_flight frames
+	// are still being read by the GPU.
+	void end_frame();
+
+	[[nodiscard]]
+	auto buffer_id() const -> unsigned int
+	{
+		return m_buffer;
+	}
+
+	[[nodiscard]]
+	auto capacity() const -> std::size_t
+	{
+		return std::size(m_mapped);
+	}
+
+	[[nodiscard]]
+	auto counters() const -> statistics const&
+	{
+		return m_statistics;
+	}
+};
+} // namespace yaboc::graphics
+
+#endif // YABOC_INCLUDE_YABOC_GRAPHICS_PERSISTENT_RING_BUFFER_H
@@ -16,11 +16,17 @@
 #ifndef YABOC_INCLUDE_YABOC_GRAPHICS_SHADER_H
 #define YABOC_INCLUDE_YABOC_GRAPHICS_SHADER_H
 
+#include <filesystem>
 #include <string>
 #include <vector>
 
 namespace yaboc
 {
+namespace assets
+{
+class asset_pack;
+} // namespace assets
+
 struct shader_builder_input final
 {
 	enum class shader_type
@@ -34,11 +40,32 @@ struct shader_builder_input final
 	};
 
 	shader_type type;
+	// Looked up in the shader pack, then among the embedded shaders, and
+	// read from disk if it is in neither.
 	std::string path;
+
+	auto operator==(shader_builder_input const&) const -> bool = default;
 };
 
+// Loads the program from the program cache if it has it, and compiles and
+// links it otherwise. Errors are written to std::cerr.
 auto make_shader(std::vector<shader_builder_input> const& inputs)
     -> unsigned int;
+
+// Starts building the program without waiting for the driver; the
+// make_shader() call with the same inputs then picks it up. With
+// GL_ARB_parallel_shader_compile the driver compiles in the background, so
+// other work can be done in between.
+void prepare_shader(std::vector<shader_builder_input> const& inputs);
+
+// Sources in the pack take precedence over the embedded ones. The pack must
+// outlive every make_shader() call; nullptr stops using it.
+void use_shader_pack(assets::asset_pack const* pack);
+
+// Linked programs are kept in this directory between runs, keyed by their
+// sources and the driver that built them. Caching is off until it is set, and
+// whenever the driver supports no program binary formats.
+void use_program_cache(std::filesystem::path directory);
 } // namespace yaboc
 
 #endif // YABOC_INCLUDE_YABOC_GRAPHICS_SHADER_H
@@ -0,0 +1,75 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#ifndef YABOC_INCLUDE_YABOC_GRAPHICS_TEXTURE_STREAMER_H
+#define YABOC_INCLUDE_YABOC_GRAPHICS_TEXTURE_STREAMER_H
+
+#include "yaboc/graphics/image.h"
+#include "yaboc/graphics/persistent_ring_buffer.h"
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+
+namespace yaboc::graphics
+{
+// An RGBA8 image to copy into one level and layer of an existing texture.
+struct texture_upload final
+{
+	unsigned int texture{};
+	int          level{};
+	int          layer{};
+	image        picture{};
+	// Called on the GL thread once the last rows have been submitted.
+	std::function<void()> on_complete{};
+};
+
+// Copies images into textures a few rows at a time through a persistently
+// mapped pixel unpack buffer, so that no frame spends more than its budget
+// on uploads and the driver never has to copy from client memory. Rows land
+// over several frames, so a texture may be drawn half old and half new while
+// an upload is under way.
+class texture_streamer final
+{
+	struct pending_upload final
+	{
+		texture_upload upload{};
+		int            next_row{};
+	};
+
+	persistent_ring_buffer     m_staging;
+	std::size_t                m_bytes_per_frame{};
+	std::deque<pending_upload> m_pending{};
+
+public:
+	// At least one row is sent each frame, even if it is over the budget.
+	texture_streamer(std::size_t bytes_per_frame,
+	                 std::size_t frames_in_flight);
+
+	void enqueue(texture_upload&& upload);
+
+	// Submits up to a frame's budget of rows. Call once a frame, with the GL
+	// context current.
+	void pump();
+
+	[[nodiscard]]
+	auto idle() const -> bool
+	{
+		return std::empty(m_pending);
+	}
+};
+} // namespace yaboc::graphics
+
+#endif // YABOC_INCLUDE_YABOC_GRAPHICS_TEXTURE_STREAMER_H
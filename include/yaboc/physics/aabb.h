@@ -0,0 +1,132 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#ifndef YABOC_INCLUDE_YABOC_PHYSICS_AABB_H
+#define YABOC_INCLUDE_YABOC_PHYSICS_AABB_H
+
+#include "glm/glm.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace yaboc::physics
+{
+struct aabb final
+{
+	glm::vec2 min{};
+	glm::vec2 max{};
+};
+
+[[nodiscard]]
+inline auto make_aabb(glm::vec2 centre, glm::vec2 size) -> aabb
+{
+	return {.min = centre - size / 2.0F, .max = centre + size / 2.0F};
+}
+
+// Boxes that only touch do not overlap.
+[[nodiscard]]
+inline auto overlaps(aabb const& a, aabb const& b) -> bool
+{
+	return a.min.x < b.max.x && b.min.x < a.max.x && a.min.y < b.max.y &&
+	       b.min.y < a.max.y;
+}
+
+// Boxes as structure of arrays, so that several can be tested against one box
+// at a time.
+struct aabb_batch final
+{
+	std::vector<float> min_x{};
+	std::vector<float> min_y{};
+	std::vector<float> max_x{};
+	std::vector<float> max_y{};
+
+	void push_back(aabb const& box)
+	{
+		min_x.push_back(box.min.x);
+		min_y.push_back(box.min.y);
+		max_x.push_back(box.max.x);
+		max_y.push_back(box.max.y);
+	}
+
+	void clear()
+	{
+		min_x.clear();
+		min_y.clear();
+		max_x.clear();
+		max_y.clear();
+	}
+
+	[[nodiscard]]
+	auto operator[](std::size_t index) const -> aabb
+	{
+		return {.min = {min_x[index], min_y[index]},
+		        .max = {max_x[index], max_y[index]}};
+	}
+
+	[[nodiscard]]
+	auto size() const -> std::size_t
+	{
+		assert(std::size(min_y) == std::size(min_x) &&
+		       std::size(max_x) == std::size(min_x) &&
+		       std::size(max_y) == std::size(min_x));
+		return std::size(min_x);
+	}
+};
+
+// Writes the index of every box in the batch that overlaps box, in order, and
+// returns how many there were. hits needs room for the whole batch. Boxes that
+// only touch do not overlap. Four boxes are tested at a time where SSE2 is
+// available.
+auto find_overlaps(aabb const&              box,
+                   aabb_batch const&        batch,
+                   std::span<std::uint32_t> hits) -> std::size_t;
+
+// How far a has to move along the normal, which is an axis, to stop
+// overlapping b.
+struct penetration final
+{
+	glm::vec2 normal{};
+	float     depth{};
+};
+
+[[nodiscard]]
+auto find_penetration(aabb const& a, aabb const& b) -> penetration;
+
+// The box that a box moving by displacement passes through.
+[[nodiscard]]
+auto sweep(aabb const& box, glm::vec2 displacement) -> aabb;
+
+// Where a moving box first touches an obstacle. time is the fraction of the
+// displacement travelled by then. The normal is that of the face touched,
+// and has both axes set if a corner was hit exactly.
+struct impact final
+{
+	float     time{};
+	glm::vec2 normal{};
+};
+
+// Nothing if the box misses the obstacle, only grazes it, or already
+// overlaps it; see find_penetration() for the last. Unlike testing the end
+// position, this cannot step over an obstacle however far the box moves.
+[[nodiscard]]
+auto find_impact(aabb const& box, glm::vec2 displacement, aabb const& obstacle)
+    -> std::optional<impact>;
+} // namespace yaboc::physics
+
+#endif // YABOC_INCLUDE_YABOC_PHYSICS_AABB_H
@@ -0,0 +1,84 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#ifndef YABOC_INCLUDE_YABOC_PHYSICS_BRICK_GRID_H
+#define YABOC_INCLUDE_YABOC_PHYSICS_BRICK_GRID_H
+
+#include "yaboc/physics/aabb.h"
+
+#include "entt/fwd.hpp"
+#include "glm/glm.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace yaboc::physics
+{
+// Bricks indexed by the cell of the level they sit in, which is all the broad
+// phase needs since bricks never move. The taken cells are a bitset, so a
+// query skips empty space a word at a time, and the brick in each taken cell
+// is kept alongside.
+//
+// Positions are relative to the brick group, with the brick of cell (x, y)
+// centred on (x, y) * pitch.
+class brick_grid final
+{
+	std::vector<std::uint64_t> m_occupied{};
+	std::vector<entt::entity>  m_bricks{};
+	// Cell of each brick, indexed by entity.
+	std::vector<std::uint32_t> m_cells{};
+
+	glm::vec2   m_pitch{};
+	glm::vec2   m_brick_size{};
+	int         m_columns{};
+	int         m_rows{};
+	std::size_t m_size{};
+
+	// Makes room for the cell, keeping the bricks already in place.
+	void grow(glm::ivec2 cell);
+
+	// The first and last cell along the axis whose brick the box, relative to
+	// the group, could overlap. Empty if there are none.
+	[[nodiscard]]
+	auto cell_range(aabb const& box, int axis) const -> glm::ivec2;
+
+public:
+	brick_grid(glm::vec2 pitch, glm::vec2 brick_size);
+
+	// Bricks sharing a cell replace one another.
+	void insert(entt::entity brick, glm::vec2 position);
+
+	// Does nothing if the brick is not in the grid.
+	void erase(entt::entity brick);
+
+	void clear();
+
+	// Appends every brick whose cell the box, relative to the group, may
+	// overlap to bricks and its box, moved by offset, to boxes.
+	void gather(aabb const&                box,
+	            glm::vec2                  offset,
+	            std::vector<entt::entity>& bricks,
+	            aabb_batch&                boxes) const;
+
+	[[nodiscard]]
+	auto size() const -> std::size_t
+	{
+		return m_size;
+	}
+};
+} // namespace yaboc::physics
+
+#endif // YABOC_INCLUDE_YABOC_PHYSICS_BRICK_GRID_H
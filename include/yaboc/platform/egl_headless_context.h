@@ -0,0 +1,46 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#ifndef YABOC_INCLUDE_YABOC_PLATFORM_EGL_HEADLESS_CONTEXT_H
+#define YABOC_INCLUDE_YABOC_PLATFORM_EGL_HEADLESS_CONTEXT_H
+
+namespace yaboc::platform
+{
+// An OpenGL core context without a window, made current on the calling
+// thread. Uses a surfaceless EGL display, so it runs on machines without a
+// display server or GPU, such as Mesa's llvmpipe. Rendering has to go to a
+// framebuffer object.
+class egl_headless_context final
+{
+	// EGLDisplay and EGLContext, kept opaque to keep the EGL headers out.
+	void* m_display{};
+	void* m_context{};
+
+public:
+	~egl_headless_context();
+
+	// Throws std::runtime_error if no such context can be created.
+	egl_headless_context(int gl_major, int gl_minor);
+
+	egl_headless_context(egl_headless_context const&) = delete;
+	auto operator=(egl_headless_context const&)
+	    -> egl_headless_context& = delete;
+
+	egl_headless_context(egl_headless_context&&) = delete;
+	auto operator=(egl_headless_context&&) -> egl_headless_context& = delete;
+};
+} // namespace yaboc::platform
+
+#endif // YABOC_INCLUDE_YABOC_PLATFORM_EGL_HEADLESS_CONTEXT_H
@@ -51,6 +51,19 @@ public:
 	{
 		SDL_GL_SwapWindow(m_window_handle);
 	}
+
+	// The context starts out current on the thread that created the window.
+	// To render from another thread, release it here and make it current
+	// there; it can only be current on one thread at a time.
+	void make_current()
+	{
+		SDL_GL_MakeCurrent(m_window_handle, m_gl_context);
+	}
+
+	void release_current()
+	{
+		SDL_GL_MakeCurrent(m_window_handle, nullptr);
+	}
 };
 } // namespace yaboc::platform
 
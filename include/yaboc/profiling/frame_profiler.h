@@ -0,0 +1,155 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#ifndef YABOC_INCLUDE_YABOC_PROFILING_FRAME_PROFILER_H
+#define YABOC_INCLUDE_YABOC_PROFILING_FRAME_PROFILER_H
+
+#include "yaboc/graphics/gpu_timer_queries.h"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+
+namespace yaboc::profiling
+{
+enum class cpu_section : std::uint8_t
+{
+	// From begin_frame() to end_frame(), including any wait for vsync.
+	frame,
+	// Simulation ticks delivered to the frame, which may have run on another
+	// thread.
+	update,
+	render_submit,
+	count
+};
+
+enum class gpu_pass : std::uint8_t
+{
+	clear,
+	sprites,
+	hud,
+	count
+};
+
+inline constexpr auto cpu_section_count =
+    static_cast<std::size_t>(cpu_section::count);
+inline constexpr auto gpu_pass_count =
+    static_cast<std::size_t>(gpu_pass::count);
+
+[[nodiscard]]
+auto name(cpu_section section) -> std::string_view;
+
+[[nodiscard]]
+auto name(gpu_pass pass) -> std::string_view;
+
+struct frame_timings final
+{
+	std::uint64_t                                           frame{};
+	std::array<std::chrono::nanoseconds, cpu_section_count> cpu{};
+	std::array<std::chrono::nanoseconds, gpu_pass_count>    gpu{};
+	// False while the GPU timings are outstanding, or if they were dropped.
+	bool gpu_valid{};
+
+	[[nodiscard]]
+	auto operator[](cpu_section section) const -> std::chrono::nanoseconds
+	{
+		return cpu[static_cast<std::size_t>(section)];
+	}
+
+	[[nodiscard]]
+	auto operator[](gpu_pass pass) const -> std::chrono::nanoseconds
+	{
+		return gpu[static_cast<std::size_t>(pass)];
+	}
+};
+
+// One line of milliseconds per section and pass, for window titles and logs.
+[[nodiscard]]
+auto summary(frame_timings const& timings) -> std::string;
+
+// CPU sections are timed with the steady clock, GPU passes with timer
+// queries whose results arrive a couple of frames late. A frame is complete
+// once its GPU timings are in, or were dropped because the GPU fell behind.
+class frame_profiler final
+{
+public:
+	static constexpr std::size_t history_size{128};
+
+private:
+	using clock = std::chrono::steady_clock;
+
+	graphics::gpu_timer_queries m_gpu_timers{gpu_pass_count};
+
+	std::array<frame_timings, history_size>          m_history{};
+	std::array<clock::time_point, cpu_section_count> m_cpu_started{};
+	std::uint64_t                                    m_frame{};
+	std::uint64_t                                    m_complete_frames{};
+
+	std::ofstream m_csv{};
+	std::uint64_t m_csv_written{};
+
+	[[nodiscard]]
+	auto timings(std::uint64_t frame) -> frame_timings&
+	{
+		return m_history[frame % history_size];
+	}
+
+	void store(graphics::gpu_timer_queries::resolved_frame const& resolved);
+
+	void write_csv_rows();
+
+public:
+	// Appends the timings of every complete frame from now on to a CSV file.
+	auto write_csv(std::filesystem::path const& path) -> bool;
+
+	void begin_frame();
+
+	void end_frame();
+
+	// Waits for the GPU timings of the frames still in flight, so that they
+	// make it into the CSV file and the averages.
+	void finish();
+
+	void begin(cpu_section section);
+
+	void end(cpu_section section);
+
+	// Adds time spent on a section elsewhere, such as on another thread.
+	void record(cpu_section section, std::chrono::nanoseconds time);
+
+	// GPU passes cannot overlap.
+	void begin(gpu_pass pass);
+
+	void end(gpu_pass pass);
+
+	// Mean of the last frames complete frames. The GPU timings only count
+	// the frames that have them.
+	[[nodiscard]]
+	auto average(std::size_t frames) const -> frame_timings;
+
+	[[nodiscard]]
+	auto dropped_gpu_frames() const -> std::uint64_t
+	{
+		return m_gpu_timers.dropped_frames();
+	}
+};
+} // namespace yaboc::profiling
+
+#endif // YABOC_INCLUDE_YABOC_PROFILING_FRAME_PROFILER_H
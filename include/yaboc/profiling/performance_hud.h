@@ -0,0 +1,52 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#ifndef YABOC_INCLUDE_YABOC_PROFILING_PERFORMANCE_HUD_H
+#define YABOC_INCLUDE_YABOC_PROFILING_PERFORMANCE_HUD_H
+
+#include "yaboc/profiling/frame_profiler.h"
+#include "yaboc/sprite/sprite_renderer.h"
+#include "yaboc/sprite/sprite_sheet_array.h"
+#include "yaboc/sprite/sprite_sheet_frames.h"
+
+namespace yaboc::profiling
+{
+// A bar for every CPU section and GPU pass, in the order summary() lists
+// them, built from the UI sprites of the first sprite sheet. Bars span twice
+// the 60 Hz frame budget, and a marker shows the budget itself. The HUD has
+// its own renderer so that it can be drawn on top of any frame.
+class performance_hud final
+{
+	using subtexture_bounds = sprite::sprite_renderer::subtexture_bounds;
+
+	sprite::sprite_renderer           m_renderer;
+	sprite::sprite_sheet_array const* m_sprite_sheets{};
+
+	subtexture_bounds m_panel{};
+	subtexture_bounds m_bar{};
+	subtexture_bounds m_marker{};
+
+	[[nodiscard]]
+	auto subtexture(sprite::sprite_sheet_frames::id frame) const
+	    -> subtexture_bounds;
+
+public:
+	explicit performance_hud(sprite::sprite_sheet_array const& sheets);
+
+	void draw(frame_timings const& timings);
+};
+} // namespace yaboc::profiling
+
+#endif // YABOC_INCLUDE_YABOC_PROFILING_PERFORMANCE_HUD_H
@@ -0,0 +1,74 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#ifndef YABOC_INCLUDE_YABOC_PROFILING_STARTUP_TIMELINE_H
+#define YABOC_INCLUDE_YABOC_PROFILING_STARTUP_TIMELINE_H
+
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace yaboc::profiling
+{
+// Wall-clock spans of the work done before the first frame, from whichever
+// thread did it. Every member function may be called from any thread.
+class startup_timeline final
+{
+public:
+	using clock = std::chrono::steady_clock;
+
+	struct span final
+	{
+		std::string     name{};
+		std::thread::id thread{};
+		// Since the timeline was started; equal for a mark().
+		clock::duration begin{};
+		clock::duration end{};
+	};
+
+private:
+	clock::time_point m_origin{};
+	std::thread::id   m_main_thread{};
+
+	mutable std::mutex m_mutex{};
+	std::vector<span>  m_spans{};
+
+public:
+	// The calling thread is shown as the main one.
+	explicit startup_timeline(clock::time_point origin = clock::now());
+
+	// Returns the id to pass to end().
+	[[nodiscard]]
+	auto begin(std::string name) -> std::size_t;
+
+	void end(std::size_t span_id);
+
+	// A moment rather than a span, such as the first frame being presented.
+	void mark(std::string name);
+
+	// Copies, sorted by start.
+	[[nodiscard]]
+	auto spans() const -> std::vector<span>;
+
+	// A table of every span and a bar showing where it falls.
+	void write(std::ostream& out) const;
+};
+} // namespace yaboc::profiling
+
+#endif // YABOC_INCLUDE_YABOC_PROFILING_STARTUP_TIMELINE_H
@@ -0,0 +1,30 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#ifndef YABOC_INCLUDE_YABOC_SPRITE_BLEND_MODE_H
+#define YABOC_INCLUDE_YABOC_SPRITE_BLEND_MODE_H
+
+#include <cstdint>
+
+namespace yaboc::sprite
+{
+enum class blend_mode : std::uint8_t
+{
+	alpha,
+	additive
+};
+} // namespace yaboc::sprite
+
+#endif // YABOC_INCLUDE_YABOC_SPRITE_BLEND_MODE_H
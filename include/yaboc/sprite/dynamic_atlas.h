@@ -0,0 +1,156 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#ifndef YABOC_INCLUDE_YABOC_SPRITE_DYNAMIC_ATLAS_H
+#define YABOC_INCLUDE_YABOC_SPRITE_DYNAMIC_ATLAS_H
+
+#include "yaboc/graphics/image.h"
+#include "yaboc/sprite/skyline_packer.h"
+#include "yaboc/sprite/sprite_sheet.h"
+
+#include "glm/glm.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace yaboc::sprite
+{
+// Packs images into the layers, or pages, of a GL_TEXTURE_2D_ARRAY allocated
+// up front, so that loose sprites, extra sheets and generated glyphs can be
+// drawn in the same batches without a texture bind of their own. Frames are
+// numbered in the order they are added and keep their id for the lifetime of
+// the atlas.
+class dynamic_atlas final
+{
+	struct name_hash final
+	{
+		using is_transparent = void;
+
+		auto operator()(std::string_view name) const -> std::size_t
+		{
+			return std::hash<std::string_view>{}(name);
+		}
+	};
+
+	// Read for every sprite drawn, so kept apart from the rest.
+	std::vector<frame_uv>     m_uvs{};
+	std::vector<unsigned int> m_layers{};
+
+	std::vector<sprite_frame_data> m_frame_data{};
+	std::unordered_map<std::string, std::size_t, name_hash, std::equal_to<>>
+	    m_ids{};
+
+	std::vector<skyline_packer> m_pages{};
+
+	glm::ivec2 m_page_size{};
+	int        m_padding{};
+
+	unsigned int m_renderer_id{};
+
+	auto add_frame(std::string&&                        name,
+	               graphics::image const&               source,
+	               sprite_frame_data::subtexture_bounds bounds,
+	               glm::ivec2                           size) -> std::size_t;
+
+public:
+	struct configuration final
+	{
+		glm::ivec2  page_size{2048, 2048};
+		std::size_t page_count{4};
+		// Edge pixels are repeated this far around every frame so that
+		// filtering never picks up a neighbour.
+		int padding{1};
+	};
+
+	~dynamic_atlas();
+
+	explicit dynamic_atlas(configuration const& config);
+
+	dynamic_atlas(dynamic_atlas const&) = delete;
+	auto operator=(dynamic_atlas const&) -> dynamic_atlas& = delete;
+
+	dynamic_atlas(dynamic_atlas&& other) noexcept;
+	auto operator=(dynamic_atlas&& other) noexcept -> dynamic_atlas&;
+
+	// Packs and uploads the whole image as one frame and returns its id.
+	// Throws std::invalid_argument if the name is taken and
+	// std::runtime_error if no page has room for it.
+	auto add(std::string name, graphics::image const& picture) -> std::size_t;
+
+	// Packs every frame of the sheet, cut from its image, and returns the id
+	// of the first. The rest follow in the sheet's order, so a frame's id in
+	// the atlas is the returned id plus its id in the sheet. Throws as add().
+	auto add_sheet(sprite_sheet const& sheet, graphics::image const& picture)
+	    -> std::size_t;
+
+	[[nodiscard]]
+	auto find(std::string_view name) const -> std::optional<std::size_t>;
+
+	auto frame_count() const -> std::size_t
+	{
+		return std::size(m_frame_data);
+	}
+
+	// Bounds are in pixels of the frame's page.
+	auto frame_data(std::size_t sprite_id) const -> sprite_frame_data const&
+	{
+		assert(sprite_id < std::size(m_frame_data));
+		return m_frame_data[sprite_id];
+	}
+
+	auto uv(std::size_t sprite_id) const -> frame_uv const&
+	{
+		assert(sprite_id < std::size(m_uvs));
+		return m_uvs[sprite_id];
+	}
+
+	// Indexed by sprite id.
+	auto uvs() const -> std::span<frame_uv const>
+	{
+		return m_uvs;
+	}
+
+	// The page a frame was packed into, which is its texture layer.
+	auto layer(std::size_t sprite_id) const -> unsigned int
+	{
+		assert(sprite_id < std::size(m_layers));
+		return m_layers[sprite_id];
+	}
+
+	auto page_size() const -> glm::ivec2
+	{
+		return m_page_size;
+	}
+
+	auto page_count() const -> std::size_t
+	{
+		return std::size(m_pages);
+	}
+
+	auto renderer_id() const -> unsigned int
+	{
+		return m_renderer_id;
+	}
+};
+} // namespace yaboc::sprite
+
+#endif // YABOC_INCLUDE_YABOC_SPRITE_DYNAMIC_ATLAS_H
@@ -0,0 +1,255 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#ifndef YABOC_INCLUDE_YABOC_SPRITE_QUAD_EXPANSION_H
+#define YABOC_INCLUDE_YABOC_SPRITE_QUAD_EXPANSION_H
+
+#include "glm/glm.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define YABOC_QUAD_EXPANSION_X86
+#endif
+
+namespace yaboc::sprite
+{
+enum class vertex_format : std::uint8_t
+{
+	// Float tint and texture coordinates.
+	full,
+	// 8-bit normalised tint and 16-bit normalised texture coordinates. Tints
+	// are clamped to [0, 1].
+	compact
+};
+
+// One corner of an expanded quad.
+struct sprite_vertex final
+{
+	glm::vec2 pos{};
+	glm::vec4 tint{1.0F};
+	// Texture array coordinate, the sheet's layer is in z.
+	glm::vec3 uv{};
+};
+
+static_assert(sizeof(sprite_vertex) ==
+              (sizeof(glm::vec2) + sizeof(glm::vec4) + sizeof(glm::vec3)));
+
+struct compact_sprite_vertex final
+{
+	glm::vec2                    pos{};
+	std::array<std::uint8_t, 4>  tint{};
+	std::array<std::uint16_t, 2> uv{};
+	std::uint16_t                layer{};
+	std::uint16_t                padding{};
+};
+
+static_assert(sizeof(compact_sprite_vertex) == 20);
+
+// A whole quad, expanded in the vertex shader.
+struct sprite_instance final
+{
+	glm::vec2 centre{};
+	glm::vec2 half_size{};
+	glm::vec4 tint{1.0F};
+	glm::vec4 uv_bounds{};
+	float     layer{};
+};
+
+static_assert(sizeof(sprite_instance) ==
+              (sizeof(glm::vec2) + sizeof(glm::vec2) + sizeof(glm::vec4) +
+               sizeof(glm::vec4) + sizeof(float)));
+
+struct compact_sprite_instance final
+{
+	glm::vec2                    centre{};
+	glm::vec2                    half_size{};
+	std::array<std::uint8_t, 4>  tint{};
+	std::array<std::uint16_t, 4> uv_bounds{};
+	std::uint16_t                layer{};
+	std::uint16_t                padding{};
+};
+
+static_assert(sizeof(compact_sprite_instance) == 32);
+
+// The SIMD kernels write centre and half size as one 16 byte block.
+static_assert(offsetof(sprite_instance, half_size) == sizeof(glm::vec2));
+static_assert(offsetof(compact_sprite_instance, half_size) ==
+              sizeof(glm::vec2));
+
+constexpr auto unorm8(float value) -> std::uint8_t
+{
+	constexpr float max{255.0F};
+	return static_cast<std::uint8_t>(std::clamp(value, 0.0F, 1.0F) * max +
+	                                 0.5F);
+}
+
+constexpr auto unorm16(float value) -> std::uint16_t
+{
+	constexpr float max{65'535.0F};
+	return static_cast<std::uint16_t>(std::clamp(value, 0.0F, 1.0F) * max +
+	                                  0.5F);
+}
+
+// Everything but the geometry. Every kernel goes through these, so they all
+// quantise identically.
+inline void set_attributes(sprite_instance& instance,
+                           glm::vec4        tint,
+                           glm::vec4        uv_bounds,
+                           std::uint32_t    layer)
+{
+	instance.tint = tint;
+	instance.uv_bounds = uv_bounds;
+	instance.layer = static_cast<float>(layer);
+}
+
+inline void set_attributes(compact_sprite_instance& instance,
+                           glm::vec4                tint,
+                           glm::vec4                uv_bounds,
+                           std::uint32_t            layer)
+{
+	assert(layer <= std::numeric_limits<std::uint16_t>::max());
+	instance.tint = {unorm8(tint.x),
+	                 unorm8(tint.y),
+	                 unorm8(tint.z),
+	                 unorm8(tint.w)};
+	instance.uv_bounds = {unorm16(uv_bounds.x),
+	                      unorm16(uv_bounds.y),
+	                      unorm16(uv_bounds.z),
+	                      unorm16(uv_bounds.w)};
+	instance.layer = static_cast<std::uint16_t>(layer);
+}
+
+inline void set_vertex(sprite_vertex& vertex,
+                       glm::vec2      pos,
+                       glm::vec4      tint,
+                       glm::vec2      uv,
+                       std::uint32_t  layer)
+{
+	vertex.pos = pos;
+	vertex.tint = tint;
+	vertex.uv = {uv, static_cast<float>(layer)};
+}
+
+inline void set_vertex(compact_sprite_vertex& vertex,
+                       glm::vec2              pos,
+                       glm::vec4              tint,
+                       glm::vec2              uv,
+                       std::uint32_t          layer)
+{
+	assert(layer <= std::numeric_limits<std::uint16_t>::max());
+	vertex.pos = pos;
+	vertex.tint = {unorm8(tint.x),
+	               unorm8(tint.y),
+	               unorm8(tint.z),
+	               unorm8(tint.w)};
+	vertex.uv = {unorm16(uv.x), unorm16(uv.y)};
+	vertex.layer = static_cast<std::uint16_t>(layer);
+}
+
+// Sprites as structure of arrays, in metres. uv_bounds holds the normalised
+// min in xy and max in zw, layer the texture array layer.
+struct sprite_batch_input final
+{
+	std::span<float const>         x{};
+	std::span<float const>         y{};
+	std::span<float const>         width{};
+	std::span<float const>         height{};
+	std::span<glm::vec4 const>     uv_bounds{};
+	std::span<glm::vec4 const>     tint{};
+	std::span<std::uint32_t const> layer{};
+
+	[[nodiscard]]
+	auto size() const -> std::size_t
+	{
+		assert(std::size(y) == std::size(x) &&
+		       std::size(width) == std::size(x) &&
+		       std::size(height) == std::size(x) &&
+		       std::size(uv_bounds) == std::size(x) &&
+		       std::size(tint) == std::size(x) &&
+		       std::size(layer) == std::size(x));
+		return std::size(x);
+	}
+
+	[[nodiscard]]
+	auto subspan(std::size_t offset, std::size_t count) const
+	    -> sprite_batch_input
+	{
+		return {.x = x.subspan(offset, count),
+		        .y = y.subspan(offset, count),
+		        .width = width.subspan(offset, count),
+		        .height = height.subspan(offset, count),
+		        .uv_bounds = uv_bounds.subspan(offset, count),
+		        .tint = tint.subspan(offset, count),
+		        .layer = layer.subspan(offset, count)};
+	}
+};
+
+// Writes one instance record per sprite, or six vertex records, in the chosen
+// format to destination, scaling positions and sizes by pixels_per_metre.
+// Every kernel produces bit-identical output to the scalar one.
+using quad_expansion_kernel =
+    void (*)(sprite_batch_input const& sprites,
+             float                     pixels_per_metre,
+             std::span<std::byte>      destination);
+
+enum class simd_level : std::uint8_t
+{
+	scalar,
+	sse2,
+	avx2
+};
+
+struct quad_expansion_kernels final
+{
+	simd_level            level{};
+	quad_expansion_kernel instances{};
+	quad_expansion_kernel vertices{};
+};
+
+// The best level this CPU and build support.
+[[nodiscard]]
+auto detect_simd_level() -> simd_level;
+
+// Kernels for level, or the best ones below it that were compiled in.
+[[nodiscard]]
+auto select_quad_expansion_kernels(simd_level level, vertex_format format)
+    -> quad_expansion_kernels;
+
+namespace kernels
+{
+[[nodiscard]]
+auto scalar(vertex_format format) -> quad_expansion_kernels;
+
+#if defined(YABOC_QUAD_EXPANSION_X86)
+// The SIMD kernels use non-temporal stores, the destination is meant to be
+// mapped, write-combined memory.
+[[nodiscard]]
+auto sse2(vertex_format format) -> quad_expansion_kernels;
+
+// Built for AVX2; only call after checking detect_simd_level().
+[[nodiscard]]
+auto avx2(vertex_format format) -> quad_expansion_kernels;
+#endif
+} // namespace kernels
+} // namespace yaboc::sprite
+
+#endif // YABOC_INCLUDE_YABOC_SPRITE_QUAD_EXPANSION_H
@@ -0,0 +1,108 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#ifndef YABOC_INCLUDE_YABOC_SPRITE_RENDER_QUEUE_H
+#define YABOC_INCLUDE_YABOC_SPRITE_RENDER_QUEUE_H
+
+#include "yaboc/sprite/blend_mode.h"
+#include "yaboc/sprite/quad_expansion.h"
+#include "yaboc/sprite/sort_key.h"
+#include "yaboc/sprite/sprite_renderer.h"
+
+#include "glm/glm.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace yaboc::core
+{
+class thread_pool;
+} // namespace yaboc::core
+
+namespace yaboc::sprite
+{
+class sprite_sheet_array;
+
+// Collects a frame's sprites, radix sorts them by their 64-bit key and feeds
+// them to a sprite_renderer, changing state only where the key does.
+class render_queue final
+{
+	struct command final
+	{
+		glm::vec2                          position{};
+		glm::vec2                          size{};
+		glm::vec4                          tint{1.0F};
+		sprite_renderer::subtexture_bounds uv_bounds{};
+	};
+
+	// The commands in sorted order, as the structure of arrays that the
+	// renderer's SIMD kernels read.
+	struct sorted_sprites final
+	{
+		std::vector<float>         x{};
+		std::vector<float>         y{};
+		std::vector<float>         width{};
+		std::vector<float>         height{};
+		std::vector<glm::vec4>     uv_bounds{};
+		std::vector<glm::vec4>     tint{};
+		std::vector<std::uint32_t> layer{};
+
+		void resize(std::size_t count);
+
+		void write(std::size_t index, command const& sprite);
+
+		[[nodiscard]]
+		auto input(std::size_t offset, std::size_t count) const
+		    -> sprite_batch_input;
+	};
+
+	std::vector<command>    m_commands{};
+	std::vector<sort_entry> m_sort_entries{};
+	std::vector<sort_entry> m_sort_scratch{};
+	sorted_sprites          m_sorted{};
+
+	std::vector<sprite_sheet_array const*> m_sheets{};
+
+	// Gathers entries [begin, end) of the sorted queue into m_sorted.
+	void gather(std::size_t begin, std::size_t end);
+
+	void emit_run(sprite_renderer&   renderer,
+	              std::size_t        begin,
+	              std::size_t        end,
+	              core::thread_pool* workers);
+
+public:
+	// The returned index is what sort_key::sheet refers to.
+	auto register_sheets(sprite_sheet_array const& sheets) -> std::uint16_t;
+
+	void submit(sort_key                           key,
+	            glm::vec2                          position,
+	            glm::vec2                          size,
+	            glm::vec4                          tint,
+	            sprite_renderer::subtexture_bounds uv_bounds);
+
+	// Submits everything in key order and empties the queue. Must be called
+	// between sprite_renderer::begin_batch() and end_batch(). Runs of sprites
+	// sharing a state go through the renderer's SIMD kernels, and given
+	// workers, long ones are expanded in parallel.
+	void emit(sprite_renderer& renderer, core::thread_pool* workers = nullptr);
+
+	void clear();
+};
+} // namespace yaboc::sprite
+
+#endif // YABOC_INCLUDE_YABOC_SPRITE_RENDER_QUEUE_H
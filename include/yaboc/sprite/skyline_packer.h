@@ -0,0 +1,81 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#ifndef YABOC_INCLUDE_YABOC_SPRITE_SKYLINE_PACKER_H
+#define YABOC_INCLUDE_YABOC_SPRITE_SKYLINE_PACKER_H
+
+#include "glm/glm.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace yaboc::sprite
+{
+// Places rectangles in a fixed area one at a time. The top edge of everything
+// placed so far, the skyline, is kept as a list of horizontal segments, and a
+// rectangle goes where its far edge ends up closest to the origin, ties going
+// to the narrower spot. Rectangles are never removed; clear() starts over.
+class skyline_packer final
+{
+	struct segment final
+	{
+		int x{};
+		int y{};
+		int width{};
+	};
+
+	// Sorted by x, covering the whole width without gaps.
+	std::vector<segment> m_skyline{};
+
+	glm::ivec2   m_dimensions{};
+	std::int64_t m_used_area{};
+
+	// Where a rectangle starting at segment index would rest, if it fits.
+	[[nodiscard]]
+	auto resting_height(std::size_t index, glm::ivec2 size) const
+	    -> std::optional<int>;
+
+	void raise(std::size_t index, glm::ivec2 position, glm::ivec2 size);
+
+public:
+	explicit skyline_packer(glm::ivec2 dimensions);
+
+	// Returns the position of the rectangle's minimum corner, or nothing if it
+	// does not fit.
+	[[nodiscard]]
+	auto insert(glm::ivec2 size) -> std::optional<glm::ivec2>;
+
+	void clear();
+
+	[[nodiscard]]
+	auto dimensions() const -> glm::ivec2
+	{
+		return m_dimensions;
+	}
+
+	// The fraction of the area covered by rectangles.
+	[[nodiscard]]
+	auto occupancy() const -> float
+	{
+		return static_cast<float>(m_used_area) /
+		       static_cast<float>(static_cast<std::int64_t>(m_dimensions.x) *
+		                          m_dimensions.y);
+	}
+};
+} // namespace yaboc::sprite
+
+#endif // YABOC_INCLUDE_YABOC_SPRITE_SKYLINE_PACKER_H
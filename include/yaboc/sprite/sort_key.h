@@ -0,0 +1,77 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#ifndef YABOC_INCLUDE_YABOC_SPRITE_SORT_KEY_H
+#define YABOC_INCLUDE_YABOC_SPRITE_SORT_KEY_H
+
+#include "yaboc/sprite/blend_mode.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace yaboc::sprite
+{
+// Draw order, most significant field first. Within a layer, submissions are
+// grouped by sheet and blend mode before depth so they batch; anything that
+// must overlap in a fixed order belongs on its own layer.
+struct sort_key final
+{
+	// NOLINTBEGIN(*-magic-numbers)
+	static constexpr std::uint64_t sheet_mask{0x00FF'FF00'0000'0000};
+	static constexpr std::uint64_t blend_mask{0x0000'00FF'0000'0000};
+	static constexpr std::uint64_t state_mask{sheet_mask | blend_mask};
+
+	static constexpr unsigned sheet_shift{40U};
+	static constexpr unsigned blend_shift{32U};
+	// NOLINTEND(*-magic-numbers)
+
+	std::uint8_t  layer{};
+	std::uint16_t sheet{};
+	blend_mode    blend{};
+	std::uint32_t depth{};
+
+	[[nodiscard]]
+	constexpr auto packed() const -> std::uint64_t
+	{
+		// NOLINTBEGIN(*-magic-numbers)
+		return (static_cast<std::uint64_t>(layer) << 56U) |
+		       (static_cast<std::uint64_t>(sheet) << sheet_shift) |
+		       (static_cast<std::uint64_t>(blend) << blend_shift) |
+		       static_cast<std::uint64_t>(depth);
+		// NOLINTEND(*-magic-numbers)
+	}
+};
+
+// A packed key and the submission it orders.
+struct sort_entry final
+{
+	std::uint64_t key{};
+	std::uint32_t index{};
+};
+
+// Sorts entries by key, keeping submission order among equal keys. scratch
+// is resized to match and its contents are left unspecified.
+void radix_sort(std::vector<sort_entry>& entries,
+                std::vector<sort_entry>& scratch);
+
+// The number of entries at the front of a sorted range that share the first
+// one's sheet and blend mode, i.e. what can go in one draw state.
+[[nodiscard]]
+auto state_run_length(std::span<sort_entry const> entries) -> std::size_t;
+} // namespace yaboc::sprite
+
+#endif // YABOC_INCLUDE_YABOC_SPRITE_SORT_KEY_H
@@ -0,0 +1,93 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#ifndef YABOC_INCLUDE_YABOC_SPRITE_SPRITE_CULLER_H
+#define YABOC_INCLUDE_YABOC_SPRITE_SPRITE_CULLER_H
+
+#include "glm/glm.hpp"
+
+#include <cstddef>
+
+namespace yaboc::sprite
+{
+class static_sprite_batch;
+
+// Culls a static batch against the view on the GPU. A compute pass compacts the
+// visible sprites into its own buffer and writes the arguments for a single
+// glDrawArraysIndirect call, so the CPU never looks at individual sprites.
+class sprite_culler final
+{
+public:
+	// Where a sprite's corners are, see sprite_cull.comp.glsl.
+	struct sprite_layout final
+	{
+		std::size_t bytes_per_sprite{};
+		std::size_t bytes_per_vertex{};
+		bool        instanced{};
+	};
+
+private:
+	unsigned int m_program{};
+
+	unsigned int m_visible_sprites{};
+	std::size_t  m_capacity{};
+
+	unsigned int m_indirect_buffer{};
+
+	sprite_layout m_layout{};
+
+	int m_sprite_count_location{};
+	int m_view_min_location{};
+	int m_view_max_location{};
+
+	void reserve(std::size_t sprite_count);
+
+public:
+	~sprite_culler();
+
+	explicit sprite_culler(sprite_layout layout);
+
+	// See yaboc::prepare_shader().
+	static void prepare_shader();
+
+	sprite_culler(sprite_culler const&) = delete;
+	auto operator=(sprite_culler const&) -> sprite_culler& = delete;
+
+	sprite_culler(sprite_culler&& other) noexcept;
+	auto operator=(sprite_culler&& other) noexcept -> sprite_culler&;
+
+	// Dispatches the pass for an uploaded batch. The view is in pixels, like
+	// the sprites. Leaves no program bound.
+	void cull(static_sprite_batch const& batch,
+	          glm::vec2                  view_min,
+	          glm::vec2                  view_max);
+
+	// Vertex buffer holding the visible sprites.
+	[[nodiscard]]
+	auto buffer_id() const -> unsigned int
+	{
+		return m_visible_sprites;
+	}
+
+	// Draw-indirect buffer holding one command at offset zero.
+	[[nodiscard]]
+	auto indirect_buffer_id() const -> unsigned int
+	{
+		return m_indirect_buffer;
+	}
+};
+} // namespace yaboc::sprite
+
+#endif // YABOC_INCLUDE_YABOC_SPRITE_SPRITE_CULLER_H
@@ -16,81 +16,241 @@
 #ifndef YABOC_INCLUDE_YABOC_SPRITE_SPRITE_RENDERER_H
 #define YABOC_INCLUDE_YABOC_SPRITE_SPRITE_RENDERER_H
 
+#include "yaboc/graphics/persistent_ring_buffer.h"
+#include "yaboc/sprite/blend_mode.h"
+#include "yaboc/sprite/dynamic_atlas.h"
+#include "yaboc/sprite/quad_expansion.h"
+#include "yaboc/sprite/sprite_culler.h"
 #include "yaboc/sprite/sprite_sheet.h"
+#include "yaboc/sprite/sprite_sheet_array.h"
+#include "yaboc/sprite/static_sprite_batch.h"
 
 #include "glad/gl.h"
 #include "glm/glm.hpp"
 
-#include <array>
+#include <atomic>
+#include <cstddef>
+#include <optional>
 #include <span>
 
 namespace yaboc::sprite
 {
+enum class submission_mode
+{
+	// Six fully expanded vertices per sprite; kept as a fallback path.
+	vertices,
+	// One compact record per sprite, expanded in the vertex shader.
+	instanced
+};
+
 class sprite_renderer final
 {
 	unsigned int m_shader{};
 
 	unsigned int m_vao{};
-	unsigned int m_vbo{};
-
-	struct vertex final
-	{
-		glm::vec2 pos{};
-		glm::vec4 tint{1.0F};
-		glm::vec2 uv{};
-	};
 
-	static_assert(sizeof(vertex) ==
-	              (sizeof(glm::vec2) + sizeof(glm::vec4) + sizeof(glm::vec2)));
+	static constexpr std::size_t verts_per_quad{6};
 
-	static constexpr std::size_t num_buffers{3};
-
-	struct vertex_buffer_region final
+	static constexpr auto bytes_per_sprite(submission_mode mode,
+	                                       vertex_format   format)
+	    -> std::size_t
 	{
-		std::span<vertex> region{};
+		auto const compact = format == vertex_format::compact;
+		if (mode == submission_mode::instanced)
+		{
+			return compact ? sizeof(compact_sprite_instance)
+			               : sizeof(sprite_instance);
+		}
+		auto const vertex_size =
+		    compact ? sizeof(compact_sprite_vertex) : sizeof(sprite_vertex);
+		return vertex_size * verts_per_quad;
+	}
 
-		GLsync fence{nullptr};
+	// Layout mandated by glMultiDrawArraysIndirect.
+	struct draw_indirect_command final
+	{
+		GLuint count{};
+		GLuint instance_count{};
+		GLuint first{};
+		GLuint base_instance{};
 	};
 
-	std::array<vertex_buffer_region, num_buffers> m_vertex_buffer_regions{};
+	graphics::persistent_ring_buffer m_ring_buffer;
+	unsigned int                     m_bound_buffer{};
+
+	std::span<std::byte> m_batch_memory{};
+	std::size_t          m_batch_first_sprite{};
 
-	std::size_t m_current_vertex_buffer_region{};
+	unsigned int m_bound_texture{};
+	blend_mode   m_blend_mode{blend_mode::alpha};
+
+	// One slice of commands per frame the GPU may still be reading, plus the
+	// one being recorded. The ring's frame fence protects them as well.
+	bool                             m_multi_draw_indirect{};
+	unsigned int                     m_indirect_buffer{};
+	std::span<draw_indirect_command> m_indirect_commands{};
+	std::size_t                      m_commands_per_frame{};
+	std::size_t                      m_num_indirect_slices{};
+	std::size_t                      m_indirect_slice{};
+	std::size_t                      m_recorded_commands{};
+	std::size_t                      m_submitted_commands{};
 
 	unsigned int m_current_sprite_count{};
 	std::size_t  m_sprites_per_batch{};
 
 	static constexpr std::size_t default_sprites_per_batch{1'000};
+	static constexpr std::size_t default_frames_in_flight{3};
+	static constexpr std::size_t default_indirect_commands_per_frame{256};
 
 	int m_pixels_per_metre{};
 
+	// Visible area in pixels; static batches are culled against it.
+	glm::vec2                    m_view_min{};
+	glm::vec2                    m_view_max{};
+	int                          m_projection_location{};
+	std::optional<sprite_culler> m_culler{};
+
+	submission_mode m_mode{};
+	vertex_format   m_format{};
+	std::size_t     m_bytes_per_sprite{};
+
+	// Scalar kernel for single sprites, widest SIMD one for batches.
+	quad_expansion_kernel m_write_sprites{};
+	quad_expansion_kernel m_expand_quads{};
+
+	void reserve_batch();
+
+	auto reserve_sprites(std::size_t sprite_count) -> std::span<std::byte>;
+
+	void record_draw(draw_indirect_command const& command);
+
+	void submit_recorded_draws();
+
+	void bind_sprite_sheet_texture(unsigned int texture_id);
+
+	void flush_pending_state_change();
+
+	void update_projection();
+
+	[[nodiscard]]
+	auto make_draw_command(std::size_t first_sprite,
+	                       std::size_t sprite_count) const
+	    -> draw_indirect_command;
+
+	[[nodiscard]]
+	auto vertex_stride() const -> std::size_t;
+
 public:
 	struct configuration final
 	{
 		glm::vec2 reference_resolution{640, 360};
 		int pixels_per_metre{static_cast<int>(reference_resolution.x / 10)};
 		std::size_t sprites_per_batch{default_sprites_per_batch};
+		submission_mode mode{submission_mode::instanced};
+		vertex_format   format{vertex_format::compact};
+		// Frames the CPU may run ahead of the GPU before end_batch() blocks.
+		std::size_t frames_in_flight{default_frames_in_flight};
+		// Initial size of the mapped ring in bytes. It grows if a single frame
+		// does not fit, see buffer_statistics().
+		std::size_t buffer_size{sprites_per_batch * frames_in_flight *
+		                        bytes_per_sprite(mode, format)};
+		// Record every batch of a frame and submit them with a single
+		// glMultiDrawArraysIndirect from end_batch().
+		bool multi_draw_indirect{true};
+		// Batches beyond this in one frame are drawn directly.
+		std::size_t indirect_commands_per_frame{
+		    default_indirect_commands_per_frame};
+		// Cull static batches against the view in a compute pass and draw the
+		// survivors from the arguments it writes.
+		bool gpu_culling{true};
+		// Upper bound for the kernels used by submit_sprites().
+		simd_level max_simd_level{detect_simd_level()};
 	};
 
 	struct subtexture_bounds final
 	{
-		glm::vec2 min{};
-		glm::vec2 max{};
+		glm::vec2    min{};
+		glm::vec2    max{};
+		unsigned int layer{};
+	};
+
+	// Sprites written from several threads into one reserved range. Only
+	// claim() and write() may be called off the thread that owns the GL
+	// context.
+	class parallel_submission final
+	{
+		sprite_renderer const*   m_renderer{};
+		std::span<std::byte>     m_memory{};
+		std::size_t              m_capacity{};
+		std::atomic<std::size_t> m_claimed{};
+
+		friend class sprite_renderer;
+
+		parallel_submission(sprite_renderer const* renderer,
+		                    std::span<std::byte>   memory);
+
+	public:
+		// Bumps the cursor and returns the first of count consecutive slots.
+		// Callers that need the sprites in a given order can instead claim
+		// everything up front and hand out the slots themselves.
+		[[nodiscard]]
+		auto claim(std::size_t count) -> std::size_t;
+
+		// Every claimed slot must be written before the submission ends.
+		void write(std::size_t       slot,
+		           glm::vec2         position,
+		           glm::vec2         size,
+		           glm::vec4         tint,
+		           subtexture_bounds uv_bounds) const;
+
+		// Writes sprites to consecutive slots from first_slot on, with the
+		// same kernel as submit_sprites().
+		void write(std::size_t               first_slot,
+		           sprite_batch_input const& sprites) const;
+
+		[[nodiscard]]
+		auto claimed() const -> std::size_t
+		{
+			return m_claimed.load(std::memory_order_acquire);
+		}
 	};
 
 	~sprite_renderer();
 
 	explicit sprite_renderer(configuration&& config);
 
-	sprite_renderer(sprite_renderer const&) = delete;
-	sprite_renderer(sprite_renderer&&) = default;
+	// Starts compiling the programs a renderer with this configuration uses,
+	// see yaboc::prepare_shader().
+	static void prepare_shaders(configuration const& config);
 
+	sprite_renderer(sprite_renderer const&) = delete;
 	auto operator=(sprite_renderer const&) -> sprite_renderer& = delete;
-	auto operator=(sprite_renderer&&) -> sprite_renderer& = default;
+
+	// The GL buffers and the mappings into them would be released twice.
+	sprite_renderer(sprite_renderer&&) = delete;
+	auto operator=(sprite_renderer&&) -> sprite_renderer& = delete;
 
 	void begin_batch();
 
 	void use_sprite_sheet(sprite_sheet const& sheet);
 
+	// Binds every sheet in the array at once; sprites select their sheet
+	// through subtexture_bounds::layer.
+	void use_sprite_sheets(sprite_sheet_array const& sheets);
+
+	// Binds every page of the atlas; sprites select their page through
+	// subtexture_bounds::layer, see dynamic_atlas::layer().
+	void use_atlas(dynamic_atlas const& atlas);
+
+	// Frames start in blend_mode::alpha.
+	void use_blend_mode(blend_mode mode);
+
+	// The area of the world that is drawn, in metres. Defaults to the
+	// reference resolution.
+	void use_view(glm::vec2 min, glm::vec2 max);
+
+	// Closes the frame: the written sprites are fenced as one unit and the
+	// call blocks if the GPU is more than frames_in_flight frames behind.
 	void end_batch();
 
 	auto submit_sprite(glm::vec2         position,
@@ -98,7 +258,51 @@ public:
 	                   glm::vec4         tint,
 	                   subtexture_bounds uv_bounds) -> void;
 
+	// Expands the whole batch with the widest SIMD kernel the CPU supports,
+	// producing the same bytes as calling submit_sprite() for each sprite.
+	void submit_sprites(sprite_batch_input const& sprites);
+
 	void flush();
+
+	// Reserves room for up to max_sprites, drawn in slot order after the
+	// sprites submitted before.
+	[[nodiscard]]
+	auto begin_parallel_submission(std::size_t max_sprites)
+	    -> parallel_submission;
+
+	// Draws the claimed slots. The workers must be done writing.
+	void end_parallel_submission(parallel_submission const& submission);
+
+	// A batch whose slots are in this renderer's sprite layout.
+	[[nodiscard]]
+	auto make_static_batch() const -> static_sprite_batch;
+
+	void write_static_sprite(static_sprite_batch& batch,
+	                         std::size_t          slot,
+	                         glm::vec2            position,
+	                         glm::vec2            size,
+	                         glm::vec4            tint,
+	                         subtexture_bounds    uv_bounds) const;
+
+	// Uploads whatever changed in the batch and draws it, in order with the
+	// sprites submitted before. With gpu_culling only the sprites in view are
+	// drawn, in no particular order. Must be called between begin_batch() and
+	// end_batch().
+	void draw_static(static_sprite_batch& batch);
+
+	[[nodiscard]]
+	auto buffer_statistics() const
+	    -> graphics::persistent_ring_buffer::statistics const&
+	{
+		return m_ring_buffer.counters();
+	}
+
+private:
+	void write_sprite(std::span<std::byte> memory,
+	                  glm::vec2            position,
+	                  glm::vec2            size,
+	                  glm::vec4            tint,
+	                  subtexture_bounds    uv_bounds) const;
 };
 } // namespace yaboc::sprite
 
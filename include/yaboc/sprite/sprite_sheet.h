@@ -16,10 +16,15 @@
 #ifndef YABOC_INCLUDE_YABOC_SPRITE_SPRITE_SHEET_H
 #define YABOC_INCLUDE_YABOC_SPRITE_SPRITE_SHEET_H
 
+#include "yaboc/assets/asset_pack.h"
+
 #include "glm/glm.hpp"
 
+#include <cassert>
+#include <cstdint>
+#include <span>
 #include <string>
-#include <unordered_map>
+#include <string_view>
 #include <vector>
 
 namespace yaboc::sprite
@@ -49,32 +54,74 @@ struct sprite_frame_data final
 	glm::ivec2        size{};
 };
 
+// Where a frame is in its sheet, normalised to texture coordinates. Four to a
+// cache line, and none straddles one.
+struct alignas(16) frame_uv final
+{
+	glm::vec2 min{};
+	glm::vec2 max{};
+};
+
+static_assert(sizeof(frame_uv) == 16);
+
 class sprite_sheet final
 {
-	std::unordered_map<std::string, std::size_t> m_id_lookup{};
+	// Read for every sprite drawn, so kept apart from the rest.
+	std::vector<frame_uv> m_uvs{};
 
+	// Names and pixel bounds, for loading and tools.
 	std::vector<sprite_frame_data> m_sprite_frame_data{};
 
+	// A minimal perfect hash of the frame names, see core/perfect_hash.h.
+	std::vector<std::uint32_t> m_name_seeds{};
+	std::vector<std::uint32_t> m_name_ids{};
+
 	sprite_sheet_meta m_meta_data{};
 
 	unsigned int m_renderer_id{};
+	unsigned int m_layer{};
+
+	// Fills the tables derived from m_sprite_frame_data.
+	void index_frames();
 
 public:
 	explicit sprite_sheet(std::string&& specification_path);
 
+	// From a frame table cooked by yaboc_cook, which needs no parsing.
+	explicit sprite_sheet(assets::frame_table_view const& frames);
+
 	auto meta_data() const -> sprite_sheet_meta const&
 	{
 		return m_meta_data;
 	}
 
-	auto id_from_name(std::string const& name) const -> std::size_t;
+	// For names only known at runtime. Sprites named in code should use the
+	// ids generated from the sheet, see static_frame_table.h.
+	auto id_from_name(std::string_view name) const -> std::size_t;
+
+	auto frame_count() const -> std::size_t
+	{
+		return std::size(m_sprite_frame_data);
+	}
 
-	auto frame_data(std::size_t sprite_id) const -> sprite_frame_data
+	auto frame_data(std::size_t sprite_id) const -> sprite_frame_data const&
 	{
 		assert(sprite_id < std::size(m_sprite_frame_data));
 		return m_sprite_frame_data[sprite_id];
 	}
 
+	auto uv(std::size_t sprite_id) const -> frame_uv const&
+	{
+		assert(sprite_id < std::size(m_uvs));
+		return m_uvs[sprite_id];
+	}
+
+	// Indexed by sprite id.
+	auto uvs() const -> std::span<frame_uv const>
+	{
+		return m_uvs;
+	}
+
 	void renderer_id(unsigned int id)
 	{
 		m_renderer_id = id;
@@ -84,6 +131,16 @@ public:
 	{
 		return m_renderer_id;
 	}
+
+	void layer(unsigned int layer)
+	{
+		m_layer = layer;
+	}
+
+	auto layer() const -> unsigned int
+	{
+		return m_layer;
+	}
 };
 } // namespace yaboc::sprite
 
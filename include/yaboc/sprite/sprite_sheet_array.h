@@ -0,0 +1,92 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#ifndef YABOC_INCLUDE_YABOC_SPRITE_SPRITE_SHEET_ARRAY_H
+#define YABOC_INCLUDE_YABOC_SPRITE_SPRITE_SHEET_ARRAY_H
+
+#include "yaboc/graphics/image.h"
+#include "yaboc/sprite/sprite_sheet.h"
+
+#include "glm/glm.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+namespace yaboc::sprite
+{
+// Uploads same-sized sprite sheets into the layers of a single
+// GL_TEXTURE_2D_ARRAY so that sprites from any of them share a batch. A
+// sheet's layer is its index in the array.
+class sprite_sheet_array final
+{
+	std::vector<sprite_sheet> m_sheets{};
+
+	glm::ivec2 m_dimensions{};
+
+	unsigned int m_renderer_id{};
+
+public:
+	~sprite_sheet_array();
+
+	explicit sprite_sheet_array(std::vector<sprite_sheet>&& sheets);
+
+	// Uploads images decoded beforehand by load_images(), one per sheet.
+	sprite_sheet_array(std::vector<sprite_sheet>&&         sheets,
+	                   std::vector<graphics::image> const& images);
+
+	// Uploads cooked textures, one per sheet, straight from the pack along
+	// with their mip chains. BC7 textures stay compressed on the GPU. All of
+	// them must share a format.
+	sprite_sheet_array(std::vector<sprite_sheet>&&               sheets,
+	                   std::vector<assets::texture_view> const& textures);
+
+	// Decodes the image of every sheet. Needs no GL context, so it can run on
+	// another thread. Throws std::runtime_error if an image cannot be read.
+	[[nodiscard]]
+	static auto load_images(std::vector<sprite_sheet> const& sheets)
+	    -> std::vector<graphics::image>;
+
+	sprite_sheet_array(sprite_sheet_array const&) = delete;
+	auto operator=(sprite_sheet_array const&) -> sprite_sheet_array& = delete;
+
+	sprite_sheet_array(sprite_sheet_array&& other) noexcept;
+	auto operator=(sprite_sheet_array&& other) noexcept -> sprite_sheet_array&;
+
+	auto sheet(std::size_t layer) const -> sprite_sheet const&
+	{
+		assert(layer < std::size(m_sheets));
+		return m_sheets[layer];
+	}
+
+	auto size() const -> std::size_t
+	{
+		return std::size(m_sheets);
+	}
+
+	// Every layer has the same dimensions.
+	auto dimensions() const -> glm::ivec2
+	{
+		return m_dimensions;
+	}
+
+	auto renderer_id() const -> unsigned int
+	{
+		return m_renderer_id;
+	}
+};
+} // namespace yaboc::sprite
+
+#endif // YABOC_INCLUDE_YABOC_SPRITE_SPRITE_SHEET_ARRAY_H
@@ -0,0 +1,112 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#ifndef YABOC_INCLUDE_YABOC_SPRITE_STATIC_FRAME_TABLE_H
+#define YABOC_INCLUDE_YABOC_SPRITE_STATIC_FRAME_TABLE_H
+
+#include "yaboc/core/perfect_hash.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace yaboc::sprite
+{
+// A frame of a sprite sheet as it was when the game was built, see
+// yaboc_generate_sprite_ids() in tools/cmake/GenerateSpriteIds.cmake.
+struct static_frame final
+{
+	std::string_view name{};
+	int              min_x{};
+	int              min_y{};
+	int              max_x{};
+	int              max_y{};
+	int              size_x{};
+	int              size_y{};
+};
+
+// The frames of a sprite sheet, indexed by the generated enum Id whose values
+// are the frame ids of the sheet. Names only known at runtime are found
+// through a minimal perfect hash made while compiling.
+template <class Id, std::size_t Count>
+    requires std::is_enum_v<Id>
+class static_frame_table final
+{
+	std::array<static_frame, Count>  m_frames{};
+	core::static_perfect_hash<Count> m_lookup{};
+
+	static consteval auto names(std::array<static_frame, Count> const& frames)
+	    -> std::array<std::string_view, Count>
+	{
+		std::array<std::string_view, Count> names{};
+		for (std::size_t id{}; id < Count; ++id)
+		{
+			names[id] = frames[id].name;
+		}
+		return names;
+	}
+
+public:
+	consteval explicit static_frame_table(
+	    std::array<static_frame, Count> const& frames)
+	    : m_frames{frames}
+	    , m_lookup{core::make_perfect_hash(names(frames))}
+	{}
+
+	[[nodiscard]]
+	constexpr auto operator[](Id id) const -> static_frame const&
+	{
+		return m_frames[std::to_underlying(id)];
+	}
+
+	[[nodiscard]]
+	constexpr auto find(std::string_view name) const -> std::optional<Id>
+	{
+		if constexpr (Count == 0)
+		{
+			return std::nullopt;
+		}
+		else
+		{
+			auto const id = core::perfect_hash_position(m_lookup.seeds,
+			                                            m_lookup.positions,
+			                                            name);
+			if (m_frames[id].name != name)
+			{
+				return std::nullopt;
+			}
+			return static_cast<Id>(id);
+		}
+	}
+
+	[[nodiscard]]
+	constexpr auto frames() const -> std::array<static_frame, Count> const&
+	{
+		return m_frames;
+	}
+
+	[[nodiscard]]
+	static constexpr auto size() -> std::size_t
+	{
+		return Count;
+	}
+};
+} // namespace yaboc::sprite
+
+#endif // YABOC_INCLUDE_YABOC_SPRITE_STATIC_FRAME_TABLE_H
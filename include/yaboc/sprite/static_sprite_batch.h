@@ -0,0 +1,87 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#ifndef YABOC_INCLUDE_YABOC_SPRITE_STATIC_SPRITE_BATCH_H
+#define YABOC_INCLUDE_YABOC_SPRITE_STATIC_SPRITE_BATCH_H
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace yaboc::sprite
+{
+// Sprites that are written once and drawn every frame from a GPU buffer. Each
+// sprite owns a slot; the slots touched since the last upload() form a single
+// dirty range that is all that gets sent to the GPU.
+//
+// Slots are stored in the layout of the sprite_renderer that created the
+// batch, see sprite_renderer::make_static_batch().
+class static_sprite_batch final
+{
+	unsigned int m_buffer{};
+	std::size_t  m_buffer_capacity{};
+
+	std::vector<std::byte> m_sprites{};
+	std::size_t            m_bytes_per_sprite{};
+	std::size_t            m_size{};
+
+	std::size_t m_dirty_begin{};
+	std::size_t m_dirty_end{};
+
+	void mark_dirty(std::size_t slot);
+
+public:
+	~static_sprite_batch();
+
+	explicit static_sprite_batch(std::size_t bytes_per_sprite);
+
+	static_sprite_batch(static_sprite_batch const&) = delete;
+	auto operator=(static_sprite_batch const&) -> static_sprite_batch& = delete;
+
+	static_sprite_batch(static_sprite_batch&& other) noexcept;
+	auto operator=(static_sprite_batch&& other) noexcept
+	    -> static_sprite_batch&;
+
+	// Returns the new slot; its contents are undefined until written.
+	auto append() -> std::size_t;
+
+	// Fills the hole with the last sprite and returns the slot that sprite
+	// was moved from, which is slot itself if it was the last one.
+	auto remove(std::size_t slot) -> std::size_t;
+
+	void clear();
+
+	// Writable memory for a slot, which is marked dirty.
+	auto sprite_memory(std::size_t slot) -> std::span<std::byte>;
+
+	// Sends the dirty range to the GPU, reallocating the buffer if the batch
+	// outgrew it.
+	void upload();
+
+	[[nodiscard]]
+	auto size() const -> std::size_t
+	{
+		return m_size;
+	}
+
+	[[nodiscard]]
+	auto buffer_id() const -> unsigned int
+	{
+		return m_buffer;
+	}
+};
+} // namespace yaboc::sprite
+
+#endif // YABOC_INCLUDE_YABOC_SPRITE_STATIC_SPRITE_BATCH_H
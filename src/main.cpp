@@ -13,227 +13,285 @@
 //
 // You should have received a copy of the GNU General Public License along with
 // this program. If not, see <https://www.gnu.org/licenses/>.
-#include "yaboc/ecs/components/all.h"
-#include "yaboc/ecs/systems/sprite_render_system.h"
+#include "yaboc/app/options.h"
+#include "yaboc/assets/asset_pack.h"
+#include "yaboc/assets/loading_service.h"
+#include "yaboc/assets/startup_loader.h"
+#include "yaboc/core/thread_pool.h"
+#include "yaboc/ecs/render_snapshot.h"
+#include "yaboc/game/presentation.h"
+#include "yaboc/game/simulation.h"
+#include "yaboc/graphics/framebuffer.h"
+#include "yaboc/graphics/image.h"
+#include "yaboc/graphics/shader.h"
 #include "yaboc/platform/sdl_context.h"
 #include "yaboc/platform/sdl_gl_window.h"
-#include "yaboc/sprite/sprite_renderer.h"
-#include "yaboc/sprite/sprite_sheet.h"
+#include "yaboc/profiling/frame_profiler.h"
+#include "yaboc/profiling/startup_timeline.h"
+
+#if defined(YABOC_HAS_EGL)
+#include "yaboc/platform/egl_headless_context.h"
+#endif
 
-#include "entt/entt.hpp"
 #include "glad/gl.h"
-#include "glm/gtc/matrix_transform.hpp"
-#include "glm/gtc/type_ptr.hpp"
-#include "nlohmann/json.hpp"
 #include "SDL3/SDL_events.h"
+#include "SDL3/SDL_filesystem.h"
 #include "SDL3/SDL_init.h"
 #include "SDL3/SDL_video.h"
-#include "stb_image.h"
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cstddef>
+#include <exception>
 #include <filesystem>
 #include <format>
-#include <fstream>
+#include <future>
 #include <iostream>
-#include <memory>
-#include <numeric>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <stop_token>
 #include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 namespace
 {
 constexpr int window_default_width{1'280};
 constexpr int window_default_height{720};
 
-constexpr int       opengl_major_version{4};
-constexpr int       opengl_minor_version{6};
-constexpr glm::vec4 clear_colour{0.157F, 0.157F, 0.157F, 1.0F};
+constexpr int opengl_major_version{4};
+constexpr int opengl_minor_version{6};
+// Mesa's llvmpipe stops at 4.5, which is all the renderer needs.
+constexpr int headless_opengl_minor_version{5};
+
+// How often the window title shows the latest timings.
+constexpr int title_update_interval{30};
 
 using namespace std::chrono_literals;
 
-constexpr auto dt = std::chrono::duration<std::int64_t, std::ratio<1, 60>>{1};
-constexpr auto dt_f =
-    std::chrono::duration_cast<std::chrono::duration<float>>(dt);
+using yaboc::game::dt;
+using yaboc::game::dt_f;
 using duration = decltype(std::chrono::steady_clock::duration{} + dt);
 using time_point = std::chrono::time_point<std::chrono::steady_clock, duration>;
-} // namespace
 
-namespace yaboc
+// Text for the window title from the render thread. Only the main thread may
+// change the title.
+struct pending_title final
 {
-auto load_sprite_sheet(sprite::sprite_sheet_meta const& sprite_sheet_meta_data)
-    -> GLuint;
-} // namespace yaboc
+	std::mutex  mutex{};
+	std::string text{};
+};
 
-namespace yaboc
-{
-auto load_level(entt::registry&    registry,
-                std::string const& level_file,
-                std::size_t        sprite_id) -> void;
-auto create_sprite_entity(entt::registry& registry,
-                          std::size_t     sprite_id,
-                          glm::vec2       position,
-                          glm::vec2       size) -> entt::entity;
-
-void load_level(entt::registry&    registry,
-                std::string const& level_file,
-                std::size_t        sprite_id)
+// Sprite sheet images for the render thread to stream in. Only the main
+// thread uses the loading service, so it requests them and hands over the
+// result.
+struct pending_reload final
 {
-	std::ifstream level_stream{level_file};
-	std::string   line{};
+	std::mutex                                       mutex{};
+	std::future<std::vector<yaboc::graphics::image>> images{};
+};
 
-	float const     gap{0.03125F};
-	glm::vec2 const brick_size{0.75F, 0.25F};
+// Runs on its own thread with the window's context current. Draws the latest
+// snapshots for as long as the main thread lets it, interpolated by how far
+// the clock is past the latest tick, just as the accumulator would.
+void render_loop(std::stop_token const&                stop,
+                 yaboc::platform::sdl_gl_window&       window,
+                 yaboc::game::presentation&            view,
+                 yaboc::ecs::render_snapshot_exchange& exchange,
+                 std::atomic<bool> const&              show_hud,
+                 pending_reload&                       reload,
+                 pending_title&                        title,
+                 yaboc::profiling::startup_timeline*   startup)
+{
+	auto& profiler = view.profiler();
 
-	int bricks_per_row{};
-	int y{};
-	while (std::getline(level_stream, line))
+	yaboc::ecs::render_snapshot_exchange::frame latest{};
+	for (int frame{}; !stop.stop_requested(); ++frame)
 	{
-		unsigned int      brick_type{};
-		std::stringstream line_stream{line};
+		profiler.begin_frame();
+
+		if (show_hud.load(std::memory_order_relaxed) != view.hud_visible())
+		{
+			view.toggle_hud();
+		}
 
-		int x{};
-		while (line_stream >> brick_type)
 		{
-			if (brick_type != 0)
+			std::scoped_lock const lock{reload.mutex};
+			if (reload.images.valid())
 			{
-				entt::entity const brick = registry.create();
-
-				using transform_component = ecs::components::transform;
-				using sprite_component = ecs::components::sprite;
-
-				registry.emplace<transform_component>(
-				    brick,
-				    glm::vec2{(static_cast<float>(x) * gap) +
-				                  (static_cast<float>(x) * brick_size.x),
-				              static_cast<float>(y) * gap +
-				                  (static_cast<float>(y) * brick_size.y)});
-				registry.emplace<sprite_component>(brick,
-				                                   sprite_id,
-				                                   brick_size,
-				                                   glm::vec4{1.0F});
-
-				registry.emplace<ecs::tags::brick>(brick);
+				view.reload_sprite_sheets(std::move(reload.images));
 			}
+		}
 
-			++x;
+		if (exchange.take(latest))
+		{
+			auto const since_tick =
+			    std::chrono::steady_clock::now() - latest.latest->taken_at;
+			auto const alpha = std::clamp(
+			    std::chrono::duration<float>{since_tick} / dt_f,
+			    0.0F,
+			    1.0F);
+			view.render(latest, alpha);
 		}
-		bricks_per_row = std::max(bricks_per_row, x);
 
-		++y;
+		window.swap_buffers();
+
+		if (frame == 0 && startup != nullptr)
+		{
+			startup->mark("first frame");
+			startup->write(std::cerr);
+		}
+
+		profiler.end_frame();
+
+		if (frame % title_update_interval == 0)
+		{
+			auto summary = yaboc::profiling::summary(
+			    profiler.average(yaboc::game::profile_average_frames));
+
+			std::scoped_lock const lock{title.mutex};
+			title.text = std::move(summary);
+		}
 	}
 
-	// Ensure the bricks are centered along the X-axis.
-	// TODO(Dave): A better level/scene file will be able to parent things
-	// properly. NOLINTBEGIN(*-magic-numbers)
-	auto brick_row_midpoint = static_cast<float>(bricks_per_row) / 2.0F;
-	registry.ctx().emplace<ecs::components::brick_group>(glm::vec2{
-	    (gap / 2.0F + 5.0F -
-	     (brick_row_midpoint * (brick_size.x) + brick_row_midpoint * gap)) +
-	        brick_size.x / 2.0F,
-	    0.25F + brick_size.y / 2.0F});
-	// NOLINTEND(*-magic-numbers)
+	profiler.finish();
 }
 
-namespace ecs::components
-{
-struct direction final
+auto default_shader_cache() -> std::filesystem::path
 {
-	float horizontal{};
-	float vertical{};
-};
+	auto* preferences = SDL_GetPrefPath("bigdavedev", "yaboc");
+	if (preferences == nullptr)
+	{
+		return {};
+	}
 
-struct velocity final
-{
-	float x{};
-	float y{};
-};
-} // namespace ecs::components
+	std::filesystem::path directory{preferences};
+	SDL_free(preferences);
+	return directory / "shader_cache";
+}
 
-namespace ecs::system
+// An explicitly requested pack must open; the default one only if it is
+// there.
+auto open_pack(std::filesystem::path const& path, bool required)
+    -> std::optional<yaboc::assets::asset_pack>
 {
-class move_entity_system final
-{
-	entt::registry* m_registry{};
-
-public:
-	explicit move_entity_system(entt::registry& registry)
-	    : m_registry{&registry}
-	{}
-
-	void operator()(entt::entity                entity,
-	                components::velocity const  velocity,
-	                components::direction const direction)
+	if (!required && !std::filesystem::exists(path))
 	{
-		auto& transform = m_registry->get<components::transform>(entity);
-		transform.position.x +=
-		    direction.horizontal * velocity.x * dt_f.count();
-		transform.position.y += direction.vertical * velocity.y * dt_f.count();
+		return std::nullopt;
 	}
-};
-} // namespace ecs::system
-} // namespace yaboc
+	return yaboc::assets::asset_pack{path};
+}
 
-auto main([[maybe_unused]] int argc, [[maybe_unused]] char* argv[]) -> int
+auto run_windowed(yaboc::app::options const&          settings,
+                  yaboc::profiling::startup_timeline& timeline) -> int
 {
+	auto step = timeline.begin("map asset pack");
+	auto const pack = settings.pack.empty()
+	                      ? open_pack(yaboc::app::default_pack_file, false)
+	                      : open_pack(settings.pack, true);
+	timeline.end(step);
+
+	yaboc::use_shader_pack(pack ? &*pack : nullptr);
+	yaboc::assets::startup_loader loader{timeline, pack ? &*pack : nullptr};
+
+	// For everything loaded once the game is running. Only the main thread
+	// makes requests.
+	yaboc::assets::loading_service streaming{pack ? &*pack : nullptr};
+
+	step = timeline.begin("sdl init");
 	yaboc::platform::sdl_context const sdl{opengl_major_version,
 	                                       opengl_minor_version};
+	timeline.end(step);
 
+	step = timeline.begin("window and context");
+	std::string const              window_title{"Yet Another Breakout Clone"};
 	yaboc::platform::sdl_gl_window window{window_default_width,
 	                                      window_default_height,
-	                                      "Yet Another Breakout Clone"};
-
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	                                      window_title};
+	timeline.end(step);
 
 	bool running{true};
 
-	auto sprite_sheet =
-	    yaboc::sprite::sprite_sheet{"assets/data/sprites/sprite_sheet.json"};
-
-	auto sprite_sheet_texture_id =
-	    yaboc::load_sprite_sheet(sprite_sheet.meta_data());
-
-	sprite_sheet.renderer_id(sprite_sheet_texture_id);
-
-	entt::registry registry{};
-
-	// TODO(Dave): A better level/scene file will be able to specify properties
-	// properly. NOLINTBEGIN(*-magic-numbers)
-	auto paddle = registry.create();
-	registry.emplace<yaboc::ecs::components::transform>(paddle,
-	                                                    glm::vec2{5.0F, 5.25F});
-	registry.emplace<yaboc::ecs::components::sprite>(
-	    paddle,
-	    sprite_sheet.id_from_name("entity/paddleRed"),
-	    glm::vec2{1.0F, 0.25F},
-	    glm::vec4{1.0F});
-	registry.emplace<yaboc::ecs::components::velocity>(paddle, 10.0F, 0.0F);
-	registry.emplace<yaboc::ecs::components::direction>(paddle);
-	registry.emplace<yaboc::ecs::tags::player>(paddle);
-
-	auto ball = registry.create();
-	registry.emplace<yaboc::ecs::components::transform>(ball,
-	                                                    glm::vec2{5.0F, 5.0F});
-	registry.emplace<yaboc::ecs::components::sprite>(
-	    ball,
-	    sprite_sheet.id_from_name("entity/ballGrey"),
-	    glm::vec2{0.25F, 0.25F},
-	    glm::vec4{1.0F});
-	registry.emplace<yaboc::ecs::components::velocity>(ball, 0.2F, 0.0F);
-	registry.emplace<yaboc::ecs::components::direction>(ball, -1.0F, 0.0F);
-	registry.emplace<yaboc::ecs::tags::ball>(ball);
-	// NOLINTEND(*-magic-numbers)
-
-	yaboc::load_level(
-	    registry,
-	    "assets/data/levels/level_01.txt",
-	    sprite_sheet.id_from_name("entity/element_grey_rectangle"));
-
-	auto renderer = std::make_unique<yaboc::sprite::sprite_renderer>(
-	    yaboc::sprite::sprite_renderer::configuration{});
-
-	auto render_system =
-	    yaboc::ecs::system::sprite_render_system{std::move(renderer),
-	                                             &sprite_sheet};
+	if (!settings.no_shader_cache)
+	{
+		yaboc::use_program_cache(settings.shader_cache.empty()
+		                             ? default_shader_cache()
+		                             : settings.shader_cache);
+	}
+
+	step = timeline.begin("start shader compiles");
+	yaboc::game::presentation::prepare_shaders();
+	timeline.end(step);
+
+	auto sprite_sheets = loader.sprite_sheets();
+
+	// One pool for both threads, so that they do not fight over the cores.
+	yaboc::core::thread_pool workers{};
+
+	// Created while the context is current here, used from the render thread
+	// only, and destroyed once the context is back.
+	step = timeline.begin("finish shaders");
+	yaboc::game::presentation view{std::move(sprite_sheets), workers, true};
+	timeline.end(step);
+
+	auto const level = loader.level();
+
+	step = timeline.begin("create scene");
+	yaboc::game::simulation world{view.sprite_sheets().sheet(0),
+	                              level,
+	                              workers};
+	timeline.end(step);
+
+	if (!settings.profile_csv.empty() &&
+	    !view.profiler().write_csv(settings.profile_csv))
+	{
+		std::cerr << "failed to open " << settings.profile_csv << '\n';
+		return 1;
+	}
+
+	yaboc::ecs::render_snapshot_exchange exchange{};
+	{
+		auto& snapshot = exchange.acquire();
+		world.capture(snapshot);
+		exchange.publish(snapshot);
+	}
+
+	// Read now, as the view belongs to the render thread from here on.
+	auto const sprite_sheet_paths = view.sprite_sheet_paths();
+
+	std::atomic<bool> show_hud{view.hud_visible()};
+	pending_reload    reload{};
+	pending_title     title{};
+
+	// Whatever the render thread throws ends the main loop, and is rethrown
+	// here once the thread is joined.
+	std::exception_ptr render_error{};
+	std::atomic<bool>  render_failed{};
+
+	window.release_current();
+	std::jthread render_thread{[&](std::stop_token const& stop) {
+		window.make_current();
+		try
+		{
+			render_loop(stop,
+			            window,
+			            view,
+			            exchange,
+			            show_hud,
+			            reload,
+			            title,
+			            settings.startup_timeline ? &timeline : nullptr);
+		}
+		catch (...)
+		{
+			render_error = std::current_exception();
+			render_failed.store(true, std::memory_order_release);
+		}
+		window.release_current();
+	}};
 
 	std::span const sdl_key_states = [] {
 		int         num_keys{};
@@ -246,7 +304,7 @@ auto main([[maybe_unused]] int argc, [[maybe_unused]] char* argv[]) -> int
 	time_point current_time = std::chrono::steady_clock::now();
 	duration   accumulator{0s};
 
-	while (running)
+	while (running && !render_failed.load(std::memory_order_acquire))
 	{
 		time_point const new_time = std::chrono::steady_clock::now();
 		auto const       frame_time =
@@ -265,23 +323,40 @@ auto main([[maybe_unused]] int argc, [[maybe_unused]] char* argv[]) -> int
 				{
 					running = false;
 				}
+				if (sdl_event.key.keysym.sym == SDLK_F1)
+				{
+					show_hud.store(!show_hud.load(std::memory_order_relaxed),
+					               std::memory_order_relaxed);
+				}
+				// Picks up edited assets without a hitch. Cooked sprite
+				// sheets cannot change while the pack is mapped.
+				if (sdl_event.key.keysym.sym == SDLK_F5)
+				{
+					world.load_level(streaming.load_level(
+					    std::string{yaboc::assets::level_file}));
+					if (!pack)
+					{
+						auto images = streaming.load_images(sprite_sheet_paths);
+						std::scoped_lock const lock{reload.mutex};
+						reload.images = std::move(images);
+					}
+				}
 				break;
 			}
 			}
 		}
 
-		registry.get<yaboc::ecs::components::direction>(paddle).horizontal =
-		    [sdl_key_states] {
-			    if (sdl_key_states[SDL_SCANCODE_LEFT] != 0U)
-			    {
-				    return -1.0F;
-			    }
-			    if (sdl_key_states[SDL_SCANCODE_RIGHT] != 0U)
-			    {
-				    return 1.0F;
-			    }
-			    return 0.0F;
-		    }();
+		world.steer_paddle([sdl_key_states] {
+			if (sdl_key_states[SDL_SCANCODE_LEFT] != 0U)
+			{
+				return -1.0F;
+			}
+			if (sdl_key_states[SDL_SCANCODE_RIGHT] != 0U)
+			{
+				return 1.0F;
+			}
+			return 0.0F;
+		}());
 
 		accumulator += frame_time;
 
@@ -290,101 +365,248 @@ auto main([[maybe_unused]] int argc, [[maybe_unused]] char* argv[]) -> int
 			time_step += dt;
 			accumulator -= dt;
 
-			registry
-			    .view<yaboc::ecs::components::velocity,
-			          yaboc::ecs::components::direction>()
-			    .each(yaboc::ecs::system::move_entity_system{registry});
-
-			auto hit_wall = [](glm::vec2& position, glm::vec2 half_size) {
-				if (position.x - half_size.x < 0.0F)
-				{
-					position.x = half_size.x;
-				}
+			auto& snapshot = exchange.acquire();
+			world.tick(snapshot);
+			exchange.publish(snapshot);
+		}
 
-				constexpr float playfield_length{10.0F};
-				if (position.x + half_size.x > playfield_length)
-				{
-					position.x = playfield_length - half_size.x;
-				}
-			};
-
-			registry.view<yaboc::ecs::tags::player>().each(
-			    [&registry, hit_wall](entt::entity entity) {
-				    auto& transform =
-				        registry.get<yaboc::ecs::components::transform>(entity);
-				    auto half_size =
-				        registry.get<yaboc::ecs::components::sprite>(entity)
-				            .size /
-				        2.0F;
-
-				    hit_wall(transform.position, half_size);
-			    });
+		{
+			std::scoped_lock const lock{title.mutex};
+			if (!title.text.empty())
+			{
+				window.title(std::format("{} | {}", window_title, title.text));
+				title.text.clear();
+			}
 		}
 
-		glClearBufferfv(GL_COLOR, 0, glm::value_ptr(clear_colour));
+		// Presentation no longer paces this loop, so sleep until the next
+		// tick is due.
+		std::this_thread::sleep_until(new_time + (dt - accumulator));
+	}
 
-		render_system(registry);
+	render_thread.request_stop();
+	render_thread.join();
+	window.make_current();
 
-		window.swap_buffers();
+	if (render_error)
+	{
+		std::rethrow_exception(render_error);
+	}
+	return 0;
+}
+
+#if defined(YABOC_HAS_EGL)
+// Renders a fixed number of frames offscreen, one simulation step each, so
+// that every run produces the same images no matter how fast the machine is.
+// Simulation and rendering take turns on this thread.
+auto run_headless(yaboc::app::options const&          settings,
+                  yaboc::profiling::startup_timeline& timeline) -> int
+{
+	auto step = timeline.begin("map asset pack");
+	auto const pack = settings.pack.empty()
+	                      ? std::nullopt
+	                      : open_pack(settings.pack, true);
+	timeline.end(step);
+
+	yaboc::use_shader_pack(pack ? &*pack : nullptr);
+	yaboc::assets::startup_loader loader{timeline, pack ? &*pack : nullptr};
+
+	step = timeline.begin("egl context");
+	yaboc::platform::egl_headless_context const context{
+	    opengl_major_version,
+	    headless_opengl_minor_version};
+	timeline.end(step);
+
+	yaboc::graphics::framebuffer const target{window_default_width,
+	                                          window_default_height};
+	target.bind();
+
+	if (!settings.no_shader_cache)
+	{
+		yaboc::use_program_cache(settings.shader_cache);
+	}
+
+	step = timeline.begin("start shader compiles");
+	yaboc::game::presentation::prepare_shaders();
+	timeline.end(step);
+
+	auto sprite_sheets = loader.sprite_sheets();
+
+	yaboc::core::thread_pool workers{};
+
+	step = timeline.begin("finish shaders");
+	yaboc::game::presentation view{std::move(sprite_sheets), workers, false};
+	timeline.end(step);
+
+	auto const level = loader.level();
+
+	step = timeline.begin("create scene");
+	yaboc::game::simulation world{view.sprite_sheets().sheet(0),
+	                              level,
+	                              workers};
+	timeline.end(step);
+
+	auto& profiler = view.profiler();
+	if (!settings.profile_csv.empty() &&
+	    !profiler.write_csv(settings.profile_csv))
+	{
+		std::cerr << "failed to open " << settings.profile_csv << '\n';
+		return 1;
 	}
 
-	glDeleteTextures(1, &sprite_sheet_texture_id);
+	auto const compare = !settings.golden_directory.empty();
+	auto const capture = !settings.capture_directory.empty();
+	if (capture)
+	{
+		std::filesystem::create_directories(settings.capture_directory);
+	}
+
+	auto const max_differing = static_cast<std::size_t>(
+	    settings.max_differing_pixels * window_default_width *
+	    window_default_height);
+
+	yaboc::ecs::render_snapshot_exchange        exchange{};
+	yaboc::ecs::render_snapshot_exchange::frame latest{};
+
+	int                      failed_frames{};
+	std::chrono::nanoseconds total_time{};
+	std::chrono::nanoseconds worst_time{};
+
+	for (int frame{}; frame < settings.frames; ++frame)
+	{
+		auto const frame_start = std::chrono::steady_clock::now();
+		profiler.begin_frame();
+
+		auto& snapshot = exchange.acquire();
+		world.tick(snapshot);
+		exchange.publish(snapshot);
+		exchange.take(latest);
+
+		// Always the latest tick, so that the images do not depend on timing.
+		view.render(latest, 1.0F);
+
+		// Without a swap nothing paces the CPU, so wait for the GPU to get
+		// comparable frame times.
+		glFinish();
+
+		if (frame == 0 && settings.startup_timeline)
+		{
+			timeline.mark("first frame");
+			timeline.write(std::cerr);
+		}
+
+		profiler.end_frame();
+		auto const frame_time = std::chrono::steady_clock::now() - frame_start;
+		total_time += frame_time;
+		worst_time = std::max(worst_time, frame_time);
+
+		if (!compare && !capture)
+		{
+			continue;
+		}
+
+		auto const file_name = std::format("frame_{:04}.png", frame);
+		auto const pixels = target.read_pixels();
+
+		if (capture &&
+		    !yaboc::graphics::write_png(settings.capture_directory / file_name,
+		                                pixels))
+		{
+			std::cerr << "failed to write " << file_name << '\n';
+			++failed_frames;
+		}
+
+		if (!compare)
+		{
+			continue;
+		}
 
+		auto const golden =
+		    yaboc::graphics::load_png(settings.golden_directory / file_name);
+		if (!golden)
+		{
+			std::cerr << "missing golden image " << file_name << '\n';
+			++failed_frames;
+			continue;
+		}
+
+		auto const difference = yaboc::graphics::compare_images(
+		    *golden,
+		    pixels,
+		    settings.channel_tolerance);
+		if (difference.size_mismatch ||
+		    difference.differing_pixels > max_differing)
+		{
+			std::cerr << std::format(
+			    "{}: {} pixels differ, by up to {}{}\n",
+			    file_name,
+			    difference.differing_pixels,
+			    difference.max_delta,
+			    difference.size_mismatch ? " (size mismatch)" : "");
+			++failed_frames;
+		}
+	}
+
+	using milliseconds = std::chrono::duration<double, std::milli>;
+	std::cout << std::format(
+	    "{} frames, {:.3f} ms average, {:.3f} ms worst\n",
+	    settings.frames,
+	    milliseconds{total_time}.count() / std::max(settings.frames, 1),
+	    milliseconds{worst_time}.count());
+	profiler.finish();
+	std::cout << yaboc::profiling::summary(profiler.average(
+	                 static_cast<std::size_t>(settings.frames)))
+	          << '\n';
+
+	if (failed_frames != 0)
+	{
+		std::cerr << failed_frames << " of " << settings.frames
+		          << " frames failed\n";
+		return 1;
+	}
 	return 0;
 }
+#endif
+} // namespace
 
-namespace yaboc
-{
-auto load_sprite_sheet(sprite::sprite_sheet_meta const& sprite_sheet_meta_data)
-    -> GLuint
+auto main(int argc, char* argv[]) -> int
 {
-	glm::ivec2 dimensions{};
-	int        stb_num_channels{};
-	auto*      sprite_sheet_pixel_data =
-	    stbi_load(sprite_sheet_meta_data.name.c_str(),
-	              &dimensions.x,
-	              &dimensions.y,
-	              &stb_num_channels,
-	              0);
-
-	assert(dimensions == sprite_sheet_meta_data.dimensions);
-
-	GLuint sprite_sheet_texture_id{};
-	glCreateTextures(GL_TEXTURE_2D, 1, &sprite_sheet_texture_id);
-
-	glTextureParameteri(sprite_sheet_texture_id,
-	                    GL_TEXTURE_WRAP_S,
-	                    GL_CLAMP_TO_EDGE);
-	glTextureParameteri(sprite_sheet_texture_id,
-	                    GL_TEXTURE_WRAP_T,
-	                    GL_CLAMP_TO_EDGE);
-	glTextureParameteri(sprite_sheet_texture_id,
-	                    GL_TEXTURE_MIN_FILTER,
-	                    GL_LINEAR_MIPMAP_LINEAR);
-	glTextureParameteri(sprite_sheet_texture_id,
-	                    GL_TEXTURE_MAG_FILTER,
-	                    GL_LINEAR);
-
-	glTextureStorage2D(sprite_sheet_texture_id,
-	                   1,
-	                   GL_RGBA8,
-	                   sprite_sheet_meta_data.dimensions.x,
-	                   sprite_sheet_meta_data.dimensions.y);
-
-	glTextureSubImage2D(sprite_sheet_texture_id,
-	                    0,
-	                    0,
-	                    0,
-	                    sprite_sheet_meta_data.dimensions.x,
-	                    sprite_sheet_meta_data.dimensions.y,
-	                    GL_RGBA,
-	                    GL_UNSIGNED_BYTE,
-	                    sprite_sheet_pixel_data);
-
-	glGenerateTextureMipmap(sprite_sheet_texture_id);
-
-	stbi_image_free(sprite_sheet_pixel_data);
-
-	return sprite_sheet_texture_id;
+	yaboc::profiling::startup_timeline timeline{};
+
+	std::span const arguments{argv, static_cast<std::size_t>(argc)};
+
+	auto const settings = yaboc::app::parse_options(arguments);
+	if (!settings)
+	{
+		yaboc::app::print_usage(arguments[0]);
+		return 2;
+	}
+
+	if (!settings->headless)
+	{
+		try
+		{
+			return run_windowed(*settings, timeline);
+		}
+		catch (std::exception const& error)
+		{
+			std::cerr << error.what() << '\n';
+			return 1;
+		}
+	}
+
+#if defined(YABOC_HAS_EGL)
+	try
+	{
+		return run_headless(*settings, timeline);
+	}
+	catch (std::exception const& error)
+	{
+		std::cerr << error.what() << '\n';
+		return 1;
+	}
+#else
+	std::cerr << "this build has no headless support\n";
+	return 1;
+#endif
 }
-} // namespace yaboc
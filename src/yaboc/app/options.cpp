@@ -0,0 +1,108 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#include "yaboc/app/options.h"
+
+#include <algorithm>
+#include <exception>
+#include <iostream>
+#include <string>
+
+namespace yaboc::app
+{
+void print_usage(std::string_view program)
+{
+	std::cerr << "usage: " << program
+	          << " [--profile-csv FILE] [--startup-timeline] [--pack FILE]"
+	             " [--shader-cache DIR | --no-shader-cache]"
+	             " [--headless [--frames N] [--capture DIR] [--compare DIR]"
+	             " [--tolerance T] [--max-differing FRACTION]]\n";
+}
+
+auto parse_options(std::span<char*> arguments) -> std::optional<options>
+{
+	options parsed{};
+	for (std::size_t index{1}; index < std::size(arguments); ++index)
+	{
+		std::string_view const argument{arguments[index]};
+		auto const value = [&]() -> std::optional<std::string> {
+			if (index + 1 == std::size(arguments))
+			{
+				return std::nullopt;
+			}
+			return std::string{arguments[++index]};
+		};
+
+		try
+		{
+			if (argument == "--headless")
+			{
+				parsed.headless = true;
+			}
+			else if (argument == "--frames")
+			{
+				parsed.frames = std::stoi(value().value());
+			}
+			else if (argument == "--capture")
+			{
+				parsed.capture_directory = value().value();
+			}
+			else if (argument == "--compare")
+			{
+				parsed.golden_directory = value().value();
+			}
+			else if (argument == "--tolerance")
+			{
+				parsed.channel_tolerance = static_cast<std::uint8_t>(
+				    std::clamp(std::stoi(value().value()), 0, 255));
+			}
+			else if (argument == "--max-differing")
+			{
+				parsed.max_differing_pixels = std::stod(value().value());
+			}
+			else if (argument == "--profile-csv")
+			{
+				parsed.profile_csv = value().value();
+			}
+			else if (argument == "--pack")
+			{
+				parsed.pack = value().value();
+			}
+			else if (argument == "--startup-timeline")
+			{
+				parsed.startup_timeline = true;
+			}
+			else if (argument == "--shader-cache")
+			{
+				parsed.shader_cache = value().value();
+			}
+			else if (argument == "--no-shader-cache")
+			{
+				parsed.no_shader_cache = true;
+			}
+			else
+			{
+				return std::nullopt;
+			}
+		}
+		catch (std::exception const&)
+		{
+			// A missing or malformed value.
+			return std::nullopt;
+		}
+	}
+	return parsed;
+}
+} // namespace yaboc::app
@@ -0,0 +1,401 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#include "yaboc/assets/asset_pack.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace yaboc::assets
+{
+namespace
+{
+struct mapping final
+{
+	std::byte const* data{};
+	std::size_t      size{};
+	void*            handle{};
+};
+
+auto map_file(std::filesystem::path const& path) -> mapping
+{
+	auto fail = [&path](char const* what) {
+		return std::runtime_error{std::string{what} + " " + path.string()};
+	};
+
+#if defined(_WIN32)
+	auto* file = CreateFileW(path.c_str(),
+	                         GENERIC_READ,
+	                         FILE_SHARE_READ,
+	                         nullptr,
+	                         OPEN_EXISTING,
+	                         FILE_ATTRIBUTE_NORMAL,
+	                         nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		throw fail("failed to open");
+	}
+
+	LARGE_INTEGER size{};
+	auto* handle = GetFileSizeEx(file, &size) != 0
+	                   ? CreateFileMappingW(file,
+	                                        nullptr,
+	                                        PAGE_READONLY,
+	                                        0,
+	                                        0,
+	                                        nullptr)
+	                   : nullptr;
+	CloseHandle(file);
+	if (handle == nullptr)
+	{
+		throw fail("failed to map");
+	}
+
+	auto const* data = MapViewOfFile(handle, FILE_MAP_READ, 0, 0, 0);
+	if (data == nullptr)
+	{
+		CloseHandle(handle);
+		throw fail("failed to map");
+	}
+
+	return {.data = static_cast<std::byte const*>(data),
+	        .size = static_cast<std::size_t>(size.QuadPart),
+	        .handle = handle};
+#else
+	// NOLINTNEXTLINE(*-vararg)
+	auto const file = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (file < 0)
+	{
+		throw fail("failed to open");
+	}
+
+	struct stat info
+	{};
+	if (fstat(file, &info) != 0 || info.st_size <= 0)
+	{
+		close(file);
+		throw fail("failed to map");
+	}
+
+	auto const size = static_cast<std::size_t>(info.st_size);
+	auto*      data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+	// The mapping keeps the file open.
+	close(file);
+	if (data == MAP_FAILED)
+	{
+		throw fail("failed to map");
+	}
+
+	return {.data = static_cast<std::byte const*>(data), .size = size};
+#endif
+}
+
+// Objects are used where they lie in the mapping; the cooker put every one of
+// them on a suitable boundary.
+template <class T>
+auto view_as(std::span<std::byte const> bytes,
+             std::uint64_t              offset,
+             std::uint64_t              count)
+    -> std::optional<std::span<T const>>
+{
+	if (offset > std::size(bytes) ||
+	    count > (std::size(bytes) - offset) / sizeof(T))
+	{
+		return std::nullopt;
+	}
+
+	auto const* first = bytes.subspan(offset).data();
+	if (reinterpret_cast<std::uintptr_t>(first) % alignof(T) != 0)
+	{
+		return std::nullopt;
+	}
+	return std::span{reinterpret_cast<T const*>(first), count};
+}
+
+template <class T>
+auto view_as(std::span<std::byte const> bytes, std::uint64_t offset = 0)
+    -> T const*
+{
+	auto const view = view_as<T>(bytes, offset, 1);
+	return view ? std::data(*view) : nullptr;
+}
+
+auto view_as_string(std::span<std::byte const> bytes,
+                    std::uint64_t              offset,
+                    std::uint64_t size) -> std::optional<std::string_view>
+{
+	auto const characters = view_as<char>(bytes, offset, size);
+	if (!characters)
+	{
+		return std::nullopt;
+	}
+	return std::string_view{std::data(*characters), std::size(*characters)};
+}
+} // namespace
+
+asset_pack::~asset_pack()
+{
+	unmap();
+}
+
+asset_pack::asset_pack(std::filesystem::path const& path)
+{
+	auto const mapped = map_file(path);
+	m_data = mapped.data;
+	m_size = mapped.size;
+	m_mapping_handle = mapped.handle;
+
+	auto fail = [this, &path](char const* what) {
+		unmap();
+		return std::runtime_error{path.string() + ": " + what};
+	};
+
+	std::span const bytes{m_data, m_size};
+
+	auto const* header = view_as<pack_header>(bytes);
+	if (header == nullptr || header->magic != pack_magic)
+	{
+		throw fail("not an asset pack");
+	}
+	if (header->version != pack_version)
+	{
+		throw fail("written by another version of yaboc_cook");
+	}
+
+	auto const entries = view_as<pack_entry>(bytes,
+	                                         header->directory_offset,
+	                                         header->entry_count);
+	auto const names = view_as_string(
+	    bytes,
+	    header->directory_offset + header->entry_count * sizeof(pack_entry),
+	    header->names_size);
+	if (!entries || !names)
+	{
+		throw fail("truncated directory");
+	}
+	m_entries = *entries;
+	m_names = *names;
+
+	for (auto const& entry: m_entries)
+	{
+		if (entry.name_offset > std::size(m_names) ||
+		    entry.name_size > std::size(m_names) - entry.name_offset ||
+		    entry.offset > header->directory_offset ||
+		    entry.size > header->directory_offset - entry.offset)
+		{
+			throw fail("corrupt directory");
+		}
+	}
+}
+
+asset_pack::asset_pack(asset_pack&& other) noexcept
+    : m_data{std::exchange(other.m_data, nullptr)}
+    , m_size{std::exchange(other.m_size, 0)}
+    , m_mapping_handle{std::exchange(other.m_mapping_handle, nullptr)}
+    , m_entries{std::exchange(other.m_entries, {})}
+    , m_names{std::exchange(other.m_names, {})}
+{}
+
+auto asset_pack::operator=(asset_pack&& other) noexcept -> asset_pack&
+{
+	if (this != &other)
+	{
+		unmap();
+
+		m_data = std::exchange(other.m_data, nullptr);
+		m_size = std::exchange(other.m_size, 0);
+		m_mapping_handle = std::exchange(other.m_mapping_handle, nullptr);
+		m_entries = std::exchange(other.m_entries, {});
+		m_names = std::exchange(other.m_names, {});
+	}
+	return *this;
+}
+
+void asset_pack::unmap()
+{
+	if (m_data == nullptr)
+	{
+		return;
+	}
+
+#if defined(_WIN32)
+	UnmapViewOfFile(m_data);
+	CloseHandle(m_mapping_handle);
+#else
+	// NOLINTNEXTLINE(*-const-cast)
+	munmap(const_cast<std::byte*>(m_data), m_size);
+#endif
+
+	m_data = nullptr;
+	m_size = 0;
+	m_mapping_handle = nullptr;
+}
+
+auto asset_pack::entry_name(pack_entry const& entry) const -> std::string_view
+{
+	return m_names.substr(entry.name_offset, entry.name_size);
+}
+
+auto asset_pack::find(std::string_view name, pack_entry_kind kind) const
+    -> std::optional<std::span<std::byte const>>
+{
+	auto const entry = std::ranges::lower_bound(
+	    m_entries,
+	    name,
+	    {},
+	    [this](pack_entry const& candidate) { return entry_name(candidate); });
+	if (entry == std::end(m_entries) || entry_name(*entry) != name ||
+	    entry->kind != kind)
+	{
+		return std::nullopt;
+	}
+	return std::span{m_data, m_size}.subspan(entry->offset, entry->size);
+}
+
+auto asset_pack::sprite_frames(std::string_view name) const
+    -> std::optional<frame_table_view>
+{
+	auto const blob = find(name, pack_entry_kind::sprite_frames);
+	if (!blob)
+	{
+		return std::nullopt;
+	}
+
+	auto const* header = view_as<packed_frame_table_header>(*blob);
+	if (header == nullptr)
+	{
+		return std::nullopt;
+	}
+
+	auto const frames_offset = sizeof(packed_frame_table_header);
+	auto const frames =
+	    view_as<packed_frame>(*blob, frames_offset, header->frame_count);
+	auto const names = view_as_string(
+	    *blob,
+	    frames_offset + header->frame_count * sizeof(packed_frame),
+	    header->names_size);
+	if (!frames || !names)
+	{
+		return std::nullopt;
+	}
+
+	frame_table_view table{.frames = *frames,
+	                       .names = *names,
+	                       .width = header->width,
+	                       .height = header->height};
+
+	auto const in_names = [&table](std::uint32_t offset, std::uint32_t size) {
+		return offset <= std::size(table.names) &&
+		       size <= std::size(table.names) - offset;
+	};
+	if (!in_names(header->texture_name_offset, header->texture_name_size) ||
+	    !std::ranges::all_of(table.frames, [&](packed_frame const& frame) {
+		    return in_names(frame.name_offset, frame.name_size);
+	    }))
+	{
+		return std::nullopt;
+	}
+	table.texture = table.names.substr(header->texture_name_offset,
+	                                   header->texture_name_size);
+	return table;
+}
+
+auto asset_pack::texture(std::string_view name) const
+    -> std::optional<texture_view>
+{
+	auto const blob = find(name, pack_entry_kind::texture);
+	if (!blob)
+	{
+		return std::nullopt;
+	}
+
+	auto const* header = view_as<packed_texture_header>(*blob);
+	if (header == nullptr || header->level_count == 0 ||
+	    (header->format != texture_format::rgba8 &&
+	     header->format != texture_format::bc7))
+	{
+		return std::nullopt;
+	}
+
+	auto const levels = view_as<packed_texture_level>(
+	    *blob,
+	    sizeof(packed_texture_header),
+	    header->level_count);
+	if (!levels ||
+	    !std::ranges::all_of(*levels, [&](packed_texture_level const& level) {
+		    return level.offset <= std::size(*blob) &&
+		           level.size <= std::size(*blob) - level.offset;
+	    }))
+	{
+		return std::nullopt;
+	}
+	return texture_view{*header, *levels, *blob};
+}
+
+auto asset_pack::level(std::string_view name) const
+    -> std::optional<level_grid>
+{
+	auto const blob = find(name, pack_entry_kind::level);
+	if (!blob)
+	{
+		return std::nullopt;
+	}
+
+	auto const* header = view_as<packed_level_header>(*blob);
+	if (header == nullptr || header->columns < 0 || header->rows < 0)
+	{
+		return std::nullopt;
+	}
+
+	auto const cells = view_as<std::uint8_t>(
+	    *blob,
+	    sizeof(packed_level_header),
+	    static_cast<std::uint64_t>(header->columns) *
+	        static_cast<std::uint64_t>(header->rows));
+	if (!cells)
+	{
+		return std::nullopt;
+	}
+	return level_grid{.columns = header->columns,
+	                  .rows = header->rows,
+	                  .cells = *cells};
+}
+
+auto asset_pack::shader(std::string_view name) const
+    -> std::optional<std::string_view>
+{
+	auto const blob = find(name, pack_entry_kind::shader);
+	if (!blob || std::empty(*blob))
+	{
+		return std::nullopt;
+	}
+
+	// Without the terminator, which is only there for glShaderSource.
+	return view_as_string(*blob, 0, std::size(*blob) - 1);
+}
+} // namespace yaboc::assets
@@ -0,0 +1,62 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#include "yaboc/assets/level_grid.h"
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+#include <string>
+
+namespace yaboc::assets
+{
+auto parse_level(std::istream& text) -> level_data
+{
+	std::vector<std::vector<std::uint8_t>> rows{};
+
+	std::string line{};
+	while (std::getline(text, line))
+	{
+		auto&             row = rows.emplace_back();
+		std::stringstream line_stream{line};
+
+		unsigned int brick_type{};
+		while (line_stream >> brick_type)
+		{
+			assert(brick_type <= std::numeric_limits<std::uint8_t>::max());
+			row.push_back(static_cast<std::uint8_t>(brick_type));
+		}
+	}
+
+	level_data level{};
+	level.rows = static_cast<int>(std::size(rows));
+	for (auto const& row: rows)
+	{
+		level.columns =
+		    std::max(level.columns, static_cast<int>(std::size(row)));
+	}
+
+	level.cells.reserve(std::size(rows) *
+	                    static_cast<std::size_t>(level.columns));
+	for (auto& row: rows)
+	{
+		row.resize(static_cast<std::size_t>(level.columns));
+		level.cells.insert(std::end(level.cells),
+		                   std::begin(row),
+		                   std::end(row));
+	}
+	return level;
+}
+} // namespace yaboc::assets
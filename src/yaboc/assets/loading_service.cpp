@@ -0,0 +1,71 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#include "yaboc/assets/loading_service.h"
+
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+
+namespace yaboc::assets
+{
+loading_service::loading_service(asset_pack const* pack,
+                                 std::size_t       thread_count)
+    : m_pack{pack}
+    , m_workers{thread_count}
+{}
+
+auto loading_service::load_level(std::string path) -> std::future<level_data>
+{
+	return m_workers.async([pack = m_pack, path = std::move(path)] {
+		if (pack != nullptr)
+		{
+			if (auto const cooked = pack->level(path))
+			{
+				return level_data{.columns = cooked->columns,
+				                  .rows = cooked->rows,
+				                  .cells = {std::begin(cooked->cells),
+				                            std::end(cooked->cells)}};
+			}
+		}
+
+		std::ifstream text{path};
+		if (!text)
+		{
+			throw std::runtime_error{"failed to open " + path};
+		}
+		return parse_level(text);
+	});
+}
+
+auto loading_service::load_images(std::vector<std::string> paths)
+    -> std::future<std::vector<graphics::image>>
+{
+	return m_workers.async([paths = std::move(paths)] {
+		std::vector<graphics::image> images{};
+		images.reserve(std::size(paths));
+		for (auto const& path: paths)
+		{
+			auto picture = graphics::load_png(path);
+			if (!picture)
+			{
+				throw std::runtime_error{"failed to load " + path};
+			}
+			images.push_back(std::move(*picture));
+		}
+		return images;
+	});
+}
+} // namespace yaboc::assets
@@ -0,0 +1,160 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#include "yaboc/assets/startup_loader.h"
+
+#include "yaboc/sprite/sprite_sheet_frames.h"
+
+#include "glm/glm.hpp"
+
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+
+namespace yaboc::assets
+{
+namespace
+{
+// The sprite ids in sprite_sheet_frames.h are frame indices of the sheet they
+// were generated from. Throws std::runtime_error if the sheet that got loaded
+// is not that one, as every sprite would be drawn wrong.
+void check_sprite_ids(sprite::sprite_sheet const& sheet)
+{
+	auto const& frames = sprite::sprite_sheet_frames::table.frames();
+
+	auto matches = sheet.frame_count() == std::size(frames);
+	for (std::size_t id{}; matches && id < std::size(frames); ++id)
+	{
+		auto const& data = sheet.frame_data(id);
+		auto const& frame = frames[id];
+		matches = data.name == frame.name &&
+		          data.bounds.min == glm::ivec2{frame.min_x, frame.min_y} &&
+		          data.bounds.max == glm::ivec2{frame.max_x, frame.max_y};
+	}
+
+	if (!matches)
+	{
+		throw std::runtime_error{std::string{sprite_sheet_file} +
+		                         " does not match the sprite ids yaboc was "
+		                         "built with"};
+	}
+}
+} // namespace
+
+template <class T>
+auto startup_loader::wait(std::future<T>& result, std::string name) -> T
+{
+	auto const waiting = m_timeline->begin(std::move(name));
+	auto       value = result.get();
+	m_timeline->end(waiting);
+	return value;
+}
+
+auto startup_loader::cooked_sprite_sheets(asset_pack const* pack)
+    -> std::optional<sprite_sheet_files>
+{
+	if (pack == nullptr)
+	{
+		return std::nullopt;
+	}
+
+	auto const frames = pack->sprite_frames(sprite_sheet_file);
+	if (!frames)
+	{
+		return std::nullopt;
+	}
+
+	auto texture = pack->texture(frames->texture);
+	if (!texture)
+	{
+		return std::nullopt;
+	}
+
+	sprite_sheet_files files{};
+	files.sheets.emplace_back(*frames);
+	files.textures.push_back(*texture);
+	return files;
+}
+
+startup_loader::startup_loader(profiling::startup_timeline& timeline,
+                               asset_pack const*            pack)
+    : m_timeline{&timeline}
+    , m_pack{pack}
+{
+	if (m_pack != nullptr)
+	{
+		m_cooked_level = m_pack->level(level_file);
+	}
+
+	m_sprite_sheets = m_workers.async([&timeline, pack] {
+		if (auto cooked = cooked_sprite_sheets(pack))
+		{
+			check_sprite_ids(cooked->sheets.front());
+			return std::move(*cooked);
+		}
+
+		sprite_sheet_files files{};
+
+		auto step = timeline.begin("parse sprite sheets");
+		files.sheets.emplace_back(std::string{sprite_sheet_file});
+		check_sprite_ids(files.sheets.front());
+		timeline.end(step);
+
+		step = timeline.begin("decode sprite sheets");
+		files.images = sprite::sprite_sheet_array::load_images(files.sheets);
+		timeline.end(step);
+
+		return files;
+	});
+
+	if (m_cooked_level)
+	{
+		return;
+	}
+
+	m_level = m_workers.async([&timeline] {
+		auto const    step = timeline.begin("parse level");
+		std::ifstream text{std::string{level_file}};
+		auto          level = parse_level(text);
+		timeline.end(step);
+		return level;
+	});
+}
+
+auto startup_loader::sprite_sheets() -> sprite::sprite_sheet_array
+{
+	auto files = wait(m_sprite_sheets, "wait for sprite sheets");
+
+	auto const step = m_timeline->begin("upload sprite sheets");
+	auto       sheets =
+	    std::empty(files.textures)
+	        ? sprite::sprite_sheet_array{std::move(files.sheets), files.images}
+	        : sprite::sprite_sheet_array{std::move(files.sheets),
+	                                     files.textures};
+	m_timeline->end(step);
+	return sheets;
+}
+
+auto startup_loader::level() -> level_grid
+{
+	if (m_cooked_level)
+	{
+		return *m_cooked_level;
+	}
+
+	m_parsed_level = wait(m_level, "wait for level");
+	return m_parsed_level.grid();
+}
+} // namespace yaboc::assets
@@ -0,0 +1,146 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#include "yaboc/core/thread_pool.h"
+
+#include <utility>
+
+namespace yaboc::core
+{
+namespace
+{
+struct worker_identity final
+{
+	thread_pool const* pool{};
+	std::size_t        index{};
+};
+
+thread_local worker_identity current_worker{};
+} // namespace
+
+thread_pool::~thread_pool()
+{
+	for (auto& worker: m_workers)
+	{
+		worker.request_stop();
+	}
+	m_wake.notify_all();
+}
+
+thread_pool::thread_pool(std::size_t thread_count)
+    : m_queues(thread_count + 1)
+{
+	m_workers.reserve(thread_count);
+	for (std::size_t i{}; i < thread_count; ++i)
+	{
+		m_workers.emplace_back(
+		    [this, i](std::stop_token const& stop) { run(i, stop); });
+	}
+}
+
+void thread_pool::submit(std::function<void()> task)
+{
+	{
+		// Counted first, so that a worker never sleeps on a queued task.
+		std::scoped_lock lock{m_mutex};
+		++m_queued;
+	}
+	{
+		auto& queue = m_queues[worker_index()];
+		std::scoped_lock lock{queue.mutex};
+		queue.tasks.push_back(std::move(task));
+	}
+	m_wake.notify_one();
+}
+
+auto thread_pool::run_pending_task() -> bool
+{
+	auto task = take(worker_index());
+	if (!task)
+	{
+		return false;
+	}
+
+	task();
+	return true;
+}
+
+void thread_pool::wait(std::latch& done)
+{
+	while (!done.try_wait())
+	{
+		// With every queue empty, whatever done waits for is already running.
+		if (!run_pending_task())
+		{
+			done.wait();
+			return;
+		}
+	}
+}
+
+auto thread_pool::worker_index() const -> std::size_t
+{
+	return current_worker.pool == this ? current_worker.index : size();
+}
+
+auto thread_pool::take(std::size_t index) -> std::function<void()>
+{
+	auto const queue_count = std::size(m_queues);
+	for (std::size_t i{}; i < queue_count; ++i)
+	{
+		auto& queue = m_queues[(index + i) % queue_count];
+		std::scoped_lock lock{queue.mutex};
+		if (queue.tasks.empty())
+		{
+			continue;
+		}
+
+		std::function<void()> task{};
+		if (i == 0 && index < size())
+		{
+			task = std::move(queue.tasks.back());
+			queue.tasks.pop_back();
+		}
+		else
+		{
+			task = std::move(queue.tasks.front());
+			queue.tasks.pop_front();
+		}
+		--m_queued;
+		return task;
+	}
+	return {};
+}
+
+void thread_pool::run(std::size_t index, std::stop_token const& stop)
+{
+	current_worker = {.pool = this, .index = index};
+
+	while (true)
+	{
+		if (auto task = take(index))
+		{
+			task();
+			continue;
+		}
+
+		std::unique_lock lock{m_mutex};
+		if (!m_wake.wait(lock, stop, [this] { return m_queued != 0; }))
+		{
+			return;
+		}
+	}
+}
+} // namespace yaboc::core
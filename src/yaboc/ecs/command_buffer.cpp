@@ -0,0 +1,55 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#include "yaboc/ecs/command_buffer.h"
+
+#include <utility>
+
+namespace yaboc::ecs
+{
+void command_buffer::destroy(entt::entity entity)
+{
+	m_destroyed.push_back(entity);
+}
+
+void command_buffer::record(std::function<void(entt::registry&)> command)
+{
+	m_commands.push_back(std::move(command));
+}
+
+void command_buffer::apply(entt::registry& registry)
+{
+	for (auto& command: m_commands)
+	{
+		command(registry);
+	}
+
+	for (auto const entity: m_destroyed)
+	{
+		if (registry.valid(entity))
+		{
+			registry.destroy(entity);
+		}
+	}
+
+	clear();
+}
+
+void command_buffer::clear()
+{
+	m_destroyed.clear();
+	m_commands.clear();
+}
+} // namespace yaboc::ecs
@@ -0,0 +1,106 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#include "yaboc/ecs/render_snapshot.h"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+namespace yaboc::ecs
+{
+void render_list::resize(std::size_t count)
+{
+	entities.resize(count);
+	positions.resize(count);
+	sizes.resize(count);
+	frames.resize(count);
+	tints.resize(count);
+	orders.resize(count);
+}
+
+auto render_snapshot_exchange::acquire() -> render_snapshot&
+{
+	std::scoped_lock const lock{m_mutex};
+
+	if (m_free.empty())
+	{
+		m_snapshots.push_back(std::make_unique<render_snapshot>());
+		return *m_snapshots.back();
+	}
+
+	auto* snapshot = m_free.back();
+	m_free.pop_back();
+	return *snapshot;
+}
+
+void render_snapshot_exchange::publish(render_snapshot& snapshot)
+{
+	std::scoped_lock const lock{m_mutex};
+
+	m_brick_edits.insert(std::end(m_brick_edits),
+	                     std::begin(snapshot.brick_edits),
+	                     std::end(snapshot.brick_edits));
+	snapshot.brick_edits.clear();
+	m_update_time += snapshot.update_time;
+
+	auto const* retired = std::exchange(m_previous, m_latest);
+	m_latest = &snapshot;
+	recycle(retired);
+}
+
+auto render_snapshot_exchange::take(frame& latest_frame) -> bool
+{
+	std::scoped_lock const lock{m_mutex};
+
+	if (m_latest == nullptr)
+	{
+		return false;
+	}
+
+	auto const* previous = m_previous != nullptr ? m_previous : m_latest;
+	auto const* last_read_previous = std::exchange(m_read_previous, previous);
+	auto const* last_read_latest = std::exchange(m_read_latest, m_latest);
+	recycle(last_read_previous);
+	if (last_read_latest != last_read_previous)
+	{
+		recycle(last_read_latest);
+	}
+
+	latest_frame.previous = m_read_previous;
+	latest_frame.latest = m_read_latest;
+
+	latest_frame.brick_edits.clear();
+	std::swap(latest_frame.brick_edits, m_brick_edits);
+	latest_frame.update_time = std::exchange(m_update_time, {});
+
+	return true;
+}
+
+void render_snapshot_exchange::recycle(render_snapshot const* snapshot)
+{
+	if (snapshot == nullptr || snapshot == m_previous || snapshot == m_latest ||
+	    snapshot == m_read_previous || snapshot == m_read_latest)
+	{
+		return;
+	}
+
+	// Only ever called with snapshots from m_snapshots.
+	auto const owner = std::ranges::find_if(
+	    m_snapshots,
+	    [snapshot](auto const& owned) { return owned.get() == snapshot; });
+	m_free.push_back(owner->get());
+}
+} // namespace yaboc::ecs
@@ -0,0 +1,195 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#include "yaboc/ecs/scheduler.h"
+
+#include "yaboc/core/thread_pool.h"
+
+#include <utility>
+
+namespace yaboc::ecs
+{
+scheduler::scheduler(core::thread_pool* workers)
+    : m_workers{workers}
+    // One buffer per worker, and one for threads outside the pool.
+    , m_command_buffers(workers != nullptr ? workers->size() + 1 : 1)
+{}
+
+void scheduler::call(void const* payload, entt::registry& registry)
+{
+	auto const& system = *static_cast<registered_system const*>(payload);
+	system.update(registry, system.owner->commands());
+}
+
+void scheduler::build_graph()
+{
+	m_graph = m_organizer.graph();
+
+	m_dependency_counts.assign(std::size(m_graph), 0);
+	for (auto const& vertex: m_graph)
+	{
+		for (auto const child: vertex.children())
+		{
+			++m_dependency_counts[child];
+		}
+	}
+	m_waiting_for = std::vector<std::atomic<std::size_t>>(std::size(m_graph));
+
+	m_graph_changed = false;
+}
+
+auto scheduler::commands() -> command_buffer&
+{
+	auto const index = m_workers != nullptr ? m_workers->worker_index() : 0;
+	if (index + 1 < std::size(m_command_buffers) ||
+	    std::this_thread::get_id() == m_caller)
+	{
+		return m_command_buffers[index];
+	}
+
+	// Say the render thread, running a system while it waits for its own
+	// parallel_for. References to the buffers outlive rehashing.
+	std::scoped_lock lock{m_outside_mutex};
+	return m_outside_buffers[std::this_thread::get_id()];
+}
+
+void scheduler::run(entt::registry& registry)
+{
+	if (m_graph_changed)
+	{
+		build_graph();
+	}
+
+	for (auto const& system: m_systems)
+	{
+		system.prepare(registry);
+	}
+	m_caller = std::this_thread::get_id();
+
+	try
+	{
+		run_systems(registry);
+	}
+	catch (...)
+	{
+		for (auto& buffer: m_command_buffers)
+		{
+			buffer.clear();
+		}
+		for (auto& [thread, buffer]: m_outside_buffers)
+		{
+			buffer.clear();
+		}
+		throw;
+	}
+
+	for (auto& buffer: m_command_buffers)
+	{
+		buffer.apply(registry);
+	}
+	for (auto& [thread, buffer]: m_outside_buffers)
+	{
+		buffer.apply(registry);
+	}
+}
+
+void scheduler::run_systems(entt::registry& registry)
+{
+	if (m_workers == nullptr || m_workers->size() == 0)
+	{
+		// The organizer only ever makes a system depend on one added before
+		// it, so the order they were added in is a valid one.
+		for (auto const& vertex: m_graph)
+		{
+			vertex.callback()(vertex.data(), registry);
+		}
+		return;
+	}
+
+	for (std::size_t i{}; i < std::size(m_graph); ++i)
+	{
+		m_waiting_for[i].store(m_dependency_counts[i],
+		                       std::memory_order_relaxed);
+	}
+	m_failed.store(false, std::memory_order_relaxed);
+
+	std::latch done{static_cast<std::ptrdiff_t>(std::size(m_graph))};
+	for (std::size_t i{}; i < std::size(m_graph); ++i)
+	{
+		if (m_graph[i].top_level())
+		{
+			m_workers->submit(
+			    [this, &registry, &done, i] { run_from(i, registry, done); });
+		}
+	}
+	m_workers->wait(done);
+
+	if (m_error)
+	{
+		std::rethrow_exception(std::exchange(m_error, nullptr));
+	}
+}
+
+void scheduler::run_from(std::size_t     index,
+                         entt::registry& registry,
+                         std::latch&     done)
+{
+	while (index != no_system)
+	{
+		auto const& vertex = m_graph[index];
+		if (!m_failed.load(std::memory_order_relaxed))
+		{
+			try
+			{
+				vertex.callback()(vertex.data(), registry);
+			}
+			catch (...)
+			{
+				std::scoped_lock lock{m_error_mutex};
+				if (!m_error)
+				{
+					m_error = std::current_exception();
+				}
+				m_failed.store(true, std::memory_order_relaxed);
+			}
+		}
+
+		auto next = no_system;
+		for (auto const child: vertex.children())
+		{
+			auto const waiting =
+			    m_waiting_for[child].fetch_sub(1, std::memory_order_acq_rel);
+			if (waiting != 1)
+			{
+				continue;
+			}
+
+			if (next == no_system)
+			{
+				next = child;
+			}
+			else
+			{
+				m_workers->submit([this, &registry, &done, child] {
+					run_from(child, registry, done);
+				});
+			}
+		}
+
+		done.count_down();
+		index = next;
+	}
+}
+} // namespace yaboc::ecs
@@ -0,0 +1,276 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#include "yaboc/ecs/systems/collision_system.h"
+
+#include "yaboc/core/thread_pool.h"
+#include "yaboc/ecs/components/all.h"
+
+#include "entt/entt.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <optional>
+
+namespace yaboc::ecs::system
+{
+namespace
+{
+constexpr std::size_t parallel_ball_threshold{512};
+constexpr std::size_t ball_grain{128};
+
+// A ball wedged between things stops for the rest of the tick after this
+// many, rather than bouncing back and forth indefinitely.
+constexpr std::size_t max_impacts_per_tick{8};
+} // namespace
+
+collision_system::~collision_system()
+{
+	m_registry->on_construct<tags::brick>().disconnect(*this);
+	m_registry->on_destroy<tags::brick>().disconnect(*this);
+}
+
+collision_system::collision_system(entt::registry&    registry,
+                                   glm::vec2          brick_pitch,
+                                   glm::vec2          brick_size,
+                                   core::thread_pool* workers)
+    : m_registry{&registry}
+    , m_workers{workers}
+    , m_bricks{brick_pitch, brick_size}
+{
+	registry.on_construct<tags::brick>()
+	    .connect<&collision_system::on_brick_created>(*this);
+	registry.on_destroy<tags::brick>()
+	    .connect<&collision_system::on_brick_destroyed>(*this);
+
+	for (auto const brick:
+	     registry.view<components::transform, tags::brick>())
+	{
+		on_brick_created(registry, brick);
+	}
+}
+
+void collision_system::operator()(float dt, std::vector<contact>& contacts)
+{
+	m_balls.clear();
+	m_registry
+	    ->view<components::transform,
+	           components::sprite,
+	           components::direction,
+	           components::velocity,
+	           tags::ball>()
+	    .each([this](entt::entity entity,
+	                 auto const&  transform,
+	                 auto const&  sprite,
+	                 auto const   direction,
+	                 auto const   velocity) {
+		    m_balls.push_back(
+		        {.entity = entity,
+		         .position = transform.position,
+		         .size = sprite.size,
+		         .direction = {direction.horizontal, direction.vertical},
+		         .speed = {velocity.x, velocity.y}});
+	    });
+
+	m_paddles.clear();
+	m_paddle_boxes.clear();
+	m_registry
+	    ->view<components::transform, components::sprite, tags::player>()
+	    .each([this](entt::entity entity,
+	                 auto const&  transform,
+	                 auto const&  sprite) {
+		    m_paddles.push_back(entity);
+		    m_paddle_boxes.push_back(
+		        physics::make_aabb(transform.position, sprite.size));
+	    });
+
+	auto const* group = m_registry->ctx().find<components::brick_group>();
+	auto const  brick_offset = group != nullptr ? group->offset : glm::vec2{};
+
+	auto const ball_count = std::size(m_balls);
+	auto const parallel =
+	    m_workers != nullptr && ball_count >= parallel_ball_threshold;
+	auto const grain =
+	    parallel ? ball_grain : std::max(ball_count, std::size_t{1});
+
+	// One scratch per chunk, so the contacts can be joined in ball order.
+	m_scratch.resize((ball_count + grain - 1) / grain);
+	auto move_chunk = [this, dt, brick_offset, grain](std::size_t begin,
+	                                                  std::size_t end) {
+		auto& chunk = m_scratch[begin / grain];
+		chunk.contacts.clear();
+		for (auto index = begin; index < end; ++index)
+		{
+			move_ball(m_balls[index], dt, brick_offset, chunk);
+		}
+	};
+
+	if (parallel)
+	{
+		m_workers->parallel_for(ball_count, grain, move_chunk);
+	}
+	else if (ball_count != 0)
+	{
+		move_chunk(0, ball_count);
+	}
+
+	for (auto const& moved: m_balls)
+	{
+		m_registry->get<components::transform>(moved.entity).position =
+		    moved.position;
+		auto& direction = m_registry->get<components::direction>(moved.entity);
+		direction.horizontal = moved.direction.x;
+		direction.vertical = moved.direction.y;
+	}
+
+	contacts.clear();
+	for (auto const& chunk: m_scratch)
+	{
+		contacts.insert(std::end(contacts),
+		                std::begin(chunk.contacts),
+		                std::end(chunk.contacts));
+	}
+}
+
+void collision_system::move_ball(ball&     moving,
+                                 float     dt,
+                                 glm::vec2 brick_offset,
+                                 scratch&  chunk) const
+{
+	auto bounce = [&moving](glm::vec2 normal) {
+		if (normal.x != 0.0F)
+		{
+			moving.direction.x = std::copysign(moving.direction.x, normal.x);
+		}
+		if (normal.y != 0.0F)
+		{
+			moving.direction.y = std::copysign(moving.direction.y, normal.y);
+		}
+	};
+
+	chunk.broken.clear();
+
+	// The fraction of the tick still to go.
+	auto remaining = 1.0F;
+	for (std::size_t impacts{}; impacts < max_impacts_per_tick; ++impacts)
+	{
+		auto const box = physics::make_aabb(moving.position, moving.size);
+		auto const displacement =
+		    moving.direction * moving.speed * (dt * remaining);
+		auto const swept = physics::sweep(box, displacement);
+
+		chunk.candidates.clear();
+		chunk.boxes.clear();
+		m_bricks.gather(swept, brick_offset, chunk.candidates, chunk.boxes);
+		auto const brick_count = std::size(chunk.candidates);
+		for (std::size_t paddle{}; paddle < std::size(m_paddles); ++paddle)
+		{
+			chunk.candidates.push_back(m_paddles[paddle]);
+			chunk.boxes.push_back(m_paddle_boxes[paddle]);
+		}
+
+		chunk.hits.resize(chunk.boxes.size());
+		auto const hit_count =
+		    physics::find_overlaps(swept, chunk.boxes, chunk.hits);
+
+		std::optional<physics::impact> first{};
+		std::size_t                    first_index{};
+		bool                           pushed_out{};
+
+		for (std::size_t hit{}; hit < hit_count; ++hit)
+		{
+			auto const index = chunk.hits[hit];
+			auto const other = chunk.candidates[index];
+			if (std::ranges::find(chunk.broken, other) !=
+			    std::end(chunk.broken))
+			{
+				continue;
+			}
+
+			auto const obstacle = chunk.boxes[index];
+			if (physics::overlaps(box, obstacle))
+			{
+				// Only a hit if the ball was on its way in.
+				auto const [normal, depth] =
+				    physics::find_penetration(box, obstacle);
+				moving.position += normal * depth;
+				if (glm::dot(moving.direction, normal) < 0.0F)
+				{
+					bounce(normal);
+					chunk.contacts.push_back({.ball = moving.entity,
+					                          .other = other,
+					                          .normal = normal,
+					                          .time = 1.0F - remaining});
+					if (index < brick_count)
+					{
+						chunk.broken.push_back(other);
+					}
+				}
+				pushed_out = true;
+				break;
+			}
+
+			auto const impact =
+			    physics::find_impact(box, displacement, obstacle);
+			if (impact && (!first || impact->time < first->time))
+			{
+				first = impact;
+				first_index = index;
+			}
+		}
+
+		if (pushed_out)
+		{
+			continue;
+		}
+
+		if (!first)
+		{
+			moving.position += displacement;
+			return;
+		}
+
+		moving.position += displacement * first->time;
+		bounce(first->normal);
+
+		auto const other = chunk.candidates[first_index];
+		chunk.contacts.push_back(
+		    {.ball = moving.entity,
+		     .other = other,
+		     .normal = first->normal,
+		     .time = 1.0F - remaining * (1.0F - first->time)});
+		if (first_index < brick_count)
+		{
+			chunk.broken.push_back(other);
+		}
+
+		remaining *= 1.0F - first->time;
+	}
+}
+
+void collision_system::on_brick_created(entt::registry& registry,
+                                        entt::entity    brick)
+{
+	m_bricks.insert(brick,
+	                registry.get<components::transform>(brick).position);
+}
+
+void collision_system::on_brick_destroyed(entt::registry& /*registry*/,
+                                          entt::entity brick)
+{
+	m_bricks.erase(brick);
+}
+} // namespace yaboc::ecs::system
@@ -0,0 +1,192 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#include "yaboc/ecs/systems/render_snapshot_system.h"
+
+#include "yaboc/core/thread_pool.h"
+#include "yaboc/ecs/components/all.h"
+
+#include "entt/entt.hpp"
+
+#include <cstddef>
+
+namespace yaboc::ecs::system
+{
+namespace
+{
+constexpr std::size_t parallel_extraction_threshold{4'096};
+constexpr std::size_t extraction_grain{1'024};
+
+// Owns the transforms and sprites, so that those of its entities are packed
+// at the front of their pools in the group's order and extraction reads them
+// front to back.
+auto sprite_group(entt::registry& registry)
+{
+	return registry.group<components::transform, components::sprite>(
+	    entt::get<components::render_order>,
+	    entt::exclude<tags::brick>);
+}
+} // namespace
+
+render_snapshot_system::~render_snapshot_system()
+{
+	m_registry->on_construct<tags::brick>().disconnect(*this);
+	m_registry->on_destroy<tags::brick>().disconnect(*this);
+	m_registry->on_update<components::sprite>().disconnect(*this);
+}
+
+render_snapshot_system::render_snapshot_system(entt::registry&    registry,
+                                               core::thread_pool* workers)
+    : m_registry{&registry}
+    , m_workers{workers}
+{
+	// Made up front so that the pools are sorted as entities arrive, rather
+	// than all at once on the first snapshot.
+	static_cast<void>(sprite_group(registry));
+
+	registry.on_construct<tags::brick>()
+	    .connect<&render_snapshot_system::on_brick_created>(*this);
+	registry.on_destroy<tags::brick>()
+	    .connect<&render_snapshot_system::on_brick_destroyed>(*this);
+	registry.on_update<components::sprite>()
+	    .connect<&render_snapshot_system::on_sprite_updated>(*this);
+}
+
+void render_snapshot_system::operator()(render_snapshot& snapshot)
+{
+	if (m_rewrite_bricks)
+	{
+		write_bricks();
+	}
+
+	extract_sprites(snapshot.sprites);
+
+	snapshot.brick_edits.clear();
+	std::swap(snapshot.brick_edits, m_brick_edits);
+}
+
+void render_snapshot_system::extract_sprites(render_list& sprites) const
+{
+	auto const group = sprite_group(*m_registry);
+	sprites.resize(group.size());
+
+	auto write = [&sprites](std::size_t                  index,
+	                        entt::entity                 entity,
+	                        components::transform const& transform,
+	                        components::sprite const&    sprite,
+	                        components::render_order     order) {
+		sprites.entities[index] = entity;
+		sprites.positions[index] = transform.position;
+		sprites.sizes[index] = sprite.size;
+		sprites.frames[index] = sprite.frame;
+		sprites.tints[index] = sprite.tint;
+		sprites.orders[index] = order;
+	};
+
+	if (m_workers == nullptr || group.size() < parallel_extraction_threshold)
+	{
+		group.each([&write, index = std::size_t{}](entt::entity entity,
+		                                           auto const&  transform,
+		                                           auto const&  sprite,
+		                                           auto const   order) mutable {
+			write(index++, entity, transform, sprite, order);
+		});
+		return;
+	}
+
+	// A chunk reads the group's entities, and so its packed components, from
+	// its first index on.
+	auto const first = group.begin();
+	m_workers->parallel_for(
+	    std::size(sprites),
+	    extraction_grain,
+	    [&group, &write, first](std::size_t begin, std::size_t end) {
+		    for (auto index = begin; index < end; ++index)
+		    {
+			    auto const entity =
+			        *(first + static_cast<std::ptrdiff_t>(index));
+			    auto const [transform, sprite, order] =
+			        group.get<components::transform,
+			                  components::sprite,
+			                  components::render_order>(entity);
+			    write(index, entity, transform, sprite, order);
+		    }
+	    });
+}
+
+// Runs once, after the first level has been loaded. Brick positions are
+// relative to the group, whose offset is only known once the whole level is
+// in the registry.
+void render_snapshot_system::write_bricks()
+{
+	m_brick_edits.clear();
+	m_brick_edits.push_back({.type = brick_edit::kind::clear});
+
+	for (auto const brick:
+	     m_registry->view<components::transform,
+	                      components::sprite,
+	                      tags::brick>())
+	{
+		write_brick(brick);
+	}
+
+	m_rewrite_bricks = false;
+}
+
+void render_snapshot_system::write_brick(entt::entity brick)
+{
+	auto const offset = m_registry->ctx().get<components::brick_group>().offset;
+	auto const [transform, sprite] =
+	    m_registry->get<components::transform, components::sprite>(brick);
+
+	m_brick_edits.push_back({.type = brick_edit::kind::write,
+	                         .brick = brick,
+	                         .position = transform.position + offset,
+	                         .sprite = sprite});
+}
+
+void render_snapshot_system::on_brick_created(entt::registry& /*registry*/,
+                                              entt::entity brick)
+{
+	if (m_rewrite_bricks)
+	{
+		return;
+	}
+
+	write_brick(brick);
+}
+
+void render_snapshot_system::on_brick_destroyed(entt::registry& /*registry*/,
+                                                entt::entity brick)
+{
+	if (m_rewrite_bricks)
+	{
+		return;
+	}
+
+	m_brick_edits.push_back({.type = brick_edit::kind::remove, .brick = brick});
+}
+
+void render_snapshot_system::on_sprite_updated(entt::registry& registry,
+                                               entt::entity    entity)
+{
+	if (m_rewrite_bricks || !registry.all_of<tags::brick>(entity))
+	{
+		return;
+	}
+
+	write_brick(entity);
+}
+} // namespace yaboc::ecs::system
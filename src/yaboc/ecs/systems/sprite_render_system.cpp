@@ -20,78 +20,138 @@
 
 #include "entt/entt.hpp"
 
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <utility>
+
 namespace yaboc::ecs::system
 {
+namespace
+{
+constexpr auto no_slot = std::numeric_limits<std::uint32_t>::max();
+} // namespace
+
 sprite_render_system::sprite_render_system(
     std::unique_ptr<sprite::sprite_renderer>&& renderer,
-    sprite::sprite_sheet*                      sheet)
+    sprite::sprite_sheet_array const*          sheets,
+    core::thread_pool&                         workers)
     : m_renderer{std::move(renderer)}
-    , m_sprite_sheet{sheet}
+    , m_sprite_sheets{sheets}
+    , m_sheets_key{m_render_queue.register_sheets(*m_sprite_sheets)}
+    , m_static_bricks{m_renderer->make_static_batch()}
+    , m_workers{&workers}
 {}
 
-void sprite_render_system::operator()(entt::registry& registry) const
+void sprite_render_system::apply(std::span<brick_edit const> edits)
 {
-	m_renderer->use_sprite_sheet(*m_sprite_sheet);
+	for (auto const& edit: edits)
+	{
+		switch (edit.type)
+		{
+		case brick_edit::kind::clear: clear_bricks(); break;
+		case brick_edit::kind::write: write_brick(edit); break;
+		case brick_edit::kind::remove: remove_brick(edit.brick); break;
+		}
+	}
+}
 
-	m_renderer->begin_batch();
+void sprite_render_system::operator()(render_snapshot const& previous,
+                                      render_snapshot const& current,
+                                      float                  alpha)
+{
+	auto const& previous_sprites = previous.sprites;
+	auto const& sprites = current.sprites;
+	for (std::size_t index{}; index < std::size(sprites); ++index)
+	{
+		// Entities that just appeared, or moved in the group because others
+		// went, are drawn where they are now.
+		auto position = sprites.positions[index];
+		if (index < std::size(previous_sprites) &&
+		    previous_sprites.entities[index] == sprites.entities[index])
+		{
+			position =
+			    glm::mix(previous_sprites.positions[index], position, alpha);
+		}
+
+		auto const order = sprites.orders[index];
+		m_render_queue.submit({.layer = order.layer,
+		                       .sheet = m_sheets_key,
+		                       .blend = order.blend,
+		                       .depth = order.depth},
+		                      position,
+		                      sprites.sizes[index],
+		                      sprites.tints[index],
+		                      subtexture(sprites.frames[index]));
+	}
 
-	auto scale_uv = [sheet_size = m_sprite_sheet->meta_data().dimensions](
-	                    sprite::sprite_frame_data::subtexture_bounds bounds) {
-		float sheet_width{static_cast<float>(sheet_size.x)};
-		float sheet_height{static_cast<float>(sheet_size.y)};
+	m_renderer->begin_batch();
 
-		auto min = glm::vec2{static_cast<float>(bounds.min.x) / sheet_width,
-		                     static_cast<float>(bounds.min.y) / sheet_height};
+	// The playfield sits beneath every queued layer.
+	m_renderer->use_sprite_sheets(*m_sprite_sheets);
+	m_renderer->use_blend_mode(sprite::blend_mode::alpha);
+	m_renderer->draw_static(m_static_bricks);
 
-		auto max = glm::vec2{static_cast<float>(bounds.max.x) / sheet_width,
-		                     static_cast<float>(bounds.max.y) / sheet_height};
+	m_render_queue.emit(*m_renderer, m_workers);
+	m_renderer->end_batch();
+}
 
-		return sprite::sprite_renderer::subtexture_bounds{min, max};
-	};
+auto sprite_render_system::subtexture(components::sprite_frame frame) const
+    -> sprite::sprite_renderer::subtexture_bounds
+{
+	auto const& sheet = m_sprite_sheets->sheet(frame.sheet);
+	auto const& uv = sheet.uv(frame.id);
+	return {uv.min, uv.max, sheet.layer()};
+}
 
-	auto render_components = [&registry](entt::entity entity) {
-		return registry.get<components::transform, components::sprite>(entity);
-	};
+void sprite_render_system::clear_bricks()
+{
+	m_static_bricks.clear();
+	m_slot_bricks.clear();
+	std::ranges::fill(m_brick_slots, no_slot);
+}
 
-	for (auto entity: registry.view<tags::brick>())
+void sprite_render_system::write_brick(brick_edit const& edit)
+{
+	auto const index = entt::to_entity(edit.brick);
+	if (index >= std::size(m_brick_slots))
 	{
-		auto [transform, sprite] = render_components(entity);
-
-		auto offset = registry.ctx().get<components::brick_group>().offset;
-		auto position = transform.position + offset;
-
-		auto frame = m_sprite_sheet->frame_data(sprite.id);
-
-		m_renderer->submit_sprite(position,
-		                          sprite.size,
-		                          sprite.tint,
-		                          scale_uv(frame.bounds));
+		m_brick_slots.resize(index + 1, no_slot);
 	}
 
-	for (auto entity: registry.view<tags::player>())
+	if (m_brick_slots[index] == no_slot)
 	{
-		auto [transform, sprite] = render_components(entity);
-
-		auto frame = m_sprite_sheet->frame_data(sprite.id);
-
-		m_renderer->submit_sprite(transform.position,
-		                          sprite.size,
-		                          sprite.tint,
-		                          scale_uv(frame.bounds));
+		m_brick_slots[index] =
+		    static_cast<std::uint32_t>(m_static_bricks.append());
+		m_slot_bricks.push_back(edit.brick);
 	}
 
-	for (auto entity: registry.view<tags::ball>())
+	m_renderer->write_static_sprite(m_static_bricks,
+	                                m_brick_slots[index],
+	                                edit.position,
+	                                edit.sprite.size,
+	                                edit.sprite.tint,
+	                                subtexture(edit.sprite.frame));
+}
+
+void sprite_render_system::remove_brick(entt::entity brick)
+{
+	auto const index = entt::to_entity(brick);
+	if (index >= std::size(m_brick_slots) || m_brick_slots[index] == no_slot)
 	{
-		auto [transform, sprite] = render_components(entity);
+		return;
+	}
 
-		auto frame = m_sprite_sheet->frame_data(sprite.id);
+	auto const slot = std::exchange(m_brick_slots[index], no_slot);
+	auto const moved_from = m_static_bricks.remove(slot);
+	assert(moved_from == std::size(m_slot_bricks) - 1);
 
-		m_renderer->submit_sprite(transform.position,
-		                          sprite.size,
-		                          sprite.tint,
-		                          scale_uv(frame.bounds));
+	if (moved_from != slot)
+	{
+		auto const moved = m_slot_bricks[moved_from];
+		m_slot_bricks[slot] = moved;
+		m_brick_slots[entt::to_entity(moved)] = slot;
 	}
-
-	m_renderer->end_batch();
+	m_slot_bricks.pop_back();
 }
 } // namespace yaboc::ecs::system
@@ -0,0 +1,168 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#include "yaboc/game/presentation.h"
+
+#include "yaboc/assets/loading_service.h"
+#include "yaboc/sprite/sprite_renderer.h"
+
+#include "glad/gl.h"
+#include "glm/glm.hpp"
+#include "glm/gtc/type_ptr.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+namespace yaboc::game
+{
+namespace
+{
+constexpr glm::vec4 clear_colour{0.157F, 0.157F, 0.157F, 1.0F};
+
+// How many texture bytes a frame may upload, so that reloading sprite sheets
+// never drops a frame.
+constexpr std::size_t texture_stream_bytes_per_frame{256 * 1024};
+constexpr std::size_t texture_stream_frames_in_flight{3};
+} // namespace
+
+presentation::presentation(sprite::sprite_sheet_array&& sprite_sheets,
+                           core::thread_pool&           workers,
+                           bool                         show_hud)
+    : m_sprite_sheets{std::move(sprite_sheets)}
+    , m_render_system{std::make_unique<sprite::sprite_renderer>(
+                          sprite::sprite_renderer::configuration{}),
+                      &m_sprite_sheets,
+                      workers}
+    , m_texture_streamer{texture_stream_bytes_per_frame,
+                         texture_stream_frames_in_flight}
+{
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	if (show_hud)
+	{
+		toggle_hud();
+	}
+}
+
+void presentation::prepare_shaders()
+{
+	sprite::sprite_renderer::prepare_shaders(
+	    sprite::sprite_renderer::configuration{});
+}
+
+auto presentation::sprite_sheet_paths() const -> std::vector<std::string>
+{
+	std::vector<std::string> paths{};
+	for (std::size_t layer{}; layer < m_sprite_sheets.size(); ++layer)
+	{
+		paths.push_back(m_sprite_sheets.sheet(layer).meta_data().name);
+	}
+	return paths;
+}
+
+void presentation::reload_sprite_sheets(
+    std::future<std::vector<graphics::image>> images)
+{
+	m_reloaded_images = std::move(images);
+}
+
+void presentation::toggle_hud()
+{
+	if (m_hud)
+	{
+		m_hud.reset();
+		return;
+	}
+	m_hud.emplace(m_sprite_sheets);
+}
+
+void presentation::render(ecs::render_snapshot_exchange::frame const& frame,
+                          float                                       alpha)
+{
+	m_profiler.record(profiling::cpu_section::update, frame.update_time);
+
+	m_profiler.begin(profiling::cpu_section::render_submit);
+
+	stream_sprite_sheets();
+	m_render_system.apply(frame.brick_edits);
+
+	m_profiler.begin(profiling::gpu_pass::clear);
+	glClearBufferfv(GL_COLOR, 0, glm::value_ptr(clear_colour));
+	m_profiler.end(profiling::gpu_pass::clear);
+
+	m_profiler.begin(profiling::gpu_pass::sprites);
+	m_render_system(*frame.previous, *frame.latest, alpha);
+	m_profiler.end(profiling::gpu_pass::sprites);
+
+	if (m_hud)
+	{
+		m_profiler.begin(profiling::gpu_pass::hud);
+		m_hud->draw(m_profiler.average(profile_average_frames));
+		m_profiler.end(profiling::gpu_pass::hud);
+	}
+
+	m_profiler.end(profiling::cpu_section::render_submit);
+}
+
+void presentation::stream_sprite_sheets()
+{
+	if (assets::is_ready(m_reloaded_images))
+	{
+		try
+		{
+			enqueue_sprite_sheets(m_reloaded_images.get());
+		}
+		catch (std::exception const& error)
+		{
+			std::cerr << "failed to reload sprite sheets: " << error.what()
+			          << '\n';
+		}
+	}
+
+	m_texture_streamer.pump();
+}
+
+void presentation::enqueue_sprite_sheets(std::vector<graphics::image>&& images)
+{
+	auto const dimensions = m_sprite_sheets.dimensions();
+	if (!std::ranges::all_of(images, [dimensions](auto const& picture) {
+		    return glm::ivec2{picture.width, picture.height} == dimensions;
+	    }))
+	{
+		throw std::runtime_error{"sprite sheets changed size"};
+	}
+
+	auto const texture = m_sprite_sheets.renderer_id();
+	for (std::size_t layer{}; layer < std::size(images); ++layer)
+	{
+		graphics::texture_upload upload{
+		    .texture = texture,
+		    .layer = static_cast<int>(layer),
+		    .picture = std::move(images[layer])};
+		if (layer + 1 == std::size(images))
+		{
+			upload.on_complete = [texture] {
+				glGenerateTextureMipmap(texture);
+			};
+		}
+		m_texture_streamer.enqueue(std::move(upload));
+	}
+}
+} // namespace yaboc::game
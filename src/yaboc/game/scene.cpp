@@ -0,0 +1,193 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#include "yaboc/game/scene.h"
+
+#include "entt/entt.hpp"
+
+#include <utility>
+
+namespace yaboc::game
+{
+namespace
+{
+// Ensures the bricks are centered along the X-axis.
+auto brick_group_offset(assets::level_grid const& level) -> glm::vec2
+{
+	// TODO(Dave): A better level/scene file will be able to parent things
+	// properly. NOLINTBEGIN(*-magic-numbers)
+	auto brick_row_midpoint = static_cast<float>(level.columns) / 2.0F;
+	return {(brick_gap / 2.0F + 5.0F -
+	         (brick_row_midpoint * (brick_size.x) +
+	          brick_row_midpoint * brick_gap)) +
+	            brick_size.x / 2.0F,
+	        0.25F + brick_size.y / 2.0F};
+	// NOLINTEND(*-magic-numbers)
+}
+
+void create_brick(entt::registry&               registry,
+                  int                           x,
+                  int                           y,
+                  ecs::components::sprite_frame frame)
+{
+	entt::entity const brick = registry.create();
+
+	using transform_component = ecs::components::transform;
+	using sprite_component = ecs::components::sprite;
+
+	registry.emplace<transform_component>(
+	    brick,
+	    glm::vec2{(static_cast<float>(x) * brick_gap) +
+	                  (static_cast<float>(x) * brick_size.x),
+	              static_cast<float>(y) * brick_gap +
+	                  (static_cast<float>(y) * brick_size.y)});
+	registry.emplace<sprite_component>(brick,
+	                                   frame,
+	                                   brick_size,
+	                                   glm::vec4{1.0F});
+
+	registry.emplace<ecs::components::render_order>(brick,
+	                                                render_layer::playfield,
+	                                                sprite::blend_mode::alpha,
+	                                                0U);
+
+	// Last, see render_snapshot_system.
+	registry.emplace<ecs::tags::brick>(brick);
+}
+} // namespace
+
+auto sprite_frame(sprite::sprite_sheet const&     sheet,
+                  sprite::sprite_sheet_frames::id id)
+    -> ecs::components::sprite_frame
+{
+	return {.id = std::to_underlying(id),
+	        .sheet = static_cast<std::uint16_t>(sheet.layer())};
+}
+
+void load_level(entt::registry&               registry,
+                assets::level_grid const&     level,
+                ecs::components::sprite_frame frame)
+{
+	registry.ctx().insert_or_assign(
+	    ecs::components::brick_group{brick_group_offset(level)});
+
+	for (int y{}; y < level.rows; ++y)
+	{
+		for (int x{}; x < level.columns; ++x)
+		{
+			if (level.at(x, y) != 0)
+			{
+				create_brick(registry, x, y, frame);
+			}
+		}
+	}
+}
+
+auto create_scene(entt::registry&             registry,
+                  sprite::sprite_sheet const& sprite_sheet,
+                  assets::level_grid const&   level) -> entt::entity
+{
+	using frame = sprite::sprite_sheet_frames::id;
+
+	// TODO(Dave): A better level/scene file will be able to specify properties
+	// properly. NOLINTBEGIN(*-magic-numbers)
+	auto paddle = registry.create();
+	registry.emplace<ecs::components::transform>(paddle,
+	                                             glm::vec2{5.0F, 5.25F});
+	registry.emplace<ecs::components::sprite>(
+	    paddle,
+	    sprite_frame(sprite_sheet, frame::entity_paddle_red),
+	    glm::vec2{1.0F, 0.25F},
+	    glm::vec4{1.0F});
+	registry.emplace<ecs::components::velocity>(paddle, 10.0F, 0.0F);
+	registry.emplace<ecs::components::direction>(paddle);
+	registry.emplace<ecs::components::render_order>(paddle,
+	                                                render_layer::paddle,
+	                                                sprite::blend_mode::alpha,
+	                                                0U);
+	registry.emplace<ecs::tags::player>(paddle);
+
+	auto ball = registry.create();
+	registry.emplace<ecs::components::transform>(ball, glm::vec2{5.0F, 5.0F});
+	registry.emplace<ecs::components::sprite>(
+	    ball,
+	    sprite_frame(sprite_sheet, frame::entity_ball_grey),
+	    glm::vec2{0.25F, 0.25F},
+	    glm::vec4{1.0F});
+	registry.emplace<ecs::components::velocity>(ball, 3.0F, 3.0F);
+	registry.emplace<ecs::components::direction>(ball, -1.0F, -1.0F);
+	registry.emplace<ecs::components::render_order>(ball,
+	                                                render_layer::ball,
+	                                                sprite::blend_mode::alpha,
+	                                                0U);
+	registry.emplace<ecs::tags::ball>(ball);
+	// NOLINTEND(*-magic-numbers)
+
+	load_level(
+	    registry,
+	    level,
+	    sprite_frame(sprite_sheet, frame::entity_element_grey_rectangle));
+
+	return paddle;
+}
+
+staged_level::staged_level(assets::level_data&&          level,
+                           ecs::components::sprite_frame frame)
+    : m_level{std::move(level)}
+    , m_frame{frame}
+{}
+
+auto staged_level::commit(entt::registry& registry, clock::time_point deadline)
+    -> bool
+{
+	auto const old_bricks = registry.view<ecs::tags::brick>();
+	while (!m_group_moved && !old_bricks.empty())
+	{
+		registry.destroy(old_bricks.front());
+		if (clock::now() >= deadline)
+		{
+			return false;
+		}
+	}
+
+	auto const grid = m_level.grid();
+	if (!m_group_moved)
+	{
+		registry.ctx().insert_or_assign(
+		    ecs::components::brick_group{brick_group_offset(grid)});
+		m_group_moved = true;
+	}
+
+	for (; m_next_cell < std::size(grid.cells); ++m_next_cell)
+	{
+		if (clock::now() >= deadline)
+		{
+			return false;
+		}
+
+		if (grid.cells[m_next_cell] == 0)
+		{
+			continue;
+		}
+
+		auto const columns = static_cast<std::size_t>(grid.columns);
+		create_brick(registry,
+		             static_cast<int>(m_next_cell % columns),
+		             static_cast<int>(m_next_cell / columns),
+		             m_frame);
+	}
+	return true;
+}
+} // namespace yaboc::game
@@ -0,0 +1,218 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#include "yaboc/game/simulation.h"
+
+#include "yaboc/assets/loading_service.h"
+
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <utility>
+
+namespace yaboc::game
+{
+namespace
+{
+// How much of a tick may go to swapping levels, so that changing levels
+// never drops a frame.
+constexpr std::chrono::microseconds level_change_budget{1'000};
+
+class move_entity_system final
+{
+	entt::registry* m_registry{};
+
+public:
+	explicit move_entity_system(entt::registry& registry)
+	    : m_registry{&registry}
+	{}
+
+	void operator()(entt::entity                     entity,
+	                ecs::components::velocity const  velocity,
+	                ecs::components::direction const direction)
+	{
+		auto& transform = m_registry->get<ecs::components::transform>(entity);
+		transform.position.x +=
+		    direction.horizontal * velocity.x * dt_f.count();
+		transform.position.y += direction.vertical * velocity.y * dt_f.count();
+	}
+};
+} // namespace
+
+simulation::simulation(sprite::sprite_sheet const& sprite_sheet,
+                       assets::level_grid const&   level,
+                       core::thread_pool&          workers)
+    : m_workers{&workers}
+    , m_paddle{create_scene(m_registry, sprite_sheet, level)}
+    , m_brick_frame{sprite_frame(
+          sprite_sheet,
+          sprite::sprite_sheet_frames::id::entity_element_grey_rectangle)}
+{
+	add_systems();
+}
+
+void simulation::load_level(std::future<assets::level_data>&& level)
+{
+	m_next_level = std::move(level);
+}
+
+void simulation::steer_paddle(float horizontal)
+{
+	m_registry.get<ecs::components::direction>(m_paddle).horizontal =
+	    horizontal;
+}
+
+void simulation::capture(ecs::render_snapshot& snapshot)
+{
+	auto const start = clock::now();
+	m_snapshot_system(snapshot);
+
+	snapshot.tick = m_tick;
+	snapshot.taken_at = clock::now();
+	snapshot.update_time = snapshot.taken_at - start;
+}
+
+void simulation::tick(ecs::render_snapshot& snapshot)
+{
+	auto const start = clock::now();
+	advance_level_change(start + level_change_budget);
+	m_scheduler.run(m_registry);
+	++m_tick;
+	capture(snapshot);
+	snapshot.update_time = snapshot.taken_at - start;
+}
+
+void simulation::advance_level_change(clock::time_point deadline)
+{
+	if (assets::is_ready(m_next_level))
+	{
+		try
+		{
+			m_staged_level.emplace(m_next_level.get(), m_brick_frame);
+		}
+		catch (std::exception const& error)
+		{
+			std::cerr << "failed to load level: " << error.what() << '\n';
+		}
+	}
+
+	if (m_staged_level && m_staged_level->commit(m_registry, deadline))
+	{
+		m_staged_level.reset();
+	}
+}
+
+void simulation::bounce(entt::entity ball, glm::vec2 normal, float depth)
+{
+	m_registry.get<ecs::components::transform>(ball).position += normal * depth;
+
+	auto& direction = m_registry.get<ecs::components::direction>(ball);
+	if (normal.x != 0.0F)
+	{
+		direction.horizontal = std::copysign(direction.horizontal, normal.x);
+	}
+	if (normal.y != 0.0F)
+	{
+		direction.vertical = std::copysign(direction.vertical, normal.y);
+	}
+}
+
+void simulation::move_balls(ecs::command_buffer& commands)
+{
+	m_collision_system(dt_f.count(), m_contacts);
+	for (auto const& contact: m_contacts)
+	{
+		// Two balls may hit the same brick in one tick, which the buffer
+		// takes care of.
+		if (m_registry.all_of<ecs::tags::brick>(contact.other))
+		{
+			commands.destroy(contact.other);
+		}
+	}
+
+	m_registry.view<ecs::tags::ball>().each([this](entt::entity ball) {
+		auto const position =
+		    m_registry.get<ecs::components::transform>(ball).position;
+		auto const half_size =
+		    m_registry.get<ecs::components::sprite>(ball).size / 2.0F;
+
+		auto const past_min = half_size - position;
+		auto const past_max = position + half_size - playfield_size;
+		if (past_min.x > 0.0F)
+		{
+			bounce(ball, {1.0F, 0.0F}, past_min.x);
+		}
+		if (past_max.x > 0.0F)
+		{
+			bounce(ball, {-1.0F, 0.0F}, past_max.x);
+		}
+		if (past_min.y > 0.0F)
+		{
+			bounce(ball, {0.0F, 1.0F}, past_min.y);
+		}
+		if (past_max.y > 0.0F)
+		{
+			bounce(ball, {0.0F, -1.0F}, past_max.y);
+		}
+	});
+}
+
+void simulation::add_systems()
+{
+	namespace components = ecs::components;
+	namespace tags = ecs::tags;
+
+	// Balls are swept by the collision system instead.
+	m_scheduler.add<components::transform,
+	                components::velocity const,
+	                components::direction const,
+	                tags::ball const>(
+	    "move", [](entt::registry& registry, ecs::command_buffer&) {
+		    registry
+		        .view<components::velocity, components::direction>(
+		            entt::exclude<tags::ball>)
+		        .each(move_entity_system{registry});
+	    });
+
+	m_scheduler.add<components::transform,
+	                components::sprite const,
+	                tags::player const>(
+	    "keep paddles in",
+	    [](entt::registry& registry, ecs::command_buffer&) {
+		    registry
+		        .view<components::transform, components::sprite, tags::player>()
+		        .each([](auto& transform, auto const& sprite) {
+			        auto const half_size = sprite.size / 2.0F;
+			        transform.position.x =
+			            std::clamp(transform.position.x,
+			                       half_size.x,
+			                       playfield_size.x - half_size.x);
+		        });
+	    });
+
+	m_scheduler.add<components::transform,
+	                components::direction,
+	                components::sprite const,
+	                components::velocity const,
+	                tags::ball const,
+	                tags::brick const,
+	                tags::player const>(
+	    "move balls",
+	    [this](entt::registry&, ecs::command_buffer& commands) {
+		    move_balls(commands);
+	    });
+}
+} // namespace yaboc::game
@@ -0,0 +1,112 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#include "yaboc/graphics/framebuffer.h"
+
+#include "glad/gl.h"
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <utility>
+
+namespace yaboc::graphics
+{
+framebuffer::~framebuffer()
+{
+	glDeleteFramebuffers(1, &m_framebuffer);
+	glDeleteRenderbuffers(1, &m_colour);
+}
+
+framebuffer::framebuffer(int width, int height)
+    : m_width{width}
+    , m_height{height}
+{
+	glCreateRenderbuffers(1, &m_colour);
+	glNamedRenderbufferStorage(m_colour, GL_RGBA8, width, height);
+
+	glCreateFramebuffers(1, &m_framebuffer);
+	glNamedFramebufferRenderbuffer(m_framebuffer,
+	                               GL_COLOR_ATTACHMENT0,
+	                               GL_RENDERBUFFER,
+	                               m_colour);
+
+	assert(glCheckNamedFramebufferStatus(m_framebuffer, GL_FRAMEBUFFER) ==
+	       GL_FRAMEBUFFER_COMPLETE);
+}
+
+framebuffer::framebuffer(framebuffer&& other) noexcept
+    : m_framebuffer{std::exchange(other.m_framebuffer, 0)}
+    , m_colour{std::exchange(other.m_colour, 0)}
+    , m_width{std::exchange(other.m_width, 0)}
+    , m_height{std::exchange(other.m_height, 0)}
+{}
+
+auto framebuffer::operator=(framebuffer&& other) noexcept -> framebuffer&
+{
+	if (this != &other)
+	{
+		glDeleteFramebuffers(1, &m_framebuffer);
+		glDeleteRenderbuffers(1, &m_colour);
+
+		m_framebuffer = std::exchange(other.m_framebuffer, 0);
+		m_colour = std::exchange(other.m_colour, 0);
+		m_width = std::exchange(other.m_width, 0);
+		m_height = std::exchange(other.m_height, 0);
+	}
+	return *this;
+}
+
+void framebuffer::bind() const
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+	glViewport(0, 0, m_width, m_height);
+}
+
+auto framebuffer::read_pixels() const -> image
+{
+	image frame{m_width, m_height, {}};
+
+	auto const row_size = static_cast<std::size_t>(m_width) * image::channels;
+	auto const rows = static_cast<std::size_t>(m_height);
+	frame.pixels.resize(row_size * rows);
+
+	glNamedFramebufferReadBuffer(m_framebuffer, GL_COLOR_ATTACHMENT0);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, m_framebuffer);
+	glReadPixels(0,
+	             0,
+	             m_width,
+	             m_height,
+	             GL_RGBA,
+	             GL_UNSIGNED_BYTE,
+	             std::data(frame.pixels));
+
+	// GL returns the bottom row first.
+	auto first = std::begin(frame.pixels);
+	auto last = std::end(frame.pixels);
+	for (std::size_t row{}; row < rows / 2; ++row)
+	{
+		auto const top = std::next(first, static_cast<long>(row * row_size));
+		auto const bottom =
+		    std::prev(last, static_cast<long>((row + 1) * row_size));
+		std::swap_ranges(top,
+		                 std::next(top, static_cast<long>(row_size)),
+		                 bottom);
+	}
+
+	return frame;
+}
+} // namespace yaboc::graphics
@@ -0,0 +1,196 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#include "yaboc/graphics/gpu_timer_queries.h"
+
+#include "glad/gl.h"
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
+namespace yaboc::graphics
+{
+gpu_timer_queries::~gpu_timer_queries()
+{
+	release();
+}
+
+gpu_timer_queries::gpu_timer_queries(std::size_t num_timers,
+                                     std::size_t num_sets)
+    : m_num_timers{num_timers}
+    , m_queries(num_timers * num_sets)
+    , m_started(num_timers * num_sets)
+    , m_sets(num_sets)
+    , m_elapsed(num_timers)
+{
+	assert(num_sets > 0);
+
+	glCreateQueries(GL_TIME_ELAPSED,
+	                static_cast<GLsizei>(std::size(m_queries)),
+	                std::data(m_queries));
+}
+
+gpu_timer_queries::gpu_timer_queries(gpu_timer_queries&& other) noexcept
+    : m_num_timers{std::exchange(other.m_num_timers, 0)}
+    , m_queries{std::move(other.m_queries)}
+    , m_started{std::move(other.m_started)}
+    , m_sets{std::move(other.m_sets)}
+    , m_current_set{std::exchange(other.m_current_set, 0)}
+    , m_active_timer{std::exchange(other.m_active_timer, no_timer)}
+    , m_elapsed{std::move(other.m_elapsed)}
+    , m_dropped_frames{std::exchange(other.m_dropped_frames, 0)}
+{}
+
+auto gpu_timer_queries::operator=(gpu_timer_queries&& other) noexcept
+    -> gpu_timer_queries&
+{
+	if (this != &other)
+	{
+		release();
+
+		m_num_timers = std::exchange(other.m_num_timers, 0);
+		m_queries = std::move(other.m_queries);
+		m_started = std::move(other.m_started);
+		m_sets = std::move(other.m_sets);
+		m_current_set = std::exchange(other.m_current_set, 0);
+		m_active_timer = std::exchange(other.m_active_timer, no_timer);
+		m_elapsed = std::move(other.m_elapsed);
+		m_dropped_frames = std::exchange(other.m_dropped_frames, 0);
+	}
+	return *this;
+}
+
+void gpu_timer_queries::release()
+{
+	if (!m_queries.empty())
+	{
+		glDeleteQueries(static_cast<GLsizei>(std::size(m_queries)),
+		                std::data(m_queries));
+		m_queries.clear();
+	}
+}
+
+auto gpu_timer_queries::begin_frame(std::uint64_t frame)
+    -> std::optional<resolved_frame>
+{
+	assert(m_active_timer == no_timer);
+
+	m_current_set = (m_current_set + 1) % std::size(m_sets);
+
+	std::optional<resolved_frame> resolved{};
+	if (m_sets[m_current_set].recorded)
+	{
+		resolved = read_back(m_current_set, false);
+	}
+
+	auto& set = m_sets[m_current_set];
+	set.frame = frame;
+	set.recorded = true;
+
+	auto const first_query = m_current_set * m_num_timers;
+	for (std::size_t timer{}; timer < m_num_timers; ++timer)
+	{
+		m_started[first_query + timer] = false;
+	}
+
+	return resolved;
+}
+
+auto gpu_timer_queries::flush() -> std::optional<resolved_frame>
+{
+	assert(m_active_timer == no_timer);
+
+	// The set after the current one is the oldest.
+	for (std::size_t offset{1}; offset <= std::size(m_sets); ++offset)
+	{
+		auto const set_index = (m_current_set + offset) % std::size(m_sets);
+		if (m_sets[set_index].recorded)
+		{
+			return read_back(set_index, true);
+		}
+	}
+	return std::nullopt;
+}
+
+void gpu_timer_queries::begin(std::size_t timer)
+{
+	assert(timer < m_num_timers);
+	assert(m_active_timer == no_timer);
+
+	auto const query = m_current_set * m_num_timers + timer;
+	glBeginQuery(GL_TIME_ELAPSED, m_queries[query]);
+	m_started[query] = true;
+	m_active_timer = timer;
+}
+
+void gpu_timer_queries::end()
+{
+	assert(m_active_timer != no_timer);
+
+	glEndQuery(GL_TIME_ELAPSED);
+	m_active_timer = no_timer;
+}
+
+auto gpu_timer_queries::read_back(std::size_t set_index, bool wait)
+    -> resolved_frame
+{
+	auto&      set = m_sets[set_index];
+	auto const first_query = set_index * m_num_timers;
+
+	// Results become available in submission order, but a set is small
+	// enough to simply ask every query.
+	bool available{true};
+	for (std::size_t timer{}; timer < m_num_timers && available && !wait;
+	     ++timer)
+	{
+		if (!m_started[first_query + timer])
+		{
+			continue;
+		}
+
+		GLuint query_available{};
+		glGetQueryObjectuiv(m_queries[first_query + timer],
+		                    GL_QUERY_RESULT_AVAILABLE,
+		                    &query_available);
+		available = query_available == GL_TRUE;
+	}
+
+	std::ranges::fill(m_elapsed, std::chrono::nanoseconds{});
+	if (available)
+	{
+		for (std::size_t timer{}; timer < m_num_timers; ++timer)
+		{
+			if (!m_started[first_query + timer])
+			{
+				continue;
+			}
+
+			GLuint64 elapsed{};
+			glGetQueryObjectui64v(m_queries[first_query + timer],
+			                      GL_QUERY_RESULT,
+			                      &elapsed);
+			m_elapsed[timer] = std::chrono::nanoseconds{elapsed};
+		}
+	}
+	else
+	{
+		++m_dropped_frames;
+	}
+
+	set.recorded = false;
+	return {set.frame, available, m_elapsed};
+}
+} // namespace yaboc::graphics
@@ -0,0 +1,128 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#include "yaboc/graphics/image.h"
+
+#include "stb_image.h"
+#include "stb_image_write.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+
+namespace yaboc::graphics
+{
+auto load_png(std::filesystem::path const& path) -> std::optional<image>
+{
+	image picture{};
+	int   num_channels{};
+
+	std::unique_ptr<stbi_uc, decltype(&stbi_image_free)> const pixel_data{
+	    stbi_load(path.string().c_str(),
+	              &picture.width,
+	              &picture.height,
+	              &num_channels,
+	              STBI_rgb_alpha),
+	    &stbi_image_free};
+	if (pixel_data == nullptr)
+	{
+		return std::nullopt;
+	}
+
+	auto const size = static_cast<std::size_t>(picture.width) *
+	                  static_cast<std::size_t>(picture.height) *
+	                  image::channels;
+	picture.pixels.assign(pixel_data.get(), pixel_data.get() + size);
+	return picture;
+}
+
+auto write_png(std::filesystem::path const& path, image const& picture) -> bool
+{
+	auto const stride = picture.width * static_cast<int>(image::channels);
+	return stbi_write_png(path.string().c_str(),
+	                      picture.width,
+	                      picture.height,
+	                      static_cast<int>(image::channels),
+	                      std::data(picture.pixels),
+	                      stride) != 0;
+}
+
+auto downsample(image const& picture) -> image
+{
+	image half{.width = std::max(picture.width / 2, 1),
+	           .height = std::max(picture.height / 2, 1)};
+	half.pixels.resize(static_cast<std::size_t>(half.width) *
+	                   static_cast<std::size_t>(half.height) * image::channels);
+
+	auto const source = [&picture](int x, int y, std::size_t channel) {
+		x = std::min(x, picture.width - 1);
+		y = std::min(y, picture.height - 1);
+		auto const pixel = static_cast<std::size_t>(y) *
+		                       static_cast<std::size_t>(picture.width) +
+		                   static_cast<std::size_t>(x);
+		return static_cast<unsigned int>(
+		    picture.pixels[pixel * image::channels + channel]);
+	};
+
+	auto* destination = std::data(half.pixels);
+	for (int y{}; y < half.height; ++y)
+	{
+		for (int x{}; x < half.width; ++x)
+		{
+			for (std::size_t channel{}; channel < image::channels; ++channel)
+			{
+				auto const sum = source(2 * x, 2 * y, channel) +
+				                 source(2 * x + 1, 2 * y, channel) +
+				                 source(2 * x, 2 * y + 1, channel) +
+				                 source(2 * x + 1, 2 * y + 1, channel);
+				*destination++ = static_cast<std::uint8_t>((sum + 2) / 4);
+			}
+		}
+	}
+	return half;
+}
+
+auto compare_images(image const& expected,
+                    image const& actual,
+                    std::uint8_t channel_tolerance) -> image_difference
+{
+	image_difference difference{};
+	if (expected.width != actual.width || expected.height != actual.height)
+	{
+		difference.size_mismatch = true;
+		return difference;
+	}
+
+	for (std::size_t pixel{}; pixel < std::size(expected.pixels);
+	     pixel += image::channels)
+	{
+		int pixel_delta{};
+		for (std::size_t channel{}; channel < image::channels; ++channel)
+		{
+			pixel_delta = std::max(pixel_delta,
+			                       std::abs(expected.pixels[pixel + channel] -
+			                                actual.pixels[pixel + channel]));
+		}
+
+		difference.max_delta = std::max(difference.max_delta,
+		                                 static_cast<std::uint8_t>(pixel_delta));
+		if (pixel_delta > channel_tolerance)
+		{
+			++difference.differing_pixels;
+		}
+	}
+	return difference;
+}
+} // namespace yaboc::graphics
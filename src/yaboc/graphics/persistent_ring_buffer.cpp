@@ -0,0 +1,296 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#include "yaboc/graphics/persistent_ring_buffer.h"
+
+#include "glad/gl.h"
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <limits>
+#include <utility>
+
+namespace yaboc::graphics
+{
+namespace
+{
+constexpr auto mapping_flags =
+    GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+constexpr auto storage_flags = mapping_flags | GL_DYNAMIC_STORAGE_BIT;
+
+constexpr auto fence_poll_interval = std::chrono::nanoseconds{
+    std::chrono::milliseconds{1}
+};
+
+constexpr auto align_up(std::size_t value, std::size_t alignment)
+{
+	return ((value + alignment - 1) / alignment) * alignment;
+}
+
+constexpr auto overlaps(std::size_t begin_a,
+                        std::size_t end_a,
+                        std::size_t begin_b,
+                        std::size_t end_b)
+{
+	return begin_a < end_b && begin_b < end_a;
+}
+} // namespace
+
+persistent_ring_buffer::~persistent_ring_buffer()
+{
+	release_storage();
+}
+
+persistent_ring_buffer::persistent_ring_buffer(std::size_t size,
+                                               std::size_t frames_in_flight)
+    : m_frames_in_flight{frames_in_flight}
+{
+	assert(m_frames_in_flight > 0);
+	allocate_storage(size);
+}
+
+persistent_ring_buffer::persistent_ring_buffer(
+    persistent_ring_buffer&& other) noexcept
+    : m_buffer{std::exchange(other.m_buffer, 0)}
+    , m_mapped{std::exchange(other.m_mapped, {})}
+    , m_head{other.m_head}
+    , m_unfenced_begin{other.m_unfenced_begin}
+    , m_reserved_offset{other.m_reserved_offset}
+    , m_frames_in_flight{other.m_frames_in_flight}
+    , m_frame{other.m_frame}
+    , m_in_flight{std::exchange(other.m_in_flight, {})}
+    , m_statistics{other.m_statistics}
+{}
+
+auto persistent_ring_buffer::operator=(persistent_ring_buffer&& other) noexcept
+    -> persistent_ring_buffer&
+{
+	if (this != &other)
+	{
+		release_storage();
+
+		m_buffer = std::exchange(other.m_buffer, 0);
+		m_mapped = std::exchange(other.m_mapped, {});
+		m_head = other.m_head;
+		m_unfenced_begin = other.m_unfenced_begin;
+		m_reserved_offset = other.m_reserved_offset;
+		m_frames_in_flight = other.m_frames_in_flight;
+		m_frame = other.m_frame;
+		m_in_flight = std::exchange(other.m_in_flight, {});
+		m_statistics = other.m_statistics;
+	}
+	return *this;
+}
+
+auto persistent_ring_buffer::fits(std::size_t size, std::size_t alignment) const
+    -> bool
+{
+	return align_up(m_head, alignment) + size <= capacity();
+}
+
+auto persistent_ring_buffer::reserve(std::size_t size, std::size_t alignment)
+    -> reservation
+{
+	assert(alignment > 0);
+
+	auto offset = align_up(m_head, alignment);
+
+	if (size > capacity())
+	{
+		grow(size);
+		offset = 0;
+	}
+	else if (offset + size > capacity())
+	{
+		fence();
+		m_head = 0;
+		m_unfenced_begin = 0;
+		offset = 0;
+		++m_statistics.wraps;
+
+		// A frame that laps itself would have to wait for its own draws to
+		// retire. The buffer is too small for the workload, so make room for
+		// the frames that follow instead of serialising on the GPU.
+		auto const laps_current_frame =
+		    std::ranges::any_of(m_in_flight, [this, size](auto const& range) {
+			    return range.frame == m_frame &&
+			           overlaps(range.begin, range.end, 0, size);
+		    });
+		if (laps_current_frame)
+		{
+			grow(capacity() * 2);
+		}
+	}
+
+	wait_for_range(offset, offset + size);
+
+	m_reserved_offset = offset;
+	return {m_mapped.subspan(offset, size), offset};
+}
+
+void persistent_ring_buffer::commit(std::size_t size)
+{
+	assert(m_reserved_offset + size <= capacity());
+
+	m_head = m_reserved_offset + size;
+	m_statistics.bytes_written += size;
+}
+
+void persistent_ring_buffer::fence()
+{
+	if (m_head == m_unfenced_begin)
+	{
+		return;
+	}
+
+	m_in_flight.push_back(
+	    {.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0),
+	     .begin = m_unfenced_begin,
+	     .end = m_head,
+	     .frame = m_frame});
+	m_unfenced_begin = m_head;
+}
+
+void persistent_ring_buffer::end_frame()
+{
+	fence();
+
+	++m_frame;
+	++m_statistics.frames;
+
+	if (m_frame <= m_frames_in_flight)
+	{
+		return;
+	}
+
+	auto const oldest_allowed_frame = m_frame - m_frames_in_flight;
+	auto const retired =
+	    std::ranges::find_if(m_in_flight, [oldest_allowed_frame](auto& range) {
+		    return range.frame >= oldest_allowed_frame;
+	    });
+
+	if (retired == std::begin(m_in_flight))
+	{
+		return;
+	}
+
+	// The GPU retires fences in order, so waiting on the newest one of the
+	// frames that fell out of the window covers all of them.
+	wait(std::prev(retired)->fence);
+	std::for_each(std::begin(m_in_flight), retired, [](auto& range) {
+		glDeleteSync(range.fence);
+	});
+	m_in_flight.erase(std::begin(m_in_flight), retired);
+}
+
+void persistent_ring_buffer::allocate_storage(std::size_t size)
+{
+	assert(size < std::numeric_limits<GLsizeiptr>::max());
+
+	glCreateBuffers(1, &m_buffer);
+	glNamedBufferStorage(m_buffer,
+	                     static_cast<GLsizeiptr>(size),
+	                     nullptr,
+	                     storage_flags);
+
+	void* buf = glMapNamedBufferRange(m_buffer,
+	                                  0,
+	                                  static_cast<GLsizeiptr>(size),
+	                                  mapping_flags);
+	m_mapped = std::span<std::byte>(static_cast<std::byte*>(buf), size);
+}
+
+void persistent_ring_buffer::release_storage()
+{
+	if (m_buffer == 0)
+	{
+		return;
+	}
+
+	for (auto& range: m_in_flight)
+	{
+		glDeleteSync(range.fence);
+	}
+	m_in_flight.clear();
+
+	// Draws still reading the buffer keep it alive until they retire.
+	glUnmapNamedBuffer(m_buffer);
+	glDeleteBuffers(1, &m_buffer);
+
+	m_buffer = 0;
+	m_mapped = {};
+}
+
+void persistent_ring_buffer::grow(std::size_t minimum_size)
+{
+	auto const new_size = std::max(capacity() * 2, minimum_size);
+
+	release_storage();
+	allocate_storage(new_size);
+
+	m_head = 0;
+	m_unfenced_begin = 0;
+	++m_statistics.grows;
+}
+
+void persistent_ring_buffer::wait_for_range(std::size_t begin, std::size_t end)
+{
+	auto newest_overlap = std::end(m_in_flight);
+	for (auto it = std::begin(m_in_flight); it != std::end(m_in_flight); ++it)
+	{
+		if (overlaps(it->begin, it->end, begin, end))
+		{
+			newest_overlap = it;
+		}
+	}
+
+	if (newest_overlap == std::end(m_in_flight))
+	{
+		return;
+	}
+
+	wait(newest_overlap->fence);
+
+	auto const retired = std::next(newest_overlap);
+	std::for_each(std::begin(m_in_flight), retired, [](auto& range) {
+		glDeleteSync(range.fence);
+	});
+	m_in_flight.erase(std::begin(m_in_flight), retired);
+}
+
+void persistent_ring_buffer::wait(GLsync fence)
+{
+	auto result = glClientWaitSync(fence, 0, 0);
+	if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED)
+	{
+		return;
+	}
+
+	auto const wait_start = std::chrono::steady_clock::now();
+
+	while (result == GL_TIMEOUT_EXPIRED)
+	{
+		result = glClientWaitSync(
+		    fence,
+		    GL_SYNC_FLUSH_COMMANDS_BIT,
+		    static_cast<GLuint64>(fence_poll_interval.count()));
+	}
+	assert(result != GL_WAIT_FAILED);
+
+	++m_statistics.fence_waits;
+	m_statistics.time_blocked += std::chrono::steady_clock::now() - wait_start;
+}
+} // namespace yaboc::graphics
@@ -15,18 +15,71 @@
 // this program. If not, see <https://www.gnu.org/licenses/>.
 #include "yaboc/graphics/shader.h"
 
+#include "yaboc/assets/asset_pack.h"
+#include "yaboc/graphics/embedded_shaders.h"
+
 #include "glad/gl.h"
 
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <cstdint>
+#include <format>
 #include <fstream>
+#include <iostream>
+#include <iterator>
 #include <sstream>
+#include <string_view>
+#include <system_error>
 #include <utility>
 
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
 namespace yaboc
 {
 namespace
 {
-auto gl_check_shader_compile_status(unsigned int shader_id) -> bool;
+// NOLINTNEXTLINE(*-avoid-non-const-global-variables)
+std::filesystem::path program_cache_directory{};
+
+// NOLINTNEXTLINE(*-avoid-non-const-global-variables)
+assets::asset_pack const* shader_pack{};
+
+struct shader_source final
+{
+	shader_builder_input::shader_type type{};
+	std::string                       code{};
+};
+
+// Compiled and linked without having waited for the driver, or loaded from
+// the cache.
+struct pending_program final
+{
+	std::vector<shader_builder_input> inputs{};
+	unsigned int                      program_id{};
+	std::vector<unsigned int>         shaders{};
+	// Empty if the program came from the cache or is not to be stored.
+	std::string cache_key{};
+};
+
+// NOLINTNEXTLINE(*-avoid-non-const-global-variables)
+std::vector<pending_program> pending_programs{};
+
+// Precedes the key and the program binary in a cache file.
+struct program_cache_header final
+{
+	std::array<char, 4> magic{'Y', 'P', 'C', '1'};
+	std::uint32_t       key_size{};
+	std::uint32_t       binary_format{};
+	std::uint32_t       binary_size{};
+};
+
+auto gl_check_shader_compile_status(unsigned int       shader_id,
+                                    std::string const& path) -> bool;
 
 auto gl_check_program_link_status(unsigned int program_id) -> bool;
 
@@ -46,48 +99,339 @@ constexpr auto to_gl_shader_type(shader_builder_input::shader_type input)
 
 	std::unreachable();
 }
-} // namespace
 
-auto make_shader(std::vector<shader_builder_input> const& inputs)
-    -> unsigned int
+auto load_source(shader_builder_input const& input) -> shader_source
+{
+	shader_source source{.type = input.type};
+
+	if (shader_pack != nullptr)
+	{
+		if (auto const cooked = shader_pack->shader(input.path))
+		{
+			source.code = *cooked;
+			return source;
+		}
+	}
+
+	auto const embedded = graphics::embedded_shaders();
+	auto const shader = std::ranges::find(embedded,
+	                                      std::string_view{input.path},
+	                                      &graphics::embedded_shader::path);
+	if (shader != std::end(embedded))
+	{
+		source.code = shader->source;
+		return source;
+	}
+
+	auto file = std::ifstream{input.path};
+
+	std::stringstream file_contents{};
+	file_contents << file.rdbuf();
+	source.code = file_contents.str();
+	return source;
+}
+
+// 64-bit FNV-1a; the cache only needs to tell sources apart, not resist
+// tampering.
+auto hash(std::string_view bytes) -> std::uint64_t
+{
+	constexpr std::uint64_t offset_basis{0xcbf2'9ce4'8422'2325};
+	constexpr std::uint64_t prime{0x0000'0100'0000'01b3};
+
+	auto value = offset_basis;
+	for (auto const byte: bytes)
+	{
+		value ^= static_cast<unsigned char>(byte);
+		value *= prime;
+	}
+	return value;
+}
+
+auto gl_string(GLenum name) -> std::string_view
+{
+	auto const* value = glGetString(name);
+	return value != nullptr ? reinterpret_cast<char const*>(value) : "";
+}
+
+// A program binary is only good for the driver that produced it, so the
+// driver is part of the key along with every stage.
+auto make_cache_key(std::vector<shader_source> const& sources) -> std::string
+{
+	auto key = std::format("{}\n{}\n{}\n",
+	                       gl_string(GL_VENDOR),
+	                       gl_string(GL_RENDERER),
+	                       gl_string(GL_VERSION));
+	for (auto const& source: sources)
+	{
+		key += std::format("{} {:016x}\n",
+		                   to_gl_shader_type(source.type),
+		                   hash(source.code));
+	}
+	return key;
+}
+
+auto cache_file(std::string const& key) -> std::filesystem::path
+{
+	return program_cache_directory / std::format("{:016x}.bin", hash(key));
+}
+
+auto program_cache_enabled() -> bool
+{
+	if (program_cache_directory.empty())
+	{
+		return false;
+	}
+
+	GLint num_formats{};
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &num_formats);
+	return num_formats > 0;
+}
+
+// Returns 0 if the cache does not have the program, or the driver rejects
+// what it has.
+auto load_cached_program(std::string const& key) -> unsigned int
+{
+	auto const    path = cache_file(key);
+	std::ifstream file{path, std::ios::binary};
+	if (!file)
+	{
+		return 0;
+	}
+
+	program_cache_header header{};
+	file.read(reinterpret_cast<char*>(&header), sizeof(header));
+	if (!file || header.magic != program_cache_header{}.magic ||
+	    header.key_size != std::size(key))
+	{
+		return 0;
+	}
+
+	// Different keys can share a file name.
+	std::string stored_key(header.key_size, '\0');
+	file.read(stored_key.data(), static_cast<std::streamsize>(header.key_size));
+	if (!file || stored_key != key)
+	{
+		return 0;
+	}
+
+	// A damaged size must not have us allocate more than the file holds.
+	std::error_code error{};
+	auto const      file_size = std::filesystem::file_size(path, error);
+	auto const      binary_offset = sizeof(header) + std::size(stored_key);
+	if (error || file_size < binary_offset ||
+	    header.binary_size > file_size - binary_offset)
+	{
+		return 0;
+	}
+
+	std::vector<char> binary(header.binary_size);
+	file.read(std::data(binary),
+	          static_cast<std::streamsize>(std::size(binary)));
+	if (!file)
+	{
+		return 0;
+	}
+
+	auto const program_id = glCreateProgram();
+	glProgramBinary(program_id,
+	                header.binary_format,
+	                std::data(binary),
+	                static_cast<GLsizei>(std::size(binary)));
+
+	GLint success{};
+	glGetProgramiv(program_id, GL_LINK_STATUS, &success);
+	if (success == 0)
+	{
+		glDeleteProgram(program_id);
+		return 0;
+	}
+	return program_id;
+}
+
+auto process_id() -> long
+{
+#if defined(_WIN32)
+	return _getpid();
+#else
+	return getpid();
+#endif
+}
+
+void store_program(std::string const& key, unsigned int program_id)
+{
+	GLint binary_size{};
+	glGetProgramiv(program_id, GL_PROGRAM_BINARY_LENGTH, &binary_size);
+	if (binary_size <= 0)
+	{
+		return;
+	}
+
+	std::vector<char> binary(static_cast<std::size_t>(binary_size));
+	GLenum            binary_format{};
+	glGetProgramBinary(program_id,
+	                   binary_size,
+	                   nullptr,
+	                   &binary_format,
+	                   std::data(binary));
+
+	program_cache_header const header{
+	    .key_size = static_cast<std::uint32_t>(std::size(key)),
+	    .binary_format = binary_format,
+	    .binary_size = static_cast<std::uint32_t>(binary_size)};
+
+	std::error_code error{};
+	std::filesystem::create_directories(program_cache_directory, error);
+
+	// Written aside and renamed, so that no other instance ever reads half a
+	// file. The staging file is named after the process, so that two
+	// instances storing the same program do not write into one another's.
+	auto const path = cache_file(key);
+	auto       staging = path;
+	staging += std::format(".{}.tmp", process_id());
+	{
+		std::ofstream file{staging, std::ios::binary | std::ios::trunc};
+		file.write(reinterpret_cast<char const*>(&header), sizeof(header));
+		file.write(key.data(), static_cast<std::streamsize>(std::size(key)));
+		file.write(std::data(binary),
+		           static_cast<std::streamsize>(std::size(binary)));
+		if (!file)
+		{
+			std::cerr << "failed to write " << staging << '\n';
+			file.close();
+			std::filesystem::remove(staging, error);
+			return;
+		}
+	}
+
+	std::filesystem::rename(staging, path, error);
+	if (error)
+	{
+		std::cerr << "failed to store " << path << ": " << error.message()
+		          << '\n';
+		std::filesystem::remove(staging, error);
+	}
+}
+
+// Issues every GL call needed for the program but queries nothing, so that
+// with parallel shader compilation the driver can work in the background.
+auto start_program(std::vector<shader_builder_input> const& inputs)
+    -> pending_program
 {
-	auto program_id{glCreateProgram()};
+	pending_program pending{.inputs = inputs};
 
-	std::vector<unsigned int> attached_shaders{};
+	std::vector<shader_source> sources{};
+	sources.reserve(std::size(inputs));
+	std::ranges::transform(pending.inputs,
+	                       std::back_inserter(sources),
+	                       &load_source);
+
+	auto const cache = program_cache_enabled();
+	auto       key = cache ? make_cache_key(sources) : std::string{};
+	if (cache)
+	{
+		pending.program_id = load_cached_program(key);
+		if (pending.program_id != 0)
+		{
+			return pending;
+		}
+	}
 
-	for (auto const& input: inputs)
+	pending.program_id = glCreateProgram();
+	if (cache)
 	{
-		auto shader_id = glCreateShader(to_gl_shader_type(input.type));
+		glProgramParameteri(pending.program_id,
+		                    GL_PROGRAM_BINARY_RETRIEVABLE_HINT,
+		                    GL_TRUE);
+		pending.cache_key = std::move(key);
+	}
 
-		auto file = std::ifstream{input.path};
+	for (auto const& source: sources)
+	{
+		auto shader_id = glCreateShader(to_gl_shader_type(source.type));
 
-		std::stringstream file_contents{};
-		file_contents << file.rdbuf();
-		auto        code = file_contents.str();
-		auto const* code_cstr = code.c_str();
+		auto const* code_cstr = source.code.c_str();
 		glShaderSource(shader_id, 1, &code_cstr, nullptr);
 		glCompileShader(shader_id);
-		gl_check_shader_compile_status(shader_id);
-		glAttachShader(program_id, shader_id);
-		attached_shaders.push_back(shader_id);
+		glAttachShader(pending.program_id, shader_id);
+		pending.shaders.push_back(shader_id);
+	}
+
+	glLinkProgram(pending.program_id);
+
+	return pending;
+}
+
+// Waits for the driver and reports any errors.
+auto finish_program(pending_program const& pending) -> unsigned int
+{
+	if (std::empty(pending.shaders))
+	{
+		return pending.program_id;
 	}
 
-	glLinkProgram(program_id);
+	for (std::size_t index{}; index < std::size(pending.shaders); ++index)
+	{
+		gl_check_shader_compile_status(pending.shaders[index],
+		                               pending.inputs[index].path);
+	}
 
-	gl_check_program_link_status(program_id);
+	auto const linked = gl_check_program_link_status(pending.program_id);
 
-	for (auto id: attached_shaders)
+	for (auto id: pending.shaders)
 	{
-		glDetachShader(program_id, id);
+		glDetachShader(pending.program_id, id);
 		glDeleteShader(id);
 	}
 
+	if (linked && !std::empty(pending.cache_key))
+	{
+		store_program(pending.cache_key, pending.program_id);
+	}
+
+	return pending.program_id;
+}
+} // namespace
+
+void use_program_cache(std::filesystem::path directory)
+{
+	program_cache_directory = std::move(directory);
+}
+
+void use_shader_pack(assets::asset_pack const* pack)
+{
+	shader_pack = pack;
+}
+
+void prepare_shader(std::vector<shader_builder_input> const& inputs)
+{
+	if (GLAD_GL_ARB_parallel_shader_compile != 0)
+	{
+		// Leaves the number of threads up to the driver.
+		glMaxShaderCompilerThreadsARB(0xFFFF'FFFF);
+	}
+
+	pending_programs.push_back(start_program(inputs));
+}
+
+auto make_shader(std::vector<shader_builder_input> const& inputs)
+    -> unsigned int
+{
+	auto const prepared =
+	    std::ranges::find(pending_programs, inputs, &pending_program::inputs);
+	if (prepared == std::end(pending_programs))
+	{
+		return finish_program(start_program(inputs));
+	}
+
+	auto const program_id = finish_program(*prepared);
+	pending_programs.erase(prepared);
 	return program_id;
 }
 
 namespace
 {
-auto gl_check_shader_compile_status(unsigned int shader_id) -> bool
+auto gl_check_shader_compile_status(unsigned int       shader_id,
+                                    std::string const& path) -> bool
 {
 	int success{};
 	glGetShaderiv(shader_id, GL_COMPILE_STATUS, &success);
@@ -98,10 +442,7 @@ auto gl_check_shader_compile_status(unsigned int shader_id) -> bool
 		std::string message{};
 		message.resize(static_cast<std::size_t>(log_length));
 		glGetShaderInfoLog(shader_id, log_length, nullptr, message.data());
-		//			spdlog::default_logger()->error(
-		//			    "Failed to compiler shader (id: {}): {}",
-		//			    shader_id,
-		//			    message);
+		std::cerr << "failed to compile " << path << ":\n" << message << '\n';
 		return false;
 	}
 	return true;
@@ -118,10 +459,8 @@ auto gl_check_program_link_status(unsigned int program_id) -> bool
 		std::string message{};
 		message.resize(static_cast<std::size_t>(log_length));
 		glGetProgramInfoLog(program_id, log_length, nullptr, message.data());
-		//			spdlog::default_logger()->error(
-		//			    "Failed to compiler shader (id: {}): {}",
-		//			    program_id,
-		//			    message);
+		std::cerr << "failed to link program " << program_id << ":\n"
+		          << message << '\n';
 		return false;
 	}
 	return true;
@@ -0,0 +1,121 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#include "yaboc/graphics/texture_streamer.h"
+
+#include "glad/gl.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <utility>
+
+namespace yaboc::graphics
+{
+namespace
+{
+constexpr std::size_t row_alignment{4};
+} // namespace
+
+texture_streamer::texture_streamer(std::size_t bytes_per_frame,
+                                   std::size_t frames_in_flight)
+    : m_staging{bytes_per_frame * (frames_in_flight + 1), frames_in_flight}
+    , m_bytes_per_frame{bytes_per_frame}
+{}
+
+void texture_streamer::enqueue(texture_upload&& upload)
+{
+	assert(std::size(upload.picture.pixels) ==
+	       static_cast<std::size_t>(upload.picture.width) *
+	           static_cast<std::size_t>(upload.picture.height) *
+	           image::channels);
+	m_pending.push_back({.upload = std::move(upload)});
+}
+
+void texture_streamer::pump()
+{
+	if (std::empty(m_pending))
+	{
+		return;
+	}
+
+	auto budget = m_bytes_per_frame;
+	while (!std::empty(m_pending))
+	{
+		auto& [upload, next_row] = m_pending.front();
+		auto const& picture = upload.picture;
+
+		auto const row_size =
+		    static_cast<std::size_t>(picture.width) * image::channels;
+		auto const rows_left = static_cast<std::size_t>(picture.height) -
+		                       static_cast<std::size_t>(next_row);
+
+		// Only the first rows of a frame may go over the budget.
+		auto const rows = std::min(budget / row_size, rows_left);
+		if (rows == 0 && budget != m_bytes_per_frame)
+		{
+			break;
+		}
+
+		auto const row_count = std::max(rows, std::size_t{1});
+		auto const size = row_count * row_size;
+
+		auto const staging = m_staging.reserve(size, row_alignment);
+		std::memcpy(std::data(staging.memory),
+		            std::data(picture.pixels) +
+		                static_cast<std::size_t>(next_row) * row_size,
+		            size);
+		m_staging.commit(size);
+
+		// Bound after reserving, which may have grown the ring. With a pixel
+		// unpack buffer bound, the pointer is an offset into it.
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_staging.buffer_id());
+		auto const offset = staging.offset;
+		glTextureSubImage3D(
+		    upload.texture,
+		    upload.level,
+		    0,
+		    next_row,
+		    upload.layer,
+		    picture.width,
+		    static_cast<GLsizei>(row_count),
+		    1,
+		    GL_RGBA,
+		    GL_UNSIGNED_BYTE,
+		    reinterpret_cast<void const*>(offset)); // NOLINT(*-no-int-to-ptr)
+
+		next_row += static_cast<int>(row_count);
+		budget -= std::min(budget, size);
+
+		if (next_row == picture.height)
+		{
+			auto on_complete = std::move(upload.on_complete);
+			m_pending.pop_front();
+			if (on_complete)
+			{
+				on_complete();
+			}
+		}
+
+		if (budget == 0)
+		{
+			break;
+		}
+	}
+
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	m_staging.end_frame();
+}
+} // namespace yaboc::graphics
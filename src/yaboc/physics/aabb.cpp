@@ -0,0 +1,182 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#include "yaboc/physics/aabb.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define YABOC_AABB_X86
+#include <emmintrin.h>
+#endif
+
+#include <algorithm>
+#include <bit>
+#include <limits>
+
+namespace yaboc::physics
+{
+namespace
+{
+// When, along one axis, the box's extent starts and stops overlapping the
+// obstacle's.
+struct slab final
+{
+	float entry{};
+	float exit{};
+};
+
+auto sweep_axis(float min,
+                float max,
+                float displacement,
+                float obstacle_min,
+                float obstacle_max) -> std::optional<slab>
+{
+	if (displacement > 0.0F)
+	{
+		return slab{(obstacle_min - max) / displacement,
+		            (obstacle_max - min) / displacement};
+	}
+	if (displacement < 0.0F)
+	{
+		return slab{(obstacle_max - min) / displacement,
+		            (obstacle_min - max) / displacement};
+	}
+
+	// Not moving along the axis, so it overlaps throughout or never.
+	if (min < obstacle_max && obstacle_min < max)
+	{
+		constexpr auto infinity = std::numeric_limits<float>::infinity();
+		return slab{-infinity, infinity};
+	}
+	return std::nullopt;
+}
+
+auto sign(float value) -> float
+{
+	return value < 0.0F ? -1.0F : 1.0F;
+}
+} // namespace
+
+auto find_overlaps(aabb const&              box,
+                   aabb_batch const&        batch,
+                   std::span<std::uint32_t> hits) -> std::size_t
+{
+	auto const count = batch.size();
+	assert(std::size(hits) >= count);
+
+	std::size_t hit_count{};
+	std::size_t index{};
+
+#if defined(YABOC_AABB_X86)
+	constexpr std::size_t lanes{4};
+
+	auto const box_min_x = _mm_set1_ps(box.min.x);
+	auto const box_min_y = _mm_set1_ps(box.min.y);
+	auto const box_max_x = _mm_set1_ps(box.max.x);
+	auto const box_max_y = _mm_set1_ps(box.max.y);
+
+	for (; index + lanes <= count; index += lanes)
+	{
+		auto const min_x = _mm_loadu_ps(std::data(batch.min_x) + index);
+		auto const min_y = _mm_loadu_ps(std::data(batch.min_y) + index);
+		auto const max_x = _mm_loadu_ps(std::data(batch.max_x) + index);
+		auto const max_y = _mm_loadu_ps(std::data(batch.max_y) + index);
+
+		auto const x = _mm_and_ps(_mm_cmplt_ps(min_x, box_max_x),
+		                          _mm_cmplt_ps(box_min_x, max_x));
+		auto const y = _mm_and_ps(_mm_cmplt_ps(min_y, box_max_y),
+		                          _mm_cmplt_ps(box_min_y, max_y));
+
+		auto mask =
+		    static_cast<unsigned int>(_mm_movemask_ps(_mm_and_ps(x, y)));
+		for (; mask != 0; mask &= mask - 1)
+		{
+			hits[hit_count++] = static_cast<std::uint32_t>(
+			    index + static_cast<std::size_t>(std::countr_zero(mask)));
+		}
+	}
+#endif
+
+	for (; index < count; ++index)
+	{
+		if (overlaps(box, batch[index]))
+		{
+			hits[hit_count++] = static_cast<std::uint32_t>(index);
+		}
+	}
+	return hit_count;
+}
+
+auto find_penetration(aabb const& a, aabb const& b) -> penetration
+{
+	auto const push_right = b.max.x - a.min.x;
+	auto const push_left = a.max.x - b.min.x;
+	auto const push_down = b.max.y - a.min.y;
+	auto const push_up = a.max.y - b.min.y;
+
+	penetration result{.normal = {1.0F, 0.0F}, .depth = push_right};
+	if (push_left < result.depth)
+	{
+		result = {.normal = {-1.0F, 0.0F}, .depth = push_left};
+	}
+	if (push_down < result.depth)
+	{
+		result = {.normal = {0.0F, 1.0F}, .depth = push_down};
+	}
+	if (push_up < result.depth)
+	{
+		result = {.normal = {0.0F, -1.0F}, .depth = push_up};
+	}
+	return result;
+}
+
+auto sweep(aabb const& box, glm::vec2 displacement) -> aabb
+{
+	return {.min = glm::min(box.min, box.min + displacement),
+	        .max = glm::max(box.max, box.max + displacement)};
+}
+
+auto find_impact(aabb const& box, glm::vec2 displacement, aabb const& obstacle)
+    -> std::optional<impact>
+{
+	auto const x = sweep_axis(
+	    box.min.x, box.max.x, displacement.x, obstacle.min.x, obstacle.max.x);
+	auto const y = sweep_axis(
+	    box.min.y, box.max.y, displacement.y, obstacle.min.y, obstacle.max.y);
+	if (!x || !y)
+	{
+		return std::nullopt;
+	}
+
+	// The boxes overlap once they overlap along both axes, and stop as soon
+	// as they stop along either.
+	auto const entry = std::max(x->entry, y->entry);
+	auto const exit = std::min(x->exit, y->exit);
+	if (entry >= exit || entry < 0.0F || entry > 1.0F)
+	{
+		return std::nullopt;
+	}
+
+	impact result{.time = entry};
+	if (x->entry >= y->entry)
+	{
+		result.normal.x = -sign(displacement.x);
+	}
+	if (y->entry >= x->entry)
+	{
+		result.normal.y = -sign(displacement.y);
+	}
+	return result;
+}
+} // namespace yaboc::physics
@@ -0,0 +1,219 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#include "yaboc/physics/brick_grid.h"
+
+#include "entt/entt.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace yaboc::physics
+{
+namespace
+{
+constexpr std::size_t  bits_per_word{64};
+constexpr auto         no_cell = std::numeric_limits<std::uint32_t>::max();
+constexpr entt::entity no_brick = entt::null;
+
+auto words_for(std::size_t cells) -> std::size_t
+{
+	return (cells + bits_per_word - 1) / bits_per_word;
+}
+
+auto is_set(std::vector<std::uint64_t> const& bits, std::size_t index) -> bool
+{
+	return ((bits[index / bits_per_word] >> (index % bits_per_word)) & 1U) !=
+	       0;
+}
+
+void set(std::vector<std::uint64_t>& bits, std::size_t index)
+{
+	bits[index / bits_per_word] |= std::uint64_t{1} << (index % bits_per_word);
+}
+
+void reset(std::vector<std::uint64_t>& bits, std::size_t index)
+{
+	bits[index / bits_per_word] &=
+	    ~(std::uint64_t{1} << (index % bits_per_word));
+}
+} // namespace
+
+brick_grid::brick_grid(glm::vec2 pitch, glm::vec2 brick_size)
+    : m_pitch{pitch}
+    , m_brick_size{brick_size}
+{
+	assert(pitch.x > 0.0F && pitch.y > 0.0F);
+}
+
+void brick_grid::insert(entt::entity brick, glm::vec2 position)
+{
+	auto const scaled = position / m_pitch;
+	glm::ivec2 const cell{static_cast<int>(std::lround(scaled.x)),
+	                      static_cast<int>(std::lround(scaled.y))};
+	assert(cell.x >= 0 && cell.y >= 0);
+	if (cell.x >= m_columns || cell.y >= m_rows)
+	{
+		grow(cell);
+	}
+
+	erase(brick);
+
+	auto const index = static_cast<std::uint32_t>(cell.y * m_columns + cell.x);
+	if (is_set(m_occupied, index))
+	{
+		erase(m_bricks[index]);
+	}
+
+	set(m_occupied, index);
+	m_bricks[index] = brick;
+
+	auto const entity = entt::to_entity(brick);
+	if (entity >= std::size(m_cells))
+	{
+		m_cells.resize(entity + 1, no_cell);
+	}
+	m_cells[entity] = index;
+	++m_size;
+}
+
+void brick_grid::erase(entt::entity brick)
+{
+	auto const entity = entt::to_entity(brick);
+	if (entity >= std::size(m_cells) || m_cells[entity] == no_cell)
+	{
+		return;
+	}
+
+	auto const index = std::exchange(m_cells[entity], no_cell);
+	reset(m_occupied, index);
+	m_bricks[index] = no_brick;
+	--m_size;
+}
+
+void brick_grid::clear()
+{
+	std::ranges::fill(m_occupied, 0U);
+	std::ranges::fill(m_bricks, no_brick);
+	std::ranges::fill(m_cells, no_cell);
+	m_size = 0;
+}
+
+void brick_grid::grow(glm::ivec2 cell)
+{
+	auto const columns = std::max(m_columns, cell.x + 1);
+	auto const rows = std::max(m_rows, cell.y + 1);
+	auto const cells = static_cast<std::size_t>(columns) *
+	                   static_cast<std::size_t>(rows);
+
+	std::vector<std::uint64_t> occupied(words_for(cells));
+	std::vector<entt::entity>  bricks(cells, no_brick);
+
+	for (auto& index: m_cells)
+	{
+		if (index == no_cell)
+		{
+			continue;
+		}
+
+		auto const x = static_cast<int>(index) % m_columns;
+		auto const y = static_cast<int>(index) / m_columns;
+		auto const moved = static_cast<std::uint32_t>(y * columns + x);
+		set(occupied, moved);
+		bricks[moved] = m_bricks[index];
+		index = moved;
+	}
+
+	m_occupied = std::move(occupied);
+	m_bricks = std::move(bricks);
+	m_columns = columns;
+	m_rows = rows;
+}
+
+auto brick_grid::cell_range(aabb const& box, int axis) const -> glm::ivec2
+{
+	auto const count = axis == 0 ? m_columns : m_rows;
+	auto const pitch = m_pitch[axis];
+	auto const half_size = m_brick_size[axis] / 2.0F;
+
+	// A brick overlaps the box if its centre is strictly within half its size
+	// of the box. Clamped before converting, so far away boxes stay in range.
+	auto const limit = static_cast<float>(count);
+	auto const first = std::clamp(
+	    std::floor((box.min[axis] - half_size) / pitch) + 1.0F, 0.0F, limit);
+	auto const last = std::clamp(
+	    std::ceil((box.max[axis] + half_size) / pitch) - 1.0F,
+	    -1.0F,
+	    limit - 1.0F);
+	return {static_cast<int>(first), static_cast<int>(last)};
+}
+
+void brick_grid::gather(aabb const&                box,
+                        glm::vec2                  offset,
+                        std::vector<entt::entity>& bricks,
+                        aabb_batch&                boxes) const
+{
+	aabb const local{.min = box.min - offset, .max = box.max - offset};
+	auto const columns = cell_range(local, 0);
+	auto const rows = cell_range(local, 1);
+	if (columns.x > columns.y)
+	{
+		return;
+	}
+
+	auto const stride = static_cast<std::size_t>(m_columns);
+
+	for (auto row = rows.x; row <= rows.y; ++row)
+	{
+		auto const begin =
+		    static_cast<std::size_t>(row * m_columns + columns.x);
+		auto const end =
+		    static_cast<std::size_t>(row * m_columns + columns.y) + 1;
+
+		for (auto word = begin / bits_per_word; word * bits_per_word < end;
+		     ++word)
+		{
+			auto bits = m_occupied[word];
+			// Only the cells in [begin, end) of this row.
+			if (word == begin / bits_per_word)
+			{
+				bits &= ~std::uint64_t{} << (begin % bits_per_word);
+			}
+			if ((word + 1) * bits_per_word > end)
+			{
+				bits &= ~std::uint64_t{} >>
+				        (bits_per_word - end % bits_per_word);
+			}
+
+			for (; bits != 0; bits &= bits - 1)
+			{
+				auto const index =
+				    word * bits_per_word +
+				    static_cast<std::size_t>(std::countr_zero(bits));
+				glm::vec2 const cell{static_cast<float>(index % stride),
+				                     static_cast<float>(index / stride)};
+
+				bricks.push_back(m_bricks[index]);
+				boxes.push_back(
+				    make_aabb(cell * m_pitch + offset, m_brick_size));
+			}
+		}
+	}
+}
+} // namespace yaboc::physics
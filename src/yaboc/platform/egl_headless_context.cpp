@@ -0,0 +1,142 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#include "yaboc/platform/egl_headless_context.h"
+
+#include "glad/gl.h"
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include <array>
+#include <format>
+#include <stdexcept>
+#include <string_view>
+
+namespace yaboc::platform
+{
+namespace
+{
+[[noreturn]] void fail(std::string_view what)
+{
+	throw std::runtime_error{
+	    std::format("EGL: {} (error 0x{:x})", what, eglGetError())};
+}
+
+auto get_surfaceless_display() -> EGLDisplay
+{
+	// Core in EGL 1.5, but Mesa also exposes it through the extension.
+	auto const get_platform_display =
+	    reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+	        eglGetProcAddress("eglGetPlatformDisplayEXT"));
+	if (get_platform_display == nullptr)
+	{
+		fail("eglGetPlatformDisplayEXT is not available");
+	}
+
+	auto* display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA,
+	                                     EGL_DEFAULT_DISPLAY,
+	                                     nullptr);
+	if (display == EGL_NO_DISPLAY)
+	{
+		fail("no surfaceless display");
+	}
+	return display;
+}
+
+auto gl_loader(char const* name) -> GLADapiproc
+{
+	return reinterpret_cast<GLADapiproc>(eglGetProcAddress(name));
+}
+} // namespace
+
+egl_headless_context::~egl_headless_context()
+{
+	auto* display = static_cast<EGLDisplay>(m_display);
+	eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+	eglDestroyContext(display, static_cast<EGLContext>(m_context));
+	eglTerminate(display);
+}
+
+egl_headless_context::egl_headless_context(int gl_major, int gl_minor)
+{
+	auto* display = get_surfaceless_display();
+	m_display = display;
+
+	if (eglInitialize(display, nullptr, nullptr) == EGL_FALSE)
+	{
+		fail("eglInitialize failed");
+	}
+
+	if (eglBindAPI(EGL_OPENGL_API) == EGL_FALSE)
+	{
+		fail("desktop OpenGL is not supported");
+	}
+
+	// Nothing is ever drawn to an EGL surface, any GL capable config will do.
+	constexpr std::array config_attributes{
+	    EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+	    EGL_NONE};
+
+	EGLConfig config{};
+	EGLint    num_configs{};
+	if (eglChooseConfig(display,
+	                    std::data(config_attributes),
+	                    &config,
+	                    1,
+	                    &num_configs) == EGL_FALSE ||
+	    num_configs == 0)
+	{
+		// Surfaceless displays may not advertise pbuffer configs.
+		if (eglChooseConfig(display, nullptr, &config, 1, &num_configs) ==
+		        EGL_FALSE ||
+		    num_configs == 0)
+		{
+			fail("no usable config");
+		}
+	}
+
+	std::array const context_attributes{
+	    EGL_CONTEXT_MAJOR_VERSION,
+	    gl_major,
+	    EGL_CONTEXT_MINOR_VERSION,
+	    gl_minor,
+	    EGL_CONTEXT_OPENGL_PROFILE_MASK,
+	    EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+	    EGL_NONE};
+
+	auto* context = eglCreateContext(display,
+	                                 config,
+	                                 EGL_NO_CONTEXT,
+	                                 std::data(context_attributes));
+	if (context == EGL_NO_CONTEXT)
+	{
+		fail(std::format("no OpenGL {}.{} core context", gl_major, gl_minor));
+	}
+	m_context = context;
+
+	// Needs EGL_KHR_surfaceless_context, which every surfaceless display has.
+	if (eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context) ==
+	    EGL_FALSE)
+	{
+		fail("eglMakeCurrent failed");
+	}
+
+	if (gladLoadGL(gl_loader) == 0)
+	{
+		fail("failed to load OpenGL functions");
+	}
+}
+} // namespace yaboc::platform
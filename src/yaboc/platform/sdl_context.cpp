@@ -22,8 +22,9 @@ namespace yaboc::platform
 {
 sdl_context::sdl_context(int gl_major, int gl_minor)
 {
-	// NOLINTNEXTLINE(*-signed-bitwise)
-	SDL_Init(SDL_INIT_EVERYTHING);
+	// Only the window and its events are used. Audio, joysticks and the rest
+	// take a noticeable while to start and are left alone.
+	SDL_Init(SDL_INIT_VIDEO);
 
 	SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK,
 	                    SDL_GL_CONTEXT_PROFILE_CORE);
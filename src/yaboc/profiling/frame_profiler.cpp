@@ -0,0 +1,270 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#include "yaboc/profiling/frame_profiler.h"
+
+#include <algorithm>
+#include <cassert>
+#include <format>
+#include <iterator>
+
+namespace yaboc::profiling
+{
+namespace
+{
+using milliseconds = std::chrono::duration<double, std::milli>;
+
+constexpr auto all_cpu_sections = [] {
+	std::array<cpu_section, cpu_section_count> sections{};
+	for (std::size_t index{}; auto& section: sections)
+	{
+		section = static_cast<cpu_section>(index++);
+	}
+	return sections;
+}();
+
+constexpr auto all_gpu_passes = [] {
+	std::array<gpu_pass, gpu_pass_count> passes{};
+	for (std::size_t index{}; auto& pass: passes)
+	{
+		pass = static_cast<gpu_pass>(index++);
+	}
+	return passes;
+}();
+} // namespace
+
+auto name(cpu_section section) -> std::string_view
+{
+	switch (section)
+	{
+	case cpu_section::frame: return "frame";
+	case cpu_section::update: return "update";
+	case cpu_section::render_submit: return "submit";
+	case cpu_section::count: break;
+	}
+	return "unknown";
+}
+
+auto name(gpu_pass pass) -> std::string_view
+{
+	switch (pass)
+	{
+	case gpu_pass::clear: return "clear";
+	case gpu_pass::sprites: return "sprites";
+	case gpu_pass::hud: return "hud";
+	case gpu_pass::count: break;
+	}
+	return "unknown";
+}
+
+auto summary(frame_timings const& timings) -> std::string
+{
+	std::string line{"cpu"};
+	for (auto const section: all_cpu_sections)
+	{
+		line += std::format(" {} {:.2f}",
+		                    name(section),
+		                    milliseconds{timings[section]}.count());
+	}
+
+	line += " ms | gpu";
+	if (!timings.gpu_valid)
+	{
+		return line + " n/a";
+	}
+
+	for (auto const pass: all_gpu_passes)
+	{
+		line += std::format(" {} {:.2f}",
+		                    name(pass),
+		                    milliseconds{timings[pass]}.count());
+	}
+	return line + " ms";
+}
+
+auto frame_profiler::write_csv(std::filesystem::path const& path) -> bool
+{
+	m_csv.open(path, std::ios::out | std::ios::trunc);
+	if (!m_csv)
+	{
+		return false;
+	}
+
+	m_csv << "frame";
+	for (auto const section: all_cpu_sections)
+	{
+		m_csv << ",cpu_" << name(section) << "_ms";
+	}
+	for (auto const pass: all_gpu_passes)
+	{
+		m_csv << ",gpu_" << name(pass) << "_ms";
+	}
+	m_csv << '\n';
+
+	// Frames already complete are not written.
+	m_csv_written = m_complete_frames;
+	return true;
+}
+
+void frame_profiler::begin_frame()
+{
+	timings(m_frame) = frame_timings{.frame = m_frame};
+
+	if (auto const resolved = m_gpu_timers.begin_frame(m_frame))
+	{
+		store(*resolved);
+	}
+
+	begin(cpu_section::frame);
+}
+
+void frame_profiler::end_frame()
+{
+	end(cpu_section::frame);
+	++m_frame;
+
+	if (m_csv.is_open())
+	{
+		write_csv_rows();
+	}
+}
+
+void frame_profiler::finish()
+{
+	while (auto const resolved = m_gpu_timers.flush())
+	{
+		store(*resolved);
+	}
+
+	if (m_csv.is_open())
+	{
+		write_csv_rows();
+		m_csv.flush();
+	}
+}
+
+void frame_profiler::begin(cpu_section section)
+{
+	m_cpu_started[static_cast<std::size_t>(section)] = clock::now();
+}
+
+void frame_profiler::end(cpu_section section)
+{
+	auto const index = static_cast<std::size_t>(section);
+	timings(m_frame).cpu[index] += clock::now() - m_cpu_started[index];
+}
+
+void frame_profiler::record(cpu_section section, std::chrono::nanoseconds time)
+{
+	timings(m_frame).cpu[static_cast<std::size_t>(section)] += time;
+}
+
+void frame_profiler::begin(gpu_pass pass)
+{
+	m_gpu_timers.begin(static_cast<std::size_t>(pass));
+}
+
+void frame_profiler::end([[maybe_unused]] gpu_pass pass)
+{
+	m_gpu_timers.end();
+}
+
+auto frame_profiler::average(std::size_t frames) const -> frame_timings
+{
+	frames = std::min({frames,
+	                   history_size,
+	                   static_cast<std::size_t>(m_complete_frames)});
+
+	frame_timings mean{};
+	std::size_t   gpu_frames{};
+	for (auto frame = m_complete_frames - frames; frame < m_complete_frames;
+	     ++frame)
+	{
+		auto const& sample = m_history[frame % history_size];
+		for (std::size_t index{}; index < cpu_section_count; ++index)
+		{
+			mean.cpu[index] += sample.cpu[index];
+		}
+
+		if (sample.gpu_valid)
+		{
+			for (std::size_t index{}; index < gpu_pass_count; ++index)
+			{
+				mean.gpu[index] += sample.gpu[index];
+			}
+			++gpu_frames;
+		}
+	}
+
+	if (frames == 0)
+	{
+		return mean;
+	}
+
+	mean.frame = m_complete_frames - 1;
+	for (auto& time: mean.cpu)
+	{
+		time /= frames;
+	}
+
+	mean.gpu_valid = gpu_frames > 0;
+	for (auto& time: mean.gpu)
+	{
+		time /= std::max(gpu_frames, std::size_t{1});
+	}
+	return mean;
+}
+
+void frame_profiler::store(
+    graphics::gpu_timer_queries::resolved_frame const& resolved)
+{
+	auto& frame = timings(resolved.frame);
+	std::ranges::copy(resolved.elapsed, std::begin(frame.gpu));
+	frame.gpu_valid = resolved.available;
+	m_complete_frames = resolved.frame + 1;
+}
+
+void frame_profiler::write_csv_rows()
+{
+	// The history only holds so many frames.
+	m_csv_written = std::max(m_csv_written,
+	                         m_complete_frames -
+	                             std::min<std::uint64_t>(m_complete_frames,
+	                                                     history_size));
+
+	for (; m_csv_written < m_complete_frames; ++m_csv_written)
+	{
+		auto const& sample = timings(m_csv_written);
+
+		m_csv << sample.frame;
+		for (auto const time: sample.cpu)
+		{
+			m_csv << std::format(",{:.4f}", milliseconds{time}.count());
+		}
+		for (auto const time: sample.gpu)
+		{
+			if (sample.gpu_valid)
+			{
+				m_csv << std::format(",{:.4f}", milliseconds{time}.count());
+			}
+			else
+			{
+				m_csv << ',';
+			}
+		}
+		m_csv << '\n';
+	}
+}
+} // namespace yaboc::profiling
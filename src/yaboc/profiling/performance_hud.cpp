@@ -0,0 +1,130 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#include "yaboc/profiling/performance_hud.h"
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+namespace yaboc::profiling
+{
+namespace
+{
+using milliseconds = std::chrono::duration<float, std::milli>;
+
+constexpr milliseconds frame_budget{1'000.0F / 60.0F};
+
+// In metres, within the renderer's default 10 m wide view.
+// NOLINTBEGIN(*-magic-numbers)
+constexpr glm::vec2 panel_origin{6.6F, 0.1F};
+constexpr float     panel_padding{0.1F};
+constexpr float     bar_length{3.0F};
+constexpr float     bar_height{0.12F};
+constexpr float     bar_spacing{0.06F};
+
+constexpr glm::vec4 panel_tint{0.1F, 0.1F, 0.1F, 0.75F};
+constexpr glm::vec4 cpu_tint{0.35F, 0.65F, 1.0F, 0.9F};
+constexpr glm::vec4 gpu_tint{1.0F, 0.6F, 0.25F, 0.9F};
+constexpr glm::vec4 marker_tint{1.0F, 1.0F, 1.0F, 0.9F};
+// NOLINTEND(*-magic-numbers)
+
+constexpr auto num_bars = cpu_section_count + gpu_pass_count;
+
+auto make_renderer_configuration() -> sprite::sprite_renderer::configuration
+{
+	constexpr std::size_t hud_sprites{num_bars + 2};
+
+	sprite::sprite_renderer::configuration config{};
+	config.sprites_per_batch = hud_sprites;
+	config.buffer_size = hud_sprites * config.frames_in_flight *
+	                     sizeof(sprite::sprite_instance);
+	config.gpu_culling = false;
+	return config;
+}
+} // namespace
+
+performance_hud::performance_hud(sprite::sprite_sheet_array const& sheets)
+    : m_renderer{make_renderer_configuration()}
+    , m_sprite_sheets{&sheets}
+    , m_panel{subtexture(sprite::sprite_sheet_frames::id::ui_grey_panel)}
+    , m_bar{subtexture(
+          sprite::sprite_sheet_frames::id::ui_grey_slider_horizontal)}
+    , m_marker{
+          subtexture(sprite::sprite_sheet_frames::id::ui_grey_slider_vertical)}
+{}
+
+void performance_hud::draw(frame_timings const& timings)
+{
+	auto const rows_height =
+	    static_cast<float>(num_bars) * (bar_height + bar_spacing) - bar_spacing;
+	glm::vec2 const panel_size{bar_length + 2 * panel_padding,
+	                           rows_height + 2 * panel_padding};
+
+	m_renderer.begin_batch();
+	m_renderer.use_sprite_sheets(*m_sprite_sheets);
+	m_renderer.use_blend_mode(sprite::blend_mode::alpha);
+
+	m_renderer.submit_sprite(panel_origin + panel_size / 2.0F,
+	                         panel_size,
+	                         panel_tint,
+	                         m_panel);
+
+	auto const left = panel_origin.x + panel_padding;
+	auto       top = panel_origin.y + panel_padding;
+
+	auto submit_bar = [&](std::chrono::nanoseconds time, glm::vec4 tint) {
+		auto const fraction =
+		    std::min(milliseconds{time} / (2.0F * frame_budget), 1.0F);
+		auto const length = fraction * bar_length;
+		if (length > 0.0F)
+		{
+			m_renderer.submit_sprite({left + length / 2.0F,
+			                          top + bar_height / 2.0F},
+			                         {length, bar_height},
+			                         tint,
+			                         m_bar);
+		}
+		top += bar_height + bar_spacing;
+	};
+
+	for (auto const time: timings.cpu)
+	{
+		submit_bar(time, cpu_tint);
+	}
+
+	for (auto const time: timings.gpu)
+	{
+		submit_bar(timings.gpu_valid ? time : std::chrono::nanoseconds{},
+		           gpu_tint);
+	}
+
+	m_renderer.submit_sprite({left + bar_length / 2.0F,
+	                          panel_origin.y + panel_size.y / 2.0F},
+	                         {bar_height / 4.0F, rows_height},
+	                         marker_tint,
+	                         m_marker);
+
+	m_renderer.end_batch();
+}
+
+auto performance_hud::subtexture(sprite::sprite_sheet_frames::id frame) const
+    -> subtexture_bounds
+{
+	auto const& sheet = m_sprite_sheets->sheet(0);
+	auto const& uv = sheet.uv(std::to_underlying(frame));
+	return {uv.min, uv.max, sheet.layer()};
+}
+} // namespace yaboc::profiling
@@ -0,0 +1,130 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#include "yaboc/profiling/startup_timeline.h"
+
+#include <algorithm>
+#include <cassert>
+#include <format>
+#include <iterator>
+#include <utility>
+
+namespace yaboc::profiling
+{
+namespace
+{
+using milliseconds = std::chrono::duration<double, std::milli>;
+
+constexpr std::size_t bar_width{40};
+} // namespace
+
+startup_timeline::startup_timeline(clock::time_point origin)
+    : m_origin{origin}
+    , m_main_thread{std::this_thread::get_id()}
+{}
+
+auto startup_timeline::begin(std::string name) -> std::size_t
+{
+	auto const now = clock::now() - m_origin;
+
+	std::scoped_lock const lock{m_mutex};
+	m_spans.push_back(span{.name = std::move(name),
+	                       .thread = std::this_thread::get_id(),
+	                       .begin = now,
+	                       .end = now});
+	return std::size(m_spans) - 1;
+}
+
+void startup_timeline::end(std::size_t span_id)
+{
+	auto const now = clock::now() - m_origin;
+
+	std::scoped_lock const lock{m_mutex};
+	assert(span_id < std::size(m_spans));
+	m_spans[span_id].end = now;
+}
+
+void startup_timeline::mark(std::string name)
+{
+	[[maybe_unused]] auto const span_id = begin(std::move(name));
+}
+
+auto startup_timeline::spans() const -> std::vector<span>
+{
+	std::vector<span> sorted{};
+	{
+		std::scoped_lock const lock{m_mutex};
+		sorted = m_spans;
+	}
+	std::ranges::stable_sort(sorted, {}, &span::begin);
+	return sorted;
+}
+
+void startup_timeline::write(std::ostream& out) const
+{
+	auto const sorted = spans();
+	if (std::empty(sorted))
+	{
+		return;
+	}
+
+	auto const total = std::ranges::max(sorted, {}, &span::end).end;
+	auto const column = [total](clock::duration time) {
+		if (total == clock::duration::zero())
+		{
+			return std::size_t{};
+		}
+		return static_cast<std::size_t>(time * (bar_width - 1) / total);
+	};
+
+	// Workers are numbered in the order they first show up.
+	std::vector<std::thread::id> workers{};
+	auto const thread_name = [&](std::thread::id thread) -> std::string {
+		if (thread == m_main_thread)
+		{
+			return "main";
+		}
+		auto worker = std::ranges::find(workers, thread);
+		if (worker == std::end(workers))
+		{
+			worker = workers.insert(worker, thread);
+		}
+		return std::format("worker {}",
+		                   std::distance(std::begin(workers), worker));
+	};
+
+	out << std::format("{:<28} {:>9} {:>9} {:<9}\n",
+	                   "startup",
+	                   "begin ms",
+	                   "end ms",
+	                   "thread");
+	for (auto const& entry: sorted)
+	{
+		std::string bar(bar_width, ' ');
+		auto const first = column(entry.begin);
+		auto const last = std::max(first, column(entry.end));
+		std::fill(std::begin(bar) + static_cast<std::ptrdiff_t>(first),
+		          std::begin(bar) + static_cast<std::ptrdiff_t>(last) + 1,
+		          entry.begin == entry.end ? '|' : '#');
+
+		out << std::format("{:<28} {:>9.2f} {:>9.2f} {:<9} {}\n",
+		                   entry.name,
+		                   milliseconds{entry.begin}.count(),
+		                   milliseconds{entry.end}.count(),
+		                   thread_name(entry.thread),
+		                   bar);
+	}
+}
+} // namespace yaboc::profiling
@@ -0,0 +1,212 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#include "yaboc/sprite/dynamic_atlas.h"
+
+#include "glad/gl.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace yaboc::sprite
+{
+namespace
+{
+// The bounds of source with their edge pixels repeated padding times on every
+// side.
+auto extrude(graphics::image const&               source,
+             sprite_frame_data::subtexture_bounds bounds,
+             int                                  padding) -> graphics::image
+{
+	auto const size = bounds.max - bounds.min;
+
+	graphics::image padded{.width = size.x + 2 * padding,
+	                       .height = size.y + 2 * padding};
+	padded.pixels.resize(static_cast<std::size_t>(padded.width) *
+	                     static_cast<std::size_t>(padded.height) *
+	                     graphics::image::channels);
+
+	auto out = std::begin(padded.pixels);
+	for (int y{}; y < padded.height; ++y)
+	{
+		auto const source_y = std::clamp(
+		    bounds.min.y + y - padding, bounds.min.y, bounds.max.y - 1);
+		auto const row = static_cast<std::size_t>(source_y) *
+		                 static_cast<std::size_t>(source.width);
+		for (int x{}; x < padded.width; ++x)
+		{
+			auto const source_x = std::clamp(
+			    bounds.min.x + x - padding, bounds.min.x, bounds.max.x - 1);
+			auto const pixel = (row + static_cast<std::size_t>(source_x)) *
+			                   graphics::image::channels;
+			out = std::copy_n(std::data(source.pixels) + pixel,
+			                  graphics::image::channels,
+			                  out);
+		}
+	}
+	return padded;
+}
+} // namespace
+
+dynamic_atlas::~dynamic_atlas()
+{
+	glDeleteTextures(1, &m_renderer_id);
+}
+
+dynamic_atlas::dynamic_atlas(configuration const& config)
+    : m_page_size{config.page_size}
+    , m_padding{config.padding}
+{
+	assert(config.page_count > 0);
+	assert(config.padding >= 0);
+
+	[[maybe_unused]] int max_layers{};
+	glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &max_layers);
+	assert(config.page_count <= static_cast<std::size_t>(max_layers));
+
+	m_pages.assign(config.page_count, skyline_packer{m_page_size});
+
+	glCreateTextures(GL_TEXTURE_2D_ARRAY, 1, &m_renderer_id);
+
+	glTextureParameteri(m_renderer_id, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTextureParameteri(m_renderer_id, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	// Frames arrive one at a time, so there is no mip chain to keep current.
+	glTextureParameteri(m_renderer_id, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTextureParameteri(m_renderer_id, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	glTextureStorage3D(m_renderer_id,
+	                   1,
+	                   GL_RGBA8,
+	                   m_page_size.x,
+	                   m_page_size.y,
+	                   static_cast<GLsizei>(config.page_count));
+}
+
+dynamic_atlas::dynamic_atlas(dynamic_atlas&& other) noexcept
+    : m_uvs{std::move(other.m_uvs)}
+    , m_layers{std::move(other.m_layers)}
+    , m_frame_data{std::move(other.m_frame_data)}
+    , m_ids{std::move(other.m_ids)}
+    , m_pages{std::move(other.m_pages)}
+    , m_page_size{other.m_page_size}
+    , m_padding{other.m_padding}
+    , m_renderer_id{std::exchange(other.m_renderer_id, 0)}
+{}
+
+auto dynamic_atlas::operator=(dynamic_atlas&& other) noexcept
+    -> dynamic_atlas&
+{
+	if (this != &other)
+	{
+		glDeleteTextures(1, &m_renderer_id);
+
+		m_uvs = std::move(other.m_uvs);
+		m_layers = std::move(other.m_layers);
+		m_frame_data = std::move(other.m_frame_data);
+		m_ids = std::move(other.m_ids);
+		m_pages = std::move(other.m_pages);
+		m_page_size = other.m_page_size;
+		m_padding = other.m_padding;
+		m_renderer_id = std::exchange(other.m_renderer_id, 0);
+	}
+	return *this;
+}
+
+auto dynamic_atlas::add(std::string name, graphics::image const& picture)
+    -> std::size_t
+{
+	glm::ivec2 const size{picture.width, picture.height};
+	return add_frame(std::move(name), picture, {.max = size}, size);
+}
+
+auto dynamic_atlas::add_sheet(sprite_sheet const&    sheet,
+                              graphics::image const& picture) -> std::size_t
+{
+	assert(glm::ivec2(picture.width, picture.height) ==
+	       sheet.meta_data().dimensions);
+
+	auto const first = frame_count();
+	for (std::size_t id{}; id < sheet.frame_count(); ++id)
+	{
+		auto const& frame = sheet.frame_data(id);
+		add_frame(std::string{frame.name}, picture, frame.bounds, frame.size);
+	}
+	return first;
+}
+
+auto dynamic_atlas::find(std::string_view name) const
+    -> std::optional<std::size_t>
+{
+	if (auto const found = m_ids.find(name); found != std::end(m_ids))
+	{
+		return found->second;
+	}
+	return std::nullopt;
+}
+
+auto dynamic_atlas::add_frame(std::string&&                        name,
+                              graphics::image const&               source,
+                              sprite_frame_data::subtexture_bounds bounds,
+                              glm::ivec2 size) -> std::size_t
+{
+	if (m_ids.contains(name))
+	{
+		throw std::invalid_argument{"atlas already has " + name};
+	}
+
+	auto const padded = extrude(source, bounds, m_padding);
+
+	// First fit over the pages, so earlier pages fill up before later ones
+	// are touched.
+	std::optional<glm::ivec2> position{};
+	unsigned int              layer{};
+	for (; layer < std::size(m_pages) && !position; ++layer)
+	{
+		position = m_pages[layer].insert({padded.width, padded.height});
+	}
+	if (!position)
+	{
+		throw std::runtime_error{"atlas has no room for " + name};
+	}
+	--layer;
+
+	glTextureSubImage3D(m_renderer_id,
+	                    0,
+	                    position->x,
+	                    position->y,
+	                    static_cast<GLint>(layer),
+	                    padded.width,
+	                    padded.height,
+	                    1,
+	                    GL_RGBA,
+	                    GL_UNSIGNED_BYTE,
+	                    std::data(padded.pixels));
+
+	auto const min = *position + glm::ivec2{m_padding};
+	auto const max = min + (bounds.max - bounds.min);
+	auto const page_size = glm::vec2{m_page_size};
+
+	auto const id = frame_count();
+	m_uvs.push_back(
+	    {.min = glm::vec2{min} / page_size, .max = glm::vec2{max} / page_size});
+	m_layers.push_back(layer);
+	m_ids.emplace(name, id);
+	m_frame_data.push_back(sprite_frame_data{.name = std::move(name),
+	                                         .bounds = {.min = min, .max = max},
+	                                         .size = size});
+	return id;
+}
+} // namespace yaboc::sprite
@@ -0,0 +1,182 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#include "yaboc/sprite/quad_expansion.h"
+
+#include <array>
+#include <cstring>
+
+#if defined(YABOC_QUAD_EXPANSION_X86) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace yaboc::sprite
+{
+namespace
+{
+#if defined(YABOC_QUAD_EXPANSION_X86)
+auto cpu_supports_avx2() -> bool
+{
+#if defined(_MSC_VER)
+	constexpr int avx2_bit{1 << 5};
+	constexpr int osxsave_bit{1 << 27};
+	constexpr int avx_bit{1 << 28};
+	constexpr unsigned ymm_state{0x6};
+
+	std::array<int, 4> registers{};
+	__cpuid(registers.data(), 1);
+	if ((registers[2] & (osxsave_bit | avx_bit)) != (osxsave_bit | avx_bit) ||
+	    (_xgetbv(0) & ymm_state) != ymm_state)
+	{
+		return false;
+	}
+
+	__cpuidex(registers.data(), 7, 0);
+	return (registers[1] & avx2_bit) != 0;
+#else
+	return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+#endif
+
+template <class T>
+void write_record(std::span<std::byte> destination,
+                  std::size_t          index,
+                  T const&             record)
+{
+	assert((index + 1) * sizeof(T) <= std::size(destination));
+	std::memcpy(std::data(destination) + index * sizeof(T),
+	            &record,
+	            sizeof(T));
+}
+
+template <class Instance>
+void expand_instances(sprite_batch_input const& sprites,
+                      float                     pixels_per_metre,
+                      std::span<std::byte>      destination)
+{
+	for (std::size_t i{}; i < sprites.size(); ++i)
+	{
+		glm::vec2 position{sprites.x[i], sprites.y[i]};
+		glm::vec2 size{sprites.width[i], sprites.height[i]};
+
+		position *= pixels_per_metre;
+		size *= pixels_per_metre;
+		size /= 2.0F;
+
+		Instance instance{.centre = position, .half_size = size};
+		set_attributes(instance,
+		               sprites.tint[i],
+		               sprites.uv_bounds[i],
+		               sprites.layer[i]);
+
+		write_record(destination, i, instance);
+	}
+}
+
+template <class Vertex>
+void expand_vertices(sprite_batch_input const& sprites,
+                     float                     pixels_per_metre,
+                     std::span<std::byte>      destination)
+{
+	constexpr std::size_t verts_per_quad{6};
+
+	for (std::size_t i{}; i < sprites.size(); ++i)
+	{
+		glm::vec2 position{sprites.x[i], sprites.y[i]};
+		glm::vec2 size{sprites.width[i], sprites.height[i]};
+
+		position *= pixels_per_metre;
+		size *= pixels_per_metre;
+		size /= 2.0F;
+
+		glm::vec2 const min_pos{position - size};
+		glm::vec2 const max_pos{position + size};
+
+		auto const& uv = sprites.uv_bounds[i];
+		auto const  tint = sprites.tint[i];
+		auto const  layer = sprites.layer[i];
+
+		auto corner = [tint, layer](glm::vec2 pos, glm::vec2 texture_coord) {
+			Vertex vertex{};
+			set_vertex(vertex, pos, tint, texture_coord, layer);
+			return vertex;
+		};
+
+		auto const top_left = corner(min_pos, {uv.x, uv.y});
+		auto const top_right = corner({max_pos.x, min_pos.y}, {uv.z, uv.y});
+		auto const bottom_left = corner({min_pos.x, max_pos.y}, {uv.x, uv.w});
+		auto const bottom_right = corner(max_pos, {uv.z, uv.w});
+
+		auto const quad = std::array{bottom_left,
+		                             top_right,
+		                             top_left,
+		                             bottom_left,
+		                             bottom_right,
+		                             top_right};
+		for (std::size_t vertex{}; vertex < verts_per_quad; ++vertex)
+		{
+			write_record(destination,
+			             i * verts_per_quad + vertex,
+			             quad[vertex]);
+		}
+	}
+}
+} // namespace
+
+namespace kernels
+{
+auto scalar(vertex_format format) -> quad_expansion_kernels
+{
+	if (format == vertex_format::compact)
+	{
+		return {.level = simd_level::scalar,
+		        .instances = expand_instances<compact_sprite_instance>,
+		        .vertices = expand_vertices<compact_sprite_vertex>};
+	}
+
+	return {.level = simd_level::scalar,
+	        .instances = expand_instances<sprite_instance>,
+	        .vertices = expand_vertices<sprite_vertex>};
+}
+} // namespace kernels
+
+auto detect_simd_level() -> simd_level
+{
+#if defined(YABOC_QUAD_EXPANSION_X86)
+	// SSE2 is part of x86-64.
+	return cpu_supports_avx2() ? simd_level::avx2 : simd_level::sse2;
+#else
+	return simd_level::scalar;
+#endif
+}
+
+auto select_quad_expansion_kernels(simd_level level, vertex_format format)
+    -> quad_expansion_kernels
+{
+#if defined(YABOC_QUAD_EXPANSION_X86)
+	switch (level)
+	{
+	case simd_level::avx2: return kernels::avx2(format);
+	case simd_level::sse2: return kernels::sse2(format);
+	case simd_level::scalar: break;
+	}
+#else
+	static_cast<void>(level);
+#endif
+
+	return kernels::scalar(format);
+}
+} // namespace yaboc::sprite
@@ -0,0 +1,219 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#include "yaboc/sprite/quad_expansion.h"
+
+#if defined(YABOC_QUAD_EXPANSION_X86)
+
+#include <emmintrin.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <type_traits>
+
+namespace yaboc::sprite::kernels
+{
+namespace
+{
+constexpr std::size_t block_size{4};
+constexpr std::size_t stream_alignment{16};
+constexpr std::size_t verts_per_quad{6};
+
+// The destination of a block need not be aligned, so its ends go through
+// ordinary stores and the aligned middle is streamed past the cache.
+void stream_copy(std::byte*       destination,
+                 std::byte const* source,
+                 std::size_t      size)
+{
+	auto const misalignment =
+	    reinterpret_cast<std::uintptr_t>(destination) % stream_alignment;
+	auto const head =
+	    std::min(size, (stream_alignment - misalignment) % stream_alignment);
+
+	std::memcpy(destination, source, head);
+	destination += head;
+	source += head;
+	size -= head;
+
+	for (; size >= stream_alignment; size -= stream_alignment)
+	{
+		_mm_stream_si128(
+		    reinterpret_cast<__m128i*>(destination),
+		    _mm_loadu_si128(reinterpret_cast<__m128i const*>(source)));
+		destination += stream_alignment;
+		source += stream_alignment;
+	}
+
+	std::memcpy(destination, source, size);
+}
+
+template <class Record>
+auto scalar_kernels()
+{
+	constexpr auto compact = std::is_same_v<Record, compact_sprite_instance> ||
+	                         std::is_same_v<Record, compact_sprite_vertex>;
+	return scalar(compact ? vertex_format::compact : vertex_format::full);
+}
+
+template <class Instance>
+void expand_instances(sprite_batch_input const& sprites,
+                      float                     pixels_per_metre,
+                      std::span<std::byte>      destination)
+{
+	auto const count = sprites.size();
+	auto const blocked = count - count % block_size;
+	assert(count * sizeof(Instance) <= std::size(destination));
+
+	auto const scale = _mm_set1_ps(pixels_per_metre);
+	auto const two = _mm_set1_ps(2.0F);
+
+	alignas(stream_alignment) std::array<Instance, block_size> staging{};
+
+	for (std::size_t i{}; i < blocked; i += block_size)
+	{
+		auto centre_x = _mm_mul_ps(_mm_loadu_ps(&sprites.x[i]), scale);
+		auto centre_y = _mm_mul_ps(_mm_loadu_ps(&sprites.y[i]), scale);
+		auto half_width =
+		    _mm_div_ps(_mm_mul_ps(_mm_loadu_ps(&sprites.width[i]), scale),
+		               two);
+		auto half_height =
+		    _mm_div_ps(_mm_mul_ps(_mm_loadu_ps(&sprites.height[i]), scale),
+		               two);
+
+		// One register per sprite: centre.xy, half_size.xy.
+		_MM_TRANSPOSE4_PS(centre_x, centre_y, half_width, half_height);
+		std::array const geometry{centre_x, centre_y, half_width, half_height};
+
+		for (std::size_t lane{}; lane < block_size; ++lane)
+		{
+			auto& instance = staging[lane];
+			_mm_storeu_ps(reinterpret_cast<float*>(&instance), geometry[lane]);
+			set_attributes(instance,
+			               sprites.tint[i + lane],
+			               sprites.uv_bounds[i + lane],
+			               sprites.layer[i + lane]);
+		}
+
+		stream_copy(std::data(destination) + i * sizeof(Instance),
+		            reinterpret_cast<std::byte const*>(std::data(staging)),
+		            sizeof(staging));
+	}
+
+	auto const tail = sprites.subspan(blocked, count - blocked);
+	scalar_kernels<Instance>().instances(
+	    tail,
+	    pixels_per_metre,
+	    destination.subspan(blocked * sizeof(Instance)));
+
+	_mm_sfence();
+}
+
+template <class Vertex>
+void expand_vertices(sprite_batch_input const& sprites,
+                     float                     pixels_per_metre,
+                     std::span<std::byte>      destination)
+{
+	constexpr auto bytes_per_quad = sizeof(Vertex) * verts_per_quad;
+
+	auto const count = sprites.size();
+	auto const blocked = count - count % block_size;
+	assert(count * bytes_per_quad <= std::size(destination));
+
+	auto const scale = _mm_set1_ps(pixels_per_metre);
+	auto const two = _mm_set1_ps(2.0F);
+
+	alignas(stream_alignment) std::array<float, block_size> min_x{};
+	alignas(stream_alignment) std::array<float, block_size> min_y{};
+	alignas(stream_alignment) std::array<float, block_size> max_x{};
+	alignas(stream_alignment) std::array<float, block_size> max_y{};
+
+	alignas(stream_alignment)
+	    std::array<Vertex, verts_per_quad * block_size> staging{};
+
+	for (std::size_t i{}; i < blocked; i += block_size)
+	{
+		auto const x = _mm_mul_ps(_mm_loadu_ps(&sprites.x[i]), scale);
+		auto const y = _mm_mul_ps(_mm_loadu_ps(&sprites.y[i]), scale);
+		auto const half_width =
+		    _mm_div_ps(_mm_mul_ps(_mm_loadu_ps(&sprites.width[i]), scale),
+		               two);
+		auto const half_height =
+		    _mm_div_ps(_mm_mul_ps(_mm_loadu_ps(&sprites.height[i]), scale),
+		               two);
+
+		_mm_store_ps(std::data(min_x), _mm_sub_ps(x, half_width));
+		_mm_store_ps(std::data(min_y), _mm_sub_ps(y, half_height));
+		_mm_store_ps(std::data(max_x), _mm_add_ps(x, half_width));
+		_mm_store_ps(std::data(max_y), _mm_add_ps(y, half_height));
+
+		for (std::size_t lane{}; lane < block_size; ++lane)
+		{
+			auto const& uv = sprites.uv_bounds[i + lane];
+			auto const  tint = sprites.tint[i + lane];
+			auto const  layer = sprites.layer[i + lane];
+
+			glm::vec2 const min_pos{min_x[lane], min_y[lane]};
+			glm::vec2 const max_pos{max_x[lane], max_y[lane]};
+
+			// Same winding as the scalar path: BL, TR, TL, BL, BR, TR.
+			auto* quad = std::data(staging) + lane * verts_per_quad;
+			set_vertex(quad[0],
+			           {min_pos.x, max_pos.y},
+			           tint,
+			           {uv.x, uv.w},
+			           layer);
+			set_vertex(quad[1],
+			           {max_pos.x, min_pos.y},
+			           tint,
+			           {uv.z, uv.y},
+			           layer);
+			set_vertex(quad[2], min_pos, tint, {uv.x, uv.y}, layer);
+			quad[3] = quad[0];
+			set_vertex(quad[4], max_pos, tint, {uv.z, uv.w}, layer);
+			quad[5] = quad[1];
+		}
+
+		stream_copy(std::data(destination) + i * bytes_per_quad,
+		            reinterpret_cast<std::byte const*>(std::data(staging)),
+		            sizeof(staging));
+	}
+
+	auto const tail = sprites.subspan(blocked, count - blocked);
+	scalar_kernels<Vertex>().vertices(
+	    tail,
+	    pixels_per_metre,
+	    destination.subspan(blocked * bytes_per_quad));
+
+	_mm_sfence();
+}
+} // namespace
+
+auto sse2(vertex_format format) -> quad_expansion_kernels
+{
+	if (format == vertex_format::compact)
+	{
+		return {.level = simd_level::sse2,
+		        .instances = expand_instances<compact_sprite_instance>,
+		        .vertices = expand_vertices<compact_sprite_vertex>};
+	}
+
+	return {.level = simd_level::sse2,
+	        .instances = expand_instances<sprite_instance>,
+	        .vertices = expand_vertices<sprite_vertex>};
+}
+} // namespace yaboc::sprite::kernels
+
+#endif // YABOC_QUAD_EXPANSION_X86
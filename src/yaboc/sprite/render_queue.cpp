@@ -0,0 +1,190 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#include "yaboc/sprite/render_queue.h"
+
+#include "yaboc/core/thread_pool.h"
+#include "yaboc/sprite/sprite_sheet_array.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <utility>
+
+namespace yaboc::sprite
+{
+namespace
+{
+// Below this, handing the run to the workers costs more than it saves.
+constexpr std::size_t parallel_run_threshold{4'096};
+constexpr std::size_t parallel_grain{1'024};
+} // namespace
+
+auto render_queue::register_sheets(sprite_sheet_array const& sheets)
+    -> std::uint16_t
+{
+	auto const existing = std::ranges::find(m_sheets, &sheets);
+	if (existing != std::end(m_sheets))
+	{
+		return static_cast<std::uint16_t>(
+		    std::distance(std::begin(m_sheets), existing));
+	}
+
+	assert(std::size(m_sheets) < std::numeric_limits<std::uint16_t>::max());
+	m_sheets.push_back(&sheets);
+	return static_cast<std::uint16_t>(std::size(m_sheets) - 1);
+}
+
+void render_queue::submit(sort_key                           key,
+                          glm::vec2                          position,
+                          glm::vec2                          size,
+                          glm::vec4                          tint,
+                          sprite_renderer::subtexture_bounds uv_bounds)
+{
+	assert(key.sheet < std::size(m_sheets));
+
+	m_sort_entries.push_back(
+	    {.key = key.packed(),
+	     .index = static_cast<std::uint32_t>(std::size(m_commands))});
+	m_commands.push_back({.position = position,
+	                      .size = size,
+	                      .tint = tint,
+	                      .uv_bounds = uv_bounds});
+}
+
+void render_queue::sorted_sprites::resize(std::size_t count)
+{
+	x.resize(count);
+	y.resize(count);
+	width.resize(count);
+	height.resize(count);
+	uv_bounds.resize(count);
+	tint.resize(count);
+	layer.resize(count);
+}
+
+void render_queue::sorted_sprites::write(std::size_t    index,
+                                         command const& sprite)
+{
+	x[index] = sprite.position.x;
+	y[index] = sprite.position.y;
+	width[index] = sprite.size.x;
+	height[index] = sprite.size.y;
+	uv_bounds[index] = {sprite.uv_bounds.min, sprite.uv_bounds.max};
+	tint[index] = sprite.tint;
+	layer[index] = sprite.uv_bounds.layer;
+}
+
+auto render_queue::sorted_sprites::input(std::size_t offset,
+                                         std::size_t count) const
+    -> sprite_batch_input
+{
+	return sprite_batch_input{.x = x,
+	                          .y = y,
+	                          .width = width,
+	                          .height = height,
+	                          .uv_bounds = uv_bounds,
+	                          .tint = tint,
+	                          .layer = layer}
+	    .subspan(offset, count);
+}
+
+void render_queue::emit(sprite_renderer& renderer, core::thread_pool* workers)
+{
+	radix_sort(m_sort_entries, m_sort_scratch);
+	m_sorted.resize(std::size(m_sort_entries));
+
+	// Force the first run to set both sheet and blend mode.
+	auto previous_key = ~std::uint64_t{};
+
+	auto const  entries = std::span{std::as_const(m_sort_entries)};
+	std::size_t run_begin{};
+
+	while (run_begin != std::size(entries))
+	{
+		auto const key = entries[run_begin].key;
+		auto const run_end =
+		    run_begin + state_run_length(entries.subspan(run_begin));
+
+		auto const changed = key ^ previous_key;
+
+		if ((changed & sort_key::sheet_mask) != 0)
+		{
+			auto const sheet =
+			    (key & sort_key::sheet_mask) >> sort_key::sheet_shift;
+			renderer.use_sprite_sheets(*m_sheets[sheet]);
+		}
+
+		if ((changed & sort_key::blend_mask) != 0)
+		{
+			auto const blend =
+			    (key & sort_key::blend_mask) >> sort_key::blend_shift;
+			renderer.use_blend_mode(static_cast<blend_mode>(blend));
+		}
+
+		emit_run(renderer, run_begin, run_end, workers);
+
+		previous_key = key;
+		run_begin = run_end;
+	}
+
+	clear();
+}
+
+void render_queue::gather(std::size_t begin, std::size_t end)
+{
+	for (auto i = begin; i < end; ++i)
+	{
+		m_sorted.write(i, m_commands[m_sort_entries[i].index]);
+	}
+}
+
+void render_queue::emit_run(sprite_renderer&   renderer,
+                            std::size_t        begin,
+                            std::size_t        end,
+                            core::thread_pool* workers)
+{
+	auto const count = end - begin;
+	if (workers == nullptr || count < parallel_run_threshold)
+	{
+		gather(begin, end);
+		renderer.submit_sprites(m_sorted.input(begin, count));
+		return;
+	}
+
+	// Claimed up front so every sprite keeps its place in the sorted order.
+	auto       submission = renderer.begin_parallel_submission(count);
+	auto const first_slot = submission.claim(count);
+
+	workers->parallel_for(
+	    count,
+	    parallel_grain,
+	    [this, begin, first_slot, &submission](std::size_t chunk_begin,
+	                                           std::size_t chunk_end) {
+		    gather(begin + chunk_begin, begin + chunk_end);
+		    submission.write(
+		        first_slot + chunk_begin,
+		        m_sorted.input(begin + chunk_begin, chunk_end - chunk_begin));
+	    });
+
+	renderer.end_parallel_submission(submission);
+}
+
+void render_queue::clear()
+{
+	m_commands.clear();
+	m_sort_entries.clear();
+}
+} // namespace yaboc::sprite
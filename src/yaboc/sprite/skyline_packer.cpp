@@ -0,0 +1,150 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#include "yaboc/sprite/skyline_packer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <limits>
+
+namespace yaboc::sprite
+{
+namespace
+{
+constexpr auto offset(std::size_t index) -> std::ptrdiff_t
+{
+	return static_cast<std::ptrdiff_t>(index);
+}
+} // namespace
+
+skyline_packer::skyline_packer(glm::ivec2 dimensions)
+    : m_dimensions{dimensions}
+{
+	assert(dimensions.x > 0 && dimensions.y > 0);
+	clear();
+}
+
+auto skyline_packer::insert(glm::ivec2 size) -> std::optional<glm::ivec2>
+{
+	if (size.x <= 0 || size.y <= 0)
+	{
+		return std::nullopt;
+	}
+
+	auto best_index = std::size(m_skyline);
+	auto best_top = std::numeric_limits<int>::max();
+	auto best_width = std::numeric_limits<int>::max();
+
+	glm::ivec2 best_position{};
+
+	for (std::size_t index{}; index < std::size(m_skyline); ++index)
+	{
+		auto const height = resting_height(index, size);
+		if (!height)
+		{
+			continue;
+		}
+
+		auto const top = *height + size.y;
+		auto const width = m_skyline[index].width;
+		if (top < best_top || (top == best_top && width < best_width))
+		{
+			best_index = index;
+			best_top = top;
+			best_width = width;
+			best_position = {m_skyline[index].x, *height};
+		}
+	}
+
+	if (best_index == std::size(m_skyline))
+	{
+		return std::nullopt;
+	}
+
+	raise(best_index, best_position, size);
+	m_used_area += static_cast<std::int64_t>(size.x) * size.y;
+	return best_position;
+}
+
+void skyline_packer::clear()
+{
+	m_skyline.assign(1, {.x = 0, .y = 0, .width = m_dimensions.x});
+	m_used_area = 0;
+}
+
+auto skyline_packer::resting_height(std::size_t index, glm::ivec2 size) const
+    -> std::optional<int>
+{
+	if (m_skyline[index].x + size.x > m_dimensions.x)
+	{
+		return std::nullopt;
+	}
+
+	// The rectangle rests on the highest segment beneath it.
+	auto height = 0;
+	auto width_left = size.x;
+	for (; width_left > 0; ++index)
+	{
+		assert(index < std::size(m_skyline));
+		height = std::max(height, m_skyline[index].y);
+		if (height + size.y > m_dimensions.y)
+		{
+			return std::nullopt;
+		}
+		width_left -= m_skyline[index].width;
+	}
+	return height;
+}
+
+void skyline_packer::raise(std::size_t index,
+                           glm::ivec2  position,
+                           glm::ivec2  size)
+{
+	auto const begin = std::begin(m_skyline) + offset(index);
+	m_skyline.insert(
+	    begin,
+	    {.x = position.x, .y = position.y + size.y, .width = size.x});
+
+	// Trim the segments the new one now covers.
+	auto const right = position.x + size.x;
+	auto next = index + 1;
+	while (next < std::size(m_skyline) && m_skyline[next].x < right)
+	{
+		auto& covered = m_skyline[next];
+		auto const overlap = right - covered.x;
+		if (overlap < covered.width)
+		{
+			covered.x += overlap;
+			covered.width -= overlap;
+			break;
+		}
+		m_skyline.erase(std::begin(m_skyline) + offset(next));
+	}
+
+	// Neighbours at the same height are one segment.
+	for (std::size_t at{1}; at < std::size(m_skyline);)
+	{
+		auto& previous = m_skyline[at - 1];
+		if (previous.y == m_skyline[at].y)
+		{
+			previous.width += m_skyline[at].width;
+			m_skyline.erase(std::begin(m_skyline) + offset(at));
+			continue;
+		}
+		++at;
+	}
+}
+} // namespace yaboc::sprite
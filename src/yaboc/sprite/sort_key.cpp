@@ -0,0 +1,101 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#include "yaboc/sprite/sort_key.h"
+
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <utility>
+
+namespace yaboc::sprite
+{
+namespace
+{
+constexpr std::size_t radix_bits{8};
+constexpr std::size_t radix_buckets{std::size_t{1} << radix_bits};
+constexpr std::size_t radix_passes{sizeof(std::uint64_t) * 8 / radix_bits};
+
+constexpr auto digit(std::uint64_t key, std::size_t pass) -> std::size_t
+{
+	return static_cast<std::size_t>(key >> (pass * radix_bits)) &
+	       (radix_buckets - 1);
+}
+} // namespace
+
+// LSD radix sort on 8-bit digits. All histograms are built in one pass, and
+// passes where every key shares the same digit (unused layers, a single
+// sheet...) are skipped, so a typical frame only pays for the depth bytes.
+void radix_sort(std::vector<sort_entry>& entries,
+                std::vector<sort_entry>& scratch)
+{
+	auto const count = std::size(entries);
+	if (count < 2)
+	{
+		return;
+	}
+
+	std::array<std::array<std::size_t, radix_buckets>, radix_passes>
+	    histograms{};
+	for (auto const& entry: entries)
+	{
+		for (std::size_t pass{}; pass < radix_passes; ++pass)
+		{
+			++histograms[pass][digit(entry.key, pass)];
+		}
+	}
+
+	scratch.resize(count);
+
+	for (std::size_t pass{}; pass < radix_passes; ++pass)
+	{
+		auto& histogram = histograms[pass];
+		if (std::ranges::find(histogram, count) != std::end(histogram))
+		{
+			continue;
+		}
+
+		std::size_t offset{};
+		for (auto& bucket: histogram)
+		{
+			offset += std::exchange(bucket, offset);
+		}
+
+		for (auto const& entry: entries)
+		{
+			scratch[histogram[digit(entry.key, pass)]++] = entry;
+		}
+
+		std::swap(entries, scratch);
+	}
+}
+
+auto state_run_length(std::span<sort_entry const> entries) -> std::size_t
+{
+	if (entries.empty())
+	{
+		return 0;
+	}
+
+	auto const key = entries.front().key;
+	auto const run_end =
+	    std::ranges::find_if(entries, [key](auto const& entry) {
+		    return ((entry.key ^ key) & sort_key::state_mask) != 0;
+	    });
+
+	return static_cast<std::size_t>(
+	    std::distance(std::begin(entries), run_end));
+}
+} // namespace yaboc::sprite
@@ -0,0 +1,181 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#include "yaboc/sprite/sprite_culler.h"
+
+#include "yaboc/graphics/shader.h"
+#include "yaboc/sprite/static_sprite_batch.h"
+
+#include "glad/gl.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace yaboc::sprite
+{
+namespace
+{
+// Must match local_size_x in sprite_cull.comp.glsl.
+constexpr std::size_t cull_group_size{64};
+
+constexpr GLuint quad_vertices{6};
+
+auto shader_inputs() -> std::vector<yaboc::shader_builder_input>
+{
+	return {
+	    {.type = yaboc::shader_builder_input::shader_type::compute,
+	     .path = "assets/shaders/sprite_cull.comp.glsl"}
+    };
+}
+
+constexpr auto words(std::size_t bytes)
+{
+	assert(bytes % sizeof(GLuint) == 0);
+	return static_cast<GLuint>(bytes / sizeof(GLuint));
+}
+} // namespace
+
+void sprite_culler::prepare_shader()
+{
+	yaboc::prepare_shader(shader_inputs());
+}
+
+sprite_culler::~sprite_culler()
+{
+	glDeleteBuffers(1, &m_indirect_buffer);
+	glDeleteBuffers(1, &m_visible_sprites);
+	glDeleteProgram(m_program);
+}
+
+sprite_culler::sprite_culler(sprite_layout layout)
+    : m_layout{layout}
+{
+	m_program = yaboc::make_shader(shader_inputs());
+
+	glProgramUniform1ui(m_program,
+	                    glGetUniformLocation(m_program, "words_per_sprite"),
+	                    words(m_layout.bytes_per_sprite));
+	glProgramUniform1ui(m_program,
+	                    glGetUniformLocation(m_program, "vertex_words"),
+	                    words(m_layout.bytes_per_vertex));
+	glProgramUniform1i(m_program,
+	                   glGetUniformLocation(m_program, "instanced"),
+	                   m_layout.instanced ? GL_TRUE : GL_FALSE);
+
+	m_sprite_count_location = glGetUniformLocation(m_program, "sprite_count");
+	m_view_min_location = glGetUniformLocation(m_program, "view_min");
+	m_view_max_location = glGetUniformLocation(m_program, "view_max");
+
+	glCreateBuffers(1, &m_indirect_buffer);
+	glNamedBufferStorage(m_indirect_buffer,
+	                     sizeof(std::array<GLuint, 4>),
+	                     nullptr,
+	                     GL_DYNAMIC_STORAGE_BIT);
+}
+
+sprite_culler::sprite_culler(sprite_culler&& other) noexcept
+    : m_program{std::exchange(other.m_program, 0)}
+    , m_visible_sprites{std::exchange(other.m_visible_sprites, 0)}
+    , m_capacity{std::exchange(other.m_capacity, 0)}
+    , m_indirect_buffer{std::exchange(other.m_indirect_buffer, 0)}
+    , m_layout{other.m_layout}
+    , m_sprite_count_location{other.m_sprite_count_location}
+    , m_view_min_location{other.m_view_min_location}
+    , m_view_max_location{other.m_view_max_location}
+{}
+
+auto sprite_culler::operator=(sprite_culler&& other) noexcept -> sprite_culler&
+{
+	if (this != &other)
+	{
+		glDeleteBuffers(1, &m_indirect_buffer);
+		glDeleteBuffers(1, &m_visible_sprites);
+		glDeleteProgram(m_program);
+
+		m_program = std::exchange(other.m_program, 0);
+		m_visible_sprites = std::exchange(other.m_visible_sprites, 0);
+		m_capacity = std::exchange(other.m_capacity, 0);
+		m_indirect_buffer = std::exchange(other.m_indirect_buffer, 0);
+		m_layout = other.m_layout;
+		m_sprite_count_location = other.m_sprite_count_location;
+		m_view_min_location = other.m_view_min_location;
+		m_view_max_location = other.m_view_max_location;
+	}
+	return *this;
+}
+
+void sprite_culler::cull(static_sprite_batch const& batch,
+                         glm::vec2                  view_min,
+                         glm::vec2                  view_max)
+{
+	auto const sprite_count = batch.size();
+	assert(sprite_count <= std::numeric_limits<GLuint>::max());
+
+	reserve(sprite_count);
+
+	// Instances are counted in instance_count, expanded quads in count.
+	auto const reset = m_layout.instanced
+	                     ? std::array<GLuint, 4>{quad_vertices, 0, 0, 0}
+	                     : std::array<GLuint, 4>{0, 1, 0, 0};
+	glNamedBufferSubData(m_indirect_buffer,
+	                     0,
+	                     sizeof(reset),
+	                     std::data(reset));
+
+	glUseProgram(m_program);
+	glUniform1ui(m_sprite_count_location, static_cast<GLuint>(sprite_count));
+	glUniform2f(m_view_min_location, view_min.x, view_min.y);
+	glUniform2f(m_view_max_location, view_max.x, view_max.y);
+
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, batch.buffer_id());
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, m_visible_sprites);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, m_indirect_buffer);
+
+	auto const groups = (sprite_count + cull_group_size - 1) / cull_group_size;
+	glDispatchCompute(static_cast<GLuint>(groups), 1, 1);
+
+	// The survivors are read as vertex attributes and the count as draw
+	// arguments.
+	glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT |
+	                GL_COMMAND_BARRIER_BIT);
+
+	glUseProgram(0);
+}
+
+void sprite_culler::reserve(std::size_t sprite_count)
+{
+	if (sprite_count <= m_capacity)
+	{
+		return;
+	}
+
+	glDeleteBuffers(1, &m_visible_sprites);
+
+	m_capacity = std::max(sprite_count, m_capacity * 2);
+	auto const buffer_size = m_capacity * m_layout.bytes_per_sprite;
+	assert(buffer_size < std::numeric_limits<GLsizeiptr>::max());
+
+	// Only ever written and read by the GPU.
+	glCreateBuffers(1, &m_visible_sprites);
+	glNamedBufferStorage(m_visible_sprites,
+	                     static_cast<GLsizeiptr>(buffer_size),
+	                     nullptr,
+	                     0);
+}
+} // namespace yaboc::sprite
@@ -20,9 +20,11 @@
 #include "glad/gl.h"
 #include "glm/gtc/type_ptr.hpp"
 
-#include <chrono>
+#include <algorithm>
+#include <array>
 #include <limits>
 #include <span>
+#include <vector>
 #include <cassert>
 
 static_assert(sizeof(glm::vec2) == (sizeof(float) * 2));
@@ -58,83 +60,224 @@ auto map_as(unsigned int id, std::size_t size)
 	return std::span<T>(static_cast<T*>(buf), size / sizeof(T));
 }
 
-constexpr auto verts_per_quad = 6;
+template <class Command>
+void draw_direct(Command const& command)
+{
+	glDrawArraysInstancedBaseInstance(
+	    GL_TRIANGLES,
+	    static_cast<GLint>(command.first),
+	    static_cast<GLsizei>(command.count),
+	    static_cast<GLsizei>(command.instance_count),
+	    command.base_instance);
+}
+
+void apply_blend_mode(blend_mode mode)
+{
+	switch (mode)
+	{
+	case blend_mode::alpha:
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		break;
+	case blend_mode::additive: glBlendFunc(GL_SRC_ALPHA, GL_ONE); break;
+	}
+}
+
+struct vertex_attribute final
+{
+	GLuint      location{};
+	GLint       components{};
+	GLenum      type{GL_FLOAT};
+	GLboolean   normalized{GL_FALSE};
+	std::size_t offset{};
+};
+
+constexpr auto floats(GLuint location, GLint components, std::size_t offset)
+{
+	return vertex_attribute{.location = location,
+	                        .components = components,
+	                        .offset = offset};
+}
+
+constexpr auto unorm(GLuint      location,
+                     GLint       components,
+                     GLenum      type,
+                     std::size_t offset)
+{
+	return vertex_attribute{.location = location,
+	                        .components = components,
+	                        .type = type,
+	                        .normalized = GL_TRUE,
+	                        .offset = offset};
+}
+
+// Not normalised, so the shader sees the integer value as a float.
+constexpr auto integer(GLuint location, GLenum type, std::size_t offset)
+{
+	return vertex_attribute{.location = location,
+	                        .components = 1,
+	                        .type = type,
+	                        .offset = offset};
+}
+
+// Locations match sprite.vert.glsl and sprite_instanced.vert.glsl.
+constexpr std::array instance_attributes{
+    floats(0, 2, offsetof(sprite_instance, centre)),
+    floats(1, 2, offsetof(sprite_instance, half_size)),
+    floats(2, 4, offsetof(sprite_instance, tint)),
+    floats(3, 4, offsetof(sprite_instance, uv_bounds)),
+    floats(4, 1, offsetof(sprite_instance, layer)),
+};
+
+constexpr std::array compact_instance_attributes{
+    floats(0, 2, offsetof(compact_sprite_instance, centre)),
+    floats(1, 2, offsetof(compact_sprite_instance, half_size)),
+    unorm(2, 4, GL_UNSIGNED_BYTE, offsetof(compact_sprite_instance, tint)),
+    unorm(3,
+          4,
+          GL_UNSIGNED_SHORT,
+          offsetof(compact_sprite_instance, uv_bounds)),
+    integer(4, GL_UNSIGNED_SHORT, offsetof(compact_sprite_instance, layer)),
+};
+
+constexpr std::array vertex_attributes{
+    floats(0, 2, offsetof(sprite_vertex, pos)),
+    floats(1, 4, offsetof(sprite_vertex, tint)),
+    floats(2, 2, offsetof(sprite_vertex, uv)),
+    floats(3, 1, offsetof(sprite_vertex, uv) + 2 * sizeof(float)),
+};
+
+constexpr std::array compact_vertex_attributes{
+    floats(0, 2, offsetof(compact_sprite_vertex, pos)),
+    unorm(1, 4, GL_UNSIGNED_BYTE, offsetof(compact_sprite_vertex, tint)),
+    unorm(2, 2, GL_UNSIGNED_SHORT, offsetof(compact_sprite_vertex, uv)),
+    integer(3, GL_UNSIGNED_SHORT, offsetof(compact_sprite_vertex, layer)),
+};
+
+auto attributes_for(submission_mode mode, vertex_format format)
+    -> std::span<vertex_attribute const>
+{
+	auto const compact = format == vertex_format::compact;
+	if (mode == submission_mode::instanced)
+	{
+		return compact ? std::span{compact_instance_attributes}
+		               : std::span{instance_attributes};
+	}
+	return compact ? std::span{compact_vertex_attributes}
+	               : std::span{vertex_attributes};
+}
+
+void enable_attribute(unsigned int vao, vertex_attribute const& attribute)
+{
+	glEnableVertexArrayAttrib(vao, attribute.location);
+	glVertexArrayAttribFormat(vao,
+	                          attribute.location,
+	                          attribute.components,
+	                          attribute.type,
+	                          attribute.normalized,
+	                          static_cast<GLuint>(attribute.offset));
+	glVertexArrayAttribBinding(vao, attribute.location, 0);
+}
+
+auto shader_inputs(submission_mode mode)
+    -> std::vector<yaboc::shader_builder_input>
+{
+	auto const* vertex_shader_path =
+	    mode == submission_mode::instanced
+	        ? "assets/shaders/sprite_instanced.vert.glsl"
+	        : "assets/shaders/sprite.vert.glsl";
+
+	return {
+	    {.type = yaboc::shader_builder_input::shader_type::vertex,
+	     .path = vertex_shader_path},
+	    {.type = yaboc::shader_builder_input::shader_type::fragment,
+	     .path = "assets/shaders/sprite.frag.glsl"}
+    };
+}
 } // namespace
 
+void sprite_renderer::prepare_shaders(configuration const& config)
+{
+	yaboc::prepare_shader(shader_inputs(config.mode));
+	if (config.gpu_culling)
+	{
+		sprite_culler::prepare_shader();
+	}
+}
+
 sprite_renderer::~sprite_renderer()
 {
-	glUnmapNamedBuffer(m_vbo);
+	if (m_indirect_buffer != 0)
+	{
+		glUnmapNamedBuffer(m_indirect_buffer);
+		glDeleteBuffers(1, &m_indirect_buffer);
+	}
 
 	glDeleteProgram(m_shader);
-	glDeleteBuffers(1, &m_vbo);
 	glDeleteVertexArrays(1, &m_vao);
 }
 
 sprite_renderer::sprite_renderer(sprite_renderer::configuration&& config)
-    : m_sprites_per_batch{config.sprites_per_batch}
+    : m_ring_buffer{config.buffer_size, config.frames_in_flight}
+    , m_multi_draw_indirect{config.multi_draw_indirect}
+    , m_commands_per_frame{config.indirect_commands_per_frame}
+    , m_num_indirect_slices{config.frames_in_flight + 1}
+    , m_sprites_per_batch{config.sprites_per_batch}
     , m_pixels_per_metre{config.pixels_per_metre}
+    , m_view_max{config.reference_resolution}
+    , m_mode{config.mode}
+    , m_format{config.format}
+    , m_bytes_per_sprite{bytes_per_sprite(m_mode, m_format)}
+    , m_write_sprites{m_mode == submission_mode::instanced
+                          ? kernels::scalar(m_format).instances
+                          : kernels::scalar(m_format).vertices}
 {
-	auto const verts_per_batch = verts_per_quad * m_sprites_per_batch;
-	auto const vbo_size = verts_per_batch * sizeof(vertex);
-
-	m_vbo = create_empty_buffer(vbo_size * num_buffers);
-	auto vbo_span = map_as<vertex>(m_vbo, vbo_size * num_buffers);
+	if (m_multi_draw_indirect)
+	{
+		auto const indirect_size = sizeof(draw_indirect_command) *
+		                           m_commands_per_frame * m_num_indirect_slices;
 
-	m_vertex_buffer_regions[0].region = vbo_span.first(verts_per_batch);
-	m_vertex_buffer_regions[1].region =
-	    vbo_span.subspan(verts_per_batch, verts_per_batch);
-	m_vertex_buffer_regions[2].region = vbo_span.last(verts_per_batch);
+		m_indirect_buffer = create_empty_buffer(indirect_size);
+		m_indirect_commands =
+		    map_as<draw_indirect_command>(m_indirect_buffer, indirect_size);
+	}
 
 	glCreateVertexArrays(1, &m_vao);
-	glVertexArrayVertexBuffer(m_vao, 0, m_vbo, 0, sizeof(vertex));
-
-	int const pos_attr_loc{0};
-	glEnableVertexArrayAttrib(m_vao, pos_attr_loc);
-	glVertexArrayAttribFormat(m_vao,
-	                          pos_attr_loc,
-	                          decltype(vertex::pos)::length(),
-	                          GL_FLOAT,
-	                          GL_FALSE,
-	                          0);
-	glVertexArrayAttribBinding(m_vao, pos_attr_loc, 0);
-
-	int const tint_attr_loc{1};
-	glEnableVertexArrayAttrib(m_vao, tint_attr_loc);
-	glVertexArrayAttribFormat(m_vao,
-	                          tint_attr_loc,
-	                          decltype(vertex::tint)::length(),
-	                          GL_FLOAT,
-	                          GL_FALSE,
-	                          offsetof(vertex, tint));
-	glVertexArrayAttribBinding(m_vao, tint_attr_loc, 0);
-
-	int const uv_attr_loc{2};
-	glEnableVertexArrayAttrib(m_vao, uv_attr_loc);
-	glVertexArrayAttribFormat(m_vao,
-	                          uv_attr_loc,
-	                          decltype(vertex::uv)::length(),
-	                          GL_FLOAT,
-	                          GL_FALSE,
-	                          offsetof(vertex, uv));
-	glVertexArrayAttribBinding(m_vao, uv_attr_loc, 0);
 
-	m_shader = yaboc::make_shader(std::vector<yaboc::shader_builder_input>{
-	    {.type = yaboc::shader_builder_input::shader_type::vertex,
-	     .path = "assets/shaders/sprite.vert.glsl"},
-	    {.type = yaboc::shader_builder_input::shader_type::fragment,
-	     .path = "assets/shaders/sprite.frag.glsl"}
-    });
+	m_bound_buffer = m_ring_buffer.buffer_id();
+	glVertexArrayVertexBuffer(m_vao,
+	                          0,
+	                          m_bound_buffer,
+	                          0,
+	                          static_cast<GLsizei>(vertex_stride()));
 
-	auto projection = glm::ortho(0.0F,
-	                             config.reference_resolution.x,
-	                             config.reference_resolution.y,
-	                             0.0F,
-	                             -1.0F,
-	                             1.0F);
+	if (m_mode == submission_mode::instanced)
+	{
+		glVertexArrayBindingDivisor(m_vao, 0, 1);
+	}
 
-	glUseProgram(m_shader);
-	auto const proj_loc = glGetUniformLocation(m_shader, "projection");
-	glUniformMatrix4fv(proj_loc, 1, GL_FALSE, glm::value_ptr(projection));
+	for (auto const& attribute: attributes_for(m_mode, m_format))
+	{
+		enable_attribute(m_vao, attribute);
+	}
+
+	m_shader = yaboc::make_shader(shader_inputs(m_mode));
+
+	m_projection_location = glGetUniformLocation(m_shader, "projection");
+	update_projection();
+
+	auto const kernels = select_quad_expansion_kernels(
+	    std::min(config.max_simd_level, detect_simd_level()),
+	    m_format);
+	m_expand_quads = m_mode == submission_mode::instanced ? kernels.instances
+	                                                      : kernels.vertices;
+
+	if (config.gpu_culling)
+	{
+		m_culler.emplace(sprite_culler::sprite_layout{
+		    .bytes_per_sprite = m_bytes_per_sprite,
+		    .bytes_per_vertex = vertex_stride(),
+		    .instanced = m_mode == submission_mode::instanced});
+	}
 }
 
 void sprite_renderer::begin_batch()
@@ -143,11 +286,48 @@ void sprite_renderer::begin_batch()
 
 	glUseProgram(m_shader);
 	glBindVertexArray(m_vao);
+
+	if (m_multi_draw_indirect)
+	{
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirect_buffer);
+	}
 }
 
 void sprite_renderer::use_sprite_sheet(sprite_sheet const& sheet)
 {
-	glBindTextureUnit(0, sheet.renderer_id());
+	bind_sprite_sheet_texture(sheet.renderer_id());
+}
+
+void sprite_renderer::use_sprite_sheets(sprite_sheet_array const& sheets)
+{
+	bind_sprite_sheet_texture(sheets.renderer_id());
+}
+
+void sprite_renderer::use_atlas(dynamic_atlas const& atlas)
+{
+	bind_sprite_sheet_texture(atlas.renderer_id());
+}
+
+void sprite_renderer::use_blend_mode(blend_mode mode)
+{
+	if (mode == m_blend_mode)
+	{
+		return;
+	}
+
+	flush_pending_state_change();
+
+	apply_blend_mode(mode);
+	m_blend_mode = mode;
+}
+
+void sprite_renderer::use_view(glm::vec2 min, glm::vec2 max)
+{
+	flush_pending_state_change();
+
+	m_view_min = min * static_cast<float>(m_pixels_per_metre);
+	m_view_max = max * static_cast<float>(m_pixels_per_metre);
+	update_projection();
 }
 
 void sprite_renderer::end_batch()
@@ -156,6 +336,28 @@ void sprite_renderer::end_batch()
 	{
 		flush();
 	}
+	submit_recorded_draws();
+
+	m_ring_buffer.end_frame();
+
+	// Other passes may bind their own textures between frames.
+	m_bound_texture = 0;
+
+	if (m_blend_mode != blend_mode::alpha)
+	{
+		apply_blend_mode(blend_mode::alpha);
+		m_blend_mode = blend_mode::alpha;
+	}
+
+	if (m_multi_draw_indirect)
+	{
+		m_indirect_slice = (m_indirect_slice + 1) % m_num_indirect_slices;
+		m_recorded_commands = 0;
+		m_submitted_commands = 0;
+
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	}
+
 	glBindVertexArray(0);
 	glUseProgram(0);
 }
@@ -168,86 +370,361 @@ auto sprite_renderer::submit_sprite(glm::vec2         position,
 	if (m_current_sprite_count == m_sprites_per_batch)
 	{
 		flush();
-		auto* current_fence =
-		    m_vertex_buffer_regions[m_current_vertex_buffer_region].fence;
+	}
+
+	if (std::empty(m_batch_memory))
+	{
+		reserve_batch();
+	}
+
+	auto const sprite_memory =
+	    m_batch_memory.subspan(m_current_sprite_count * m_bytes_per_sprite,
+	                           m_bytes_per_sprite);
 
-		if (current_fence != nullptr)
+	write_sprite(sprite_memory, position, size, tint, uv_bounds);
+
+	m_current_sprite_count++;
+}
+
+void sprite_renderer::submit_sprites(sprite_batch_input const& sprites)
+{
+	auto const pixels_per_metre = static_cast<float>(m_pixels_per_metre);
+
+	std::size_t submitted{};
+	while (submitted < sprites.size())
+	{
+		if (m_current_sprite_count == m_sprites_per_batch)
+		{
+			flush();
+		}
+
+		if (std::empty(m_batch_memory))
 		{
-			while (true)
-			{
-				GLenum sync_result{
-				    glClientWaitSync(current_fence,
-				                     GL_SYNC_FLUSH_COMMANDS_BIT,
-				                     std::chrono::nanoseconds::max().count())};
-
-				if (sync_result == GL_ALREADY_SIGNALED ||
-				    sync_result == GL_CONDITION_SATISFIED)
-				{
-					glDeleteSync(current_fence);
-					m_vertex_buffer_regions[m_current_vertex_buffer_region]
-					    .fence = nullptr;
-					break;
-				}
-			}
+			reserve_batch();
 		}
+
+		auto const space = m_sprites_per_batch - m_current_sprite_count;
+		auto const count = std::min(sprites.size() - submitted, space);
+
+		m_expand_quads(
+		    sprites.subspan(submitted, count),
+		    pixels_per_metre,
+		    m_batch_memory.subspan(m_current_sprite_count * m_bytes_per_sprite,
+		                           count * m_bytes_per_sprite));
+
+		m_current_sprite_count += static_cast<unsigned int>(count);
+		submitted += count;
 	}
+}
 
-	auto const current_vertex_count = m_current_sprite_count * verts_per_quad;
+auto sprite_renderer::make_static_batch() const -> static_sprite_batch
+{
+	return static_sprite_batch{m_bytes_per_sprite};
+}
 
-	auto current_vbo_span =
-	    m_vertex_buffer_regions[m_current_vertex_buffer_region].region;
-	auto const vertices =
-	    current_vbo_span.subspan(current_vertex_count, verts_per_quad);
+void sprite_renderer::write_static_sprite(static_sprite_batch& batch,
+                                          std::size_t          slot,
+                                          glm::vec2            position,
+                                          glm::vec2            size,
+                                          glm::vec4            tint,
+                                          subtexture_bounds    uv_bounds) const
+{
+	write_sprite(batch.sprite_memory(slot), position, size, tint, uv_bounds);
+}
 
-	position *= m_pixels_per_metre;
-	size *= m_pixels_per_metre;
-	size /= 2.0F;
+void sprite_renderer::draw_static(static_sprite_batch& batch)
+{
+	if (batch.size() == 0)
+	{
+		return;
+	}
 
-	glm::vec2 min_pos{position - size};
-	glm::vec2 max_pos{position + size};
+	flush_pending_state_change();
 
-	auto const top_left =
-	    vertex{.pos = min_pos, .tint = tint, .uv = uv_bounds.min};
-	auto const top_right = vertex{
-	    .pos = glm::vec2{max_pos.x,       min_pos.y      },
-	    .tint = tint,
-	    .uv = {uv_bounds.max.x, uv_bounds.min.y}
-    };
-	auto const bottom_left = vertex{
-	    .pos = glm::vec2{min_pos.x,       max_pos.y      },
-	    .tint = tint,
-	    .uv = {uv_bounds.min.x, uv_bounds.max.y}
-    };
-	auto const bottom_right =
-	    vertex{.pos = max_pos, .tint = tint, .uv = uv_bounds.max};
+	batch.upload();
 
-	vertices[0] = bottom_left;
-	vertices[1] = top_right;
-	vertices[2] = top_left;
-	vertices[3] = bottom_left;
-	vertices[4] = bottom_right;
-	vertices[5] = top_right;
+	auto const stride = static_cast<GLsizei>(vertex_stride());
 
-	m_current_sprite_count++;
+	if (!m_culler)
+	{
+		glVertexArrayVertexBuffer(m_vao, 0, batch.buffer_id(), 0, stride);
+		draw_direct(make_draw_command(0, batch.size()));
+		glVertexArrayVertexBuffer(m_vao, 0, m_bound_buffer, 0, stride);
+		return;
+	}
+
+	m_culler->cull(batch, m_view_min, m_view_max);
+	glUseProgram(m_shader);
+
+	glVertexArrayVertexBuffer(m_vao, 0, m_culler->buffer_id(), 0, stride);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_culler->indirect_buffer_id());
+	glDrawArraysIndirect(GL_TRIANGLES, nullptr);
+
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirect_buffer);
+	glVertexArrayVertexBuffer(m_vao, 0, m_bound_buffer, 0, stride);
+}
+
+void sprite_renderer::write_sprite(std::span<std::byte> memory,
+                                   glm::vec2            position,
+                                   glm::vec2            size,
+                                   glm::vec4            tint,
+                                   subtexture_bounds    uv_bounds) const
+{
+	// A batch of one through the scalar kernel, so single sprites come out
+	// exactly like batched ones.
+	glm::vec4 const     uv{uv_bounds.min, uv_bounds.max};
+	std::uint32_t const layer{uv_bounds.layer};
+
+	m_write_sprites({.x = {&position.x, 1},
+	                 .y = {&position.y, 1},
+	                 .width = {&size.x, 1},
+	                 .height = {&size.y, 1},
+	                 .uv_bounds = {&uv, 1},
+	                 .tint = {&tint, 1},
+	                 .layer = {&layer, 1}},
+	                static_cast<float>(m_pixels_per_metre),
+	                memory);
 }
 
 void sprite_renderer::flush()
 {
-	auto const first_quad =
-	    m_sprites_per_batch * verts_per_quad * m_current_vertex_buffer_region;
-	auto const count = m_current_sprite_count * verts_per_quad;
+	auto const command =
+	    make_draw_command(m_batch_first_sprite, m_current_sprite_count);
+
+	if (m_multi_draw_indirect)
+	{
+		record_draw(command);
+	}
+	else
+	{
+		draw_direct(command);
+	}
 
-	glDrawArrays(GL_TRIANGLES, first_quad, count);
+	m_ring_buffer.commit(m_current_sprite_count * m_bytes_per_sprite);
 
 	m_current_sprite_count = 0;
+	m_batch_memory = {};
+}
+
+auto sprite_renderer::begin_parallel_submission(std::size_t max_sprites)
+    -> parallel_submission
+{
+	// The rest of the current batch is given back, the range has to be
+	// contiguous.
+	if (m_current_sprite_count > 0)
+	{
+		flush();
+	}
+	m_batch_memory = {};
+
+	return parallel_submission{this, reserve_sprites(max_sprites)};
+}
+
+void sprite_renderer::end_parallel_submission(
+    parallel_submission const& submission)
+{
+	assert(submission.m_renderer == this);
+
+	auto const sprite_count = submission.claimed();
+	assert(sprite_count <= submission.m_capacity);
+	if (sprite_count == 0)
+	{
+		return;
+	}
+
+	m_current_sprite_count = static_cast<unsigned int>(sprite_count);
+	flush();
+}
+
+sprite_renderer::parallel_submission::parallel_submission(
+    sprite_renderer const* renderer,
+    std::span<std::byte>   memory)
+    : m_renderer{renderer}
+    , m_memory{memory}
+    , m_capacity{std::size(memory) / renderer->m_bytes_per_sprite}
+{}
+
+auto sprite_renderer::parallel_submission::claim(std::size_t count)
+    -> std::size_t
+{
+	auto const first = m_claimed.fetch_add(count, std::memory_order_relaxed);
+	assert(first + count <= m_capacity);
+	return first;
+}
+
+void sprite_renderer::parallel_submission::write(
+    std::size_t       slot,
+    glm::vec2         position,
+    glm::vec2         size,
+    glm::vec4         tint,
+    subtexture_bounds uv_bounds) const
+{
+	assert(slot < m_capacity);
+
+	auto const bytes_per_sprite = m_renderer->m_bytes_per_sprite;
+	m_renderer->write_sprite(
+	    m_memory.subspan(slot * bytes_per_sprite, bytes_per_sprite),
+	    position,
+	    size,
+	    tint,
+	    uv_bounds);
+}
+
+void sprite_renderer::parallel_submission::write(
+    std::size_t               first_slot,
+    sprite_batch_input const& sprites) const
+{
+	assert(first_slot + sprites.size() <= m_capacity);
+
+	auto const bytes_per_sprite = m_renderer->m_bytes_per_sprite;
+	m_renderer->m_expand_quads(
+	    sprites,
+	    static_cast<float>(m_renderer->m_pixels_per_metre),
+	    m_memory.subspan(first_slot * bytes_per_sprite,
+	                     sprites.size() * bytes_per_sprite));
+}
 
-	m_vertex_buffer_regions[m_current_vertex_buffer_region].fence =
-	    glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+void sprite_renderer::reserve_batch()
+{
+	m_batch_memory = reserve_sprites(m_sprites_per_batch);
+}
+
+auto sprite_renderer::reserve_sprites(std::size_t sprite_count)
+    -> std::span<std::byte>
+{
+	auto const batch_size = sprite_count * m_bytes_per_sprite;
+
+	// Wrapping or growing the ring fences what has been committed so far, so
+	// everything recorded must have been handed to GL first.
+	if (!m_ring_buffer.fits(batch_size, m_bytes_per_sprite))
+	{
+		submit_recorded_draws();
+	}
 
-	++m_current_vertex_buffer_region;
-	if (m_current_vertex_buffer_region == num_buffers)
+	auto const reservation =
+	    m_ring_buffer.reserve(batch_size, m_bytes_per_sprite);
+
+	m_batch_first_sprite = reservation.offset / m_bytes_per_sprite;
+
+	// Growing the ring replaces the buffer object.
+	if (m_ring_buffer.buffer_id() != m_bound_buffer)
 	{
-		m_current_vertex_buffer_region = 0;
+		m_bound_buffer = m_ring_buffer.buffer_id();
+		glVertexArrayVertexBuffer(m_vao,
+		                          0,
+		                          m_bound_buffer,
+		                          0,
+		                          static_cast<GLsizei>(vertex_stride()));
 	}
+
+	return reservation.memory;
+}
+
+void sprite_renderer::record_draw(draw_indirect_command const& command)
+{
+	if (m_recorded_commands == m_commands_per_frame)
+	{
+		submit_recorded_draws();
+		draw_direct(command);
+		return;
+	}
+
+	auto const slice_begin = m_indirect_slice * m_commands_per_frame;
+	m_indirect_commands[slice_begin + m_recorded_commands] = command;
+	++m_recorded_commands;
+}
+
+void sprite_renderer::submit_recorded_draws()
+{
+	auto const pending = m_recorded_commands - m_submitted_commands;
+	if (pending == 0)
+	{
+		return;
+	}
+
+	auto const offset =
+	    (m_indirect_slice * m_commands_per_frame + m_submitted_commands) *
+	    sizeof(draw_indirect_command);
+
+	glMultiDrawArraysIndirect(
+	    GL_TRIANGLES,
+	    reinterpret_cast<void const*>(offset), // NOLINT(*-no-int-to-ptr)
+	    static_cast<GLsizei>(pending),
+	    0);
+
+	m_submitted_commands = m_recorded_commands;
+}
+
+void sprite_renderer::bind_sprite_sheet_texture(unsigned int texture_id)
+{
+	// Sheets that share a texture array are told apart by the per-sprite
+	// layer, so switching between them does not break the batch.
+	if (texture_id == m_bound_texture)
+	{
+		return;
+	}
+
+	flush_pending_state_change();
+
+	glBindTextureUnit(0, texture_id);
+	m_bound_texture = texture_id;
+}
+
+void sprite_renderer::flush_pending_state_change()
+{
+	// Recorded batches must be drawn with the state they were submitted with.
+	if (m_current_sprite_count > 0)
+	{
+		flush();
+	}
+	submit_recorded_draws();
+}
+
+auto sprite_renderer::make_draw_command(std::size_t first_sprite,
+                                        std::size_t sprite_count) const
+    -> draw_indirect_command
+{
+	constexpr auto quad_vertices = static_cast<GLuint>(verts_per_quad);
+
+	auto const first = static_cast<GLuint>(first_sprite);
+	auto const count = static_cast<GLuint>(sprite_count);
+
+	if (m_mode == submission_mode::instanced)
+	{
+		// Each instance is expanded from gl_VertexID in the vertex shader, so
+		// the base instance selects the batch rather than the first vertex.
+		return {.count = quad_vertices,
+		        .instance_count = count,
+		        .first = 0,
+		        .base_instance = first};
+	}
+
+	return {.count = count * quad_vertices,
+	        .instance_count = 1,
+	        .first = first * quad_vertices,
+	        .base_instance = 0};
+}
+
+void sprite_renderer::update_projection()
+{
+	auto const projection = glm::ortho(m_view_min.x,
+	                                   m_view_max.x,
+	                                   m_view_max.y,
+	                                   m_view_min.y,
+	                                   -1.0F,
+	                                   1.0F);
+
+	glProgramUniformMatrix4fv(m_shader,
+	                          m_projection_location,
+	                          1,
+	                          GL_FALSE,
+	                          glm::value_ptr(projection));
+}
+
+auto sprite_renderer::vertex_stride() const -> std::size_t
+{
+	return m_mode == submission_mode::instanced
+	         ? m_bytes_per_sprite
+	         : m_bytes_per_sprite / verts_per_quad;
 }
 } // namespace yaboc::sprite
@@ -15,6 +15,8 @@
 // this program. If not, see <https://www.gnu.org/licenses/>.
 #include "yaboc/sprite/sprite_sheet.h"
 
+#include "yaboc/core/perfect_hash.h"
+
 #include "nlohmann/json.hpp"
 
 #include <cstddef>
@@ -74,22 +76,58 @@ sprite_sheet::sprite_sheet(std::string&& specification_path)
 
 	sprite_sheet_info["meta"].get_to<sprite_sheet_meta>(m_meta_data);
 
-	for (std::size_t current_id{}; auto&& frame: sprite_sheet_info["frames"])
+	for (auto&& frame: sprite_sheet_info["frames"])
 	{
-		auto data = frame.get<sprite_frame_data>();
-		m_id_lookup.emplace(std::piecewise_construct,
-		                    std::forward_as_tuple(data.name),
-		                    std::forward_as_tuple(current_id));
-		m_sprite_frame_data.push_back(std::move(data));
-		++current_id;
+		m_sprite_frame_data.push_back(frame.get<sprite_frame_data>());
 	}
+	index_frames();
+}
+
+sprite_sheet::sprite_sheet(assets::frame_table_view const& frames)
+    : m_meta_data{.name = std::string{frames.texture},
+                  .dimensions = {frames.width, frames.height},
+                  .format = image_format::rgba_8888}
+{
+	m_sprite_frame_data.reserve(std::size(frames.frames));
+	for (auto const& frame: frames.frames)
+	{
+		m_sprite_frame_data.push_back(sprite_frame_data{
+		    .name = std::string{frames.name(frame)},
+		    .bounds = {.min = {frame.min_x, frame.min_y},
+		               .max = {frame.max_x, frame.max_y}},
+		    .size = {frame.size_x, frame.size_y}
+        });
+	}
+	index_frames();
+}
+
+void sprite_sheet::index_frames()
+{
+	auto const sheet_size = glm::vec2{m_meta_data.dimensions};
+
+	std::vector<std::string_view> names{};
+	names.reserve(std::size(m_sprite_frame_data));
+	m_uvs.clear();
+	m_uvs.reserve(std::size(m_sprite_frame_data));
+	for (auto const& data: m_sprite_frame_data)
+	{
+		names.emplace_back(data.name);
+		m_uvs.push_back({.min = glm::vec2{data.bounds.min} / sheet_size,
+		                 .max = glm::vec2{data.bounds.max} / sheet_size});
+	}
+
+	m_name_seeds.resize(std::size(names));
+	m_name_ids.resize(std::size(names));
+	core::build_perfect_hash(names, m_name_seeds, m_name_ids);
 }
 
-auto sprite_sheet::id_from_name(std::string const& name) const -> std::size_t
+auto sprite_sheet::id_from_name(std::string_view name) const -> std::size_t
 {
-	auto iterator = m_id_lookup.find(name);
-	assert(iterator != std::end(m_id_lookup));
-	return iterator->second;
+	assert(!std::empty(m_sprite_frame_data));
+	auto const id =
+	    core::perfect_hash_position(m_name_seeds, m_name_ids, name);
+	assert(m_sprite_frame_data[id].name == name);
+	return id;
 }
 
 void from_json(nlohmann::json const& json, sprite_frame_data& sprite)
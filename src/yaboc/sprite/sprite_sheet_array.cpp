@@ -0,0 +1,213 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#include "yaboc/sprite/sprite_sheet_array.h"
+
+#include "glad/gl.h"
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+#include <utility>
+
+namespace yaboc::sprite
+{
+sprite_sheet_array::~sprite_sheet_array()
+{
+	glDeleteTextures(1, &m_renderer_id);
+}
+
+sprite_sheet_array::sprite_sheet_array(std::vector<sprite_sheet>&& sheets)
+    : sprite_sheet_array{std::move(sheets), load_images(sheets)}
+{}
+
+sprite_sheet_array::sprite_sheet_array(
+    std::vector<sprite_sheet>&&         sheets,
+    std::vector<graphics::image> const& images)
+    : m_sheets{std::move(sheets)}
+{
+	assert(!std::empty(m_sheets));
+	assert(std::size(images) == std::size(m_sheets));
+
+	m_dimensions = m_sheets.front().meta_data().dimensions;
+
+	[[maybe_unused]] int max_layers{};
+	glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &max_layers);
+	assert(std::size(m_sheets) <= static_cast<std::size_t>(max_layers));
+
+	glCreateTextures(GL_TEXTURE_2D_ARRAY, 1, &m_renderer_id);
+
+	glTextureParameteri(m_renderer_id, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTextureParameteri(m_renderer_id, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTextureParameteri(m_renderer_id,
+	                    GL_TEXTURE_MIN_FILTER,
+	                    GL_LINEAR_MIPMAP_LINEAR);
+	glTextureParameteri(m_renderer_id, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	// The whole chain, so that the mipmaps generated below are complete.
+	auto const level_count =
+	    std::bit_width(static_cast<unsigned int>(
+	        std::max(m_dimensions.x, m_dimensions.y)));
+	glTextureStorage3D(m_renderer_id,
+	                   static_cast<GLsizei>(level_count),
+	                   GL_RGBA8,
+	                   m_dimensions.x,
+	                   m_dimensions.y,
+	                   static_cast<GLsizei>(std::size(m_sheets)));
+
+	for (unsigned int layer{}; auto& sheet: m_sheets)
+	{
+		[[maybe_unused]] auto const& meta_data = sheet.meta_data();
+		assert(meta_data.dimensions == m_dimensions);
+
+		auto const& picture = images[layer];
+		assert(glm::ivec2(picture.width, picture.height) == m_dimensions);
+
+		glTextureSubImage3D(m_renderer_id,
+		                    0,
+		                    0,
+		                    0,
+		                    static_cast<GLint>(layer),
+		                    m_dimensions.x,
+		                    m_dimensions.y,
+		                    1,
+		                    GL_RGBA,
+		                    GL_UNSIGNED_BYTE,
+		                    std::data(picture.pixels));
+
+		sheet.renderer_id(m_renderer_id);
+		sheet.layer(layer);
+		++layer;
+	}
+
+	glGenerateTextureMipmap(m_renderer_id);
+}
+
+sprite_sheet_array::sprite_sheet_array(
+    std::vector<sprite_sheet>&&               sheets,
+    std::vector<assets::texture_view> const& textures)
+    : m_sheets{std::move(sheets)}
+{
+	assert(!std::empty(m_sheets));
+	assert(std::size(textures) == std::size(m_sheets));
+
+	m_dimensions = m_sheets.front().meta_data().dimensions;
+
+	auto const level_count = textures.front().level_count();
+	auto const format = textures.front().format();
+
+	glCreateTextures(GL_TEXTURE_2D_ARRAY, 1, &m_renderer_id);
+
+	glTextureParameteri(m_renderer_id, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTextureParameteri(m_renderer_id, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTextureParameteri(m_renderer_id,
+	                    GL_TEXTURE_MIN_FILTER,
+	                    GL_LINEAR_MIPMAP_LINEAR);
+	glTextureParameteri(m_renderer_id, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	glTextureStorage3D(m_renderer_id,
+	                   static_cast<GLsizei>(level_count),
+	                   format == assets::texture_format::bc7
+	                       ? GL_COMPRESSED_RGBA_BPTC_UNORM
+	                       : GL_RGBA8,
+	                   m_dimensions.x,
+	                   m_dimensions.y,
+	                   static_cast<GLsizei>(std::size(m_sheets)));
+
+	for (unsigned int layer{}; auto& sheet: m_sheets)
+	{
+		auto const& texture = textures[layer];
+		assert(texture.format() == format);
+		assert(texture.width() == m_dimensions.x &&
+		       texture.height() == m_dimensions.y);
+		assert(texture.level_count() == level_count);
+
+		for (std::size_t index{}; index < level_count; ++index)
+		{
+			auto const level = texture.level(index);
+			if (format == assets::texture_format::bc7)
+			{
+				glCompressedTextureSubImage3D(
+				    m_renderer_id,
+				    static_cast<GLint>(index),
+				    0,
+				    0,
+				    static_cast<GLint>(layer),
+				    level.width,
+				    level.height,
+				    1,
+				    GL_COMPRESSED_RGBA_BPTC_UNORM,
+				    static_cast<GLsizei>(std::size(level.pixels)),
+				    std::data(level.pixels));
+				continue;
+			}
+
+			glTextureSubImage3D(m_renderer_id,
+			                    static_cast<GLint>(index),
+			                    0,
+			                    0,
+			                    static_cast<GLint>(layer),
+			                    level.width,
+			                    level.height,
+			                    1,
+			                    GL_RGBA,
+			                    GL_UNSIGNED_BYTE,
+			                    std::data(level.pixels));
+		}
+
+		sheet.renderer_id(m_renderer_id);
+		sheet.layer(layer);
+		++layer;
+	}
+}
+
+auto sprite_sheet_array::load_images(std::vector<sprite_sheet> const& sheets)
+    -> std::vector<graphics::image>
+{
+	std::vector<graphics::image> images{};
+	images.reserve(std::size(sheets));
+	for (auto const& sheet: sheets)
+	{
+		auto picture = graphics::load_png(sheet.meta_data().name);
+		if (!picture)
+		{
+			throw std::runtime_error{"failed to load " +
+			                         sheet.meta_data().name};
+		}
+		images.push_back(std::move(*picture));
+	}
+	return images;
+}
+
+sprite_sheet_array::sprite_sheet_array(sprite_sheet_array&& other) noexcept
+    : m_sheets{std::move(other.m_sheets)}
+    , m_dimensions{other.m_dimensions}
+    , m_renderer_id{std::exchange(other.m_renderer_id, 0)}
+{}
+
+auto sprite_sheet_array::operator=(sprite_sheet_array&& other) noexcept
+    -> sprite_sheet_array&
+{
+	if (this != &other)
+	{
+		glDeleteTextures(1, &m_renderer_id);
+
+		m_sheets = std::move(other.m_sheets);
+		m_dimensions = other.m_dimensions;
+		m_renderer_id = std::exchange(other.m_renderer_id, 0);
+	}
+	return *this;
+}
+} // namespace yaboc::sprite
@@ -0,0 +1,160 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#include "yaboc/sprite/static_sprite_batch.h"
+
+#include "glad/gl.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+namespace yaboc::sprite
+{
+static_sprite_batch::~static_sprite_batch()
+{
+	glDeleteBuffers(1, &m_buffer);
+}
+
+static_sprite_batch::static_sprite_batch(std::size_t bytes_per_sprite)
+    : m_bytes_per_sprite{bytes_per_sprite}
+{}
+
+static_sprite_batch::static_sprite_batch(static_sprite_batch&& other) noexcept
+    : m_buffer{std::exchange(other.m_buffer, 0)}
+    , m_buffer_capacity{std::exchange(other.m_buffer_capacity, 0)}
+    , m_sprites{std::move(other.m_sprites)}
+    , m_bytes_per_sprite{other.m_bytes_per_sprite}
+    , m_size{std::exchange(other.m_size, 0)}
+    , m_dirty_begin{other.m_dirty_begin}
+    , m_dirty_end{other.m_dirty_end}
+{}
+
+auto static_sprite_batch::operator=(static_sprite_batch&& other) noexcept
+    -> static_sprite_batch&
+{
+	if (this != &other)
+	{
+		glDeleteBuffers(1, &m_buffer);
+
+		m_buffer = std::exchange(other.m_buffer, 0);
+		m_buffer_capacity = std::exchange(other.m_buffer_capacity, 0);
+		m_sprites = std::move(other.m_sprites);
+		m_bytes_per_sprite = other.m_bytes_per_sprite;
+		m_size = std::exchange(other.m_size, 0);
+		m_dirty_begin = other.m_dirty_begin;
+		m_dirty_end = other.m_dirty_end;
+	}
+	return *this;
+}
+
+auto static_sprite_batch::append() -> std::size_t
+{
+	auto const slot = m_size++;
+	m_sprites.resize(m_size * m_bytes_per_sprite);
+	mark_dirty(slot);
+	return slot;
+}
+
+auto static_sprite_batch::remove(std::size_t slot) -> std::size_t
+{
+	assert(slot < m_size);
+
+	auto const last = --m_size;
+	if (slot != last)
+	{
+		std::memcpy(&m_sprites[slot * m_bytes_per_sprite],
+		            &m_sprites[last * m_bytes_per_sprite],
+		            m_bytes_per_sprite);
+		mark_dirty(slot);
+	}
+	m_sprites.resize(m_size * m_bytes_per_sprite);
+
+	// The draw count shrinks, so the vacated slot needs no upload.
+	m_dirty_end = std::min(m_dirty_end, m_size);
+	m_dirty_begin = std::min(m_dirty_begin, m_dirty_end);
+
+	return last;
+}
+
+void static_sprite_batch::clear()
+{
+	m_size = 0;
+	m_sprites.clear();
+	m_dirty_begin = 0;
+	m_dirty_end = 0;
+}
+
+auto static_sprite_batch::sprite_memory(std::size_t slot)
+    -> std::span<std::byte>
+{
+	assert(slot < m_size);
+
+	mark_dirty(slot);
+	return std::span{m_sprites}.subspan(slot * m_bytes_per_sprite,
+	                                    m_bytes_per_sprite);
+}
+
+void static_sprite_batch::upload()
+{
+	if (m_size > m_buffer_capacity)
+	{
+		glDeleteBuffers(1, &m_buffer);
+
+		m_buffer_capacity = std::max(m_size, m_buffer_capacity * 2);
+		auto const buffer_size = m_buffer_capacity * m_bytes_per_sprite;
+		assert(buffer_size < std::numeric_limits<GLsizeiptr>::max());
+
+		glCreateBuffers(1, &m_buffer);
+		glNamedBufferStorage(m_buffer,
+		                     static_cast<GLsizeiptr>(buffer_size),
+		                     nullptr,
+		                     GL_DYNAMIC_STORAGE_BIT);
+
+		m_dirty_begin = 0;
+		m_dirty_end = m_size;
+	}
+
+	if (m_dirty_begin == m_dirty_end)
+	{
+		return;
+	}
+
+	auto const offset = m_dirty_begin * m_bytes_per_sprite;
+	auto const length = (m_dirty_end - m_dirty_begin) * m_bytes_per_sprite;
+	glNamedBufferSubData(m_buffer,
+	                     static_cast<GLintptr>(offset),
+	                     static_cast<GLsizeiptr>(length),
+	                     &m_sprites[offset]);
+
+	m_dirty_begin = 0;
+	m_dirty_end = 0;
+}
+
+void static_sprite_batch::mark_dirty(std::size_t slot)
+{
+	if (m_dirty_begin == m_dirty_end)
+	{
+		m_dirty_begin = slot;
+		m_dirty_end = slot + 1;
+		return;
+	}
+
+	m_dirty_begin = std::min(m_dirty_begin, slot);
+	m_dirty_end = std::max(m_dirty_end, slot + 1);
+}
+} // namespace yaboc::sprite
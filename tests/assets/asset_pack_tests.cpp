@@ -0,0 +1,198 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#include "yaboc/assets/asset_pack.h"
+
+#include "yaboc/assets/pack_format.h"
+
+#include "gtest/gtest.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+using namespace yaboc::assets;
+
+constexpr std::string_view shader_name{"assets/shaders/test.glsl"};
+constexpr std::string_view shader_source{"void main() {}"};
+
+template <class T>
+void write_at(std::vector<std::byte>& bytes,
+              std::uint64_t           offset,
+              T const&                value)
+{
+	std::memcpy(std::data(bytes) + offset, &value, sizeof(T));
+}
+
+template <class T>
+auto read_at(std::vector<std::byte> const& bytes, std::uint64_t offset) -> T
+{
+	T value{};
+	std::memcpy(&value, std::data(bytes) + offset, sizeof(T));
+	return value;
+}
+
+// A pack as yaboc_cook lays it out, holding a single shader.
+auto make_pack() -> std::vector<std::byte>
+{
+	auto const name_size = static_cast<std::uint32_t>(std::size(shader_name));
+	auto const blob_offset = align_to_pack(sizeof(pack_header));
+	auto const blob_size = std::size(shader_source) + 1;
+	auto const directory_offset = align_to_pack(blob_offset + blob_size);
+	auto const names_offset = directory_offset + sizeof(pack_entry);
+
+	std::vector<std::byte> bytes(names_offset + name_size);
+
+	write_at(bytes,
+	         0,
+	         pack_header{.entry_count = 1,
+	                     .names_size = name_size,
+	                     .directory_offset = directory_offset});
+	write_at(bytes,
+	         directory_offset,
+	         pack_entry{.name_size = name_size,
+	                    .kind = pack_entry_kind::shader,
+	                    .offset = blob_offset,
+	                    .size = blob_size});
+	// The terminator is already there.
+	std::memcpy(std::data(bytes) + blob_offset,
+	            std::data(shader_source),
+	            std::size(shader_source));
+	std::memcpy(std::data(bytes) + names_offset,
+	            std::data(shader_name),
+	            std::size(shader_name));
+	return bytes;
+}
+
+// Checks that the pack is refused for the reason given.
+void expect_rejected(std::filesystem::path const& path, std::string_view reason)
+{
+	try
+	{
+		asset_pack const pack{path};
+		ADD_FAILURE() << "accepted " << path;
+	}
+	catch (std::runtime_error const& error)
+	{
+		EXPECT_NE(std::string_view{error.what()}.find(reason),
+		          std::string_view::npos)
+		    << error.what();
+	}
+}
+
+class asset_pack_test : public testing::Test
+{
+protected:
+	std::filesystem::path path{};
+
+	void SetUp() override
+	{
+		auto const* test =
+		    testing::UnitTest::GetInstance()->current_test_info();
+		path = std::filesystem::path{testing::TempDir()} /
+		       (std::string{test->name()} + ".pack");
+	}
+
+	void TearDown() override
+	{
+		std::filesystem::remove(path);
+	}
+
+	void write(std::span<std::byte const> bytes) const
+	{
+		std::ofstream file{path, std::ios::binary | std::ios::trunc};
+		file.write(reinterpret_cast<char const*>(std::data(bytes)),
+		           static_cast<std::streamsize>(std::size(bytes)));
+	}
+};
+
+TEST_F(asset_pack_test, reads_a_well_formed_pack)
+{
+	write(make_pack());
+
+	asset_pack const pack{path};
+	EXPECT_EQ(pack.shader(shader_name), shader_source);
+	EXPECT_EQ(pack.shader("assets/shaders/missing.glsl"), std::nullopt);
+}
+
+TEST_F(asset_pack_test, rejects_a_truncated_pack)
+{
+	auto const bytes = make_pack();
+	auto const directory_offset =
+	    read_at<pack_header>(bytes, 0).directory_offset;
+
+	// Empty, within and just after the header, without the directory, within
+	// the entry, and one byte short of the names.
+	auto const sizes = std::array<std::size_t, 6>{
+	    0,
+	    sizeof(pack_header) - 1,
+	    sizeof(pack_header),
+	    directory_offset,
+	    directory_offset + sizeof(pack_entry) - 1,
+	    std::size(bytes) - 1};
+
+	for (auto const size: sizes)
+	{
+		write(std::span{bytes}.first(size));
+		EXPECT_THROW(asset_pack{path}, std::runtime_error)
+		    << "cut to " << size << " bytes";
+	}
+}
+
+TEST_F(asset_pack_test, rejects_a_pack_from_another_version)
+{
+	auto bytes = make_pack();
+	write_at(bytes, offsetof(pack_header, version), pack_version + 1);
+	write(bytes);
+
+	expect_rejected(path, "another version");
+}
+
+TEST_F(asset_pack_test, rejects_another_kind_of_file)
+{
+	auto bytes = make_pack();
+	write_at(bytes,
+	         offsetof(pack_header, magic),
+	         std::array<char, 4>{'R', 'I', 'F', 'F'});
+	write(bytes);
+
+	expect_rejected(path, "not an asset pack");
+}
+
+TEST_F(asset_pack_test, rejects_an_entry_reaching_into_the_directory)
+{
+	auto       bytes = make_pack();
+	auto const directory_offset =
+	    read_at<pack_header>(bytes, 0).directory_offset;
+
+	auto entry = read_at<pack_entry>(bytes, directory_offset);
+	entry.size = directory_offset - entry.offset + 1;
+	write_at(bytes, directory_offset, entry);
+	write(bytes);
+
+	expect_rejected(path, "corrupt directory");
+}
+} // namespace
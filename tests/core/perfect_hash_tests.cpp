@@ -0,0 +1,163 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#include "yaboc/core/perfect_hash.h"
+
+#include "gtest/gtest.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace
+{
+using namespace yaboc::core;
+
+constexpr std::size_t large_count{10'000};
+
+struct built_hash final
+{
+	std::vector<std::uint32_t> seeds{};
+	std::vector<std::uint32_t> positions{};
+};
+
+auto build(std::span<std::string_view const> keys) -> built_hash
+{
+	built_hash hash{.seeds = std::vector<std::uint32_t>(std::size(keys)),
+	                .positions = std::vector<std::uint32_t>(std::size(keys))};
+	build_perfect_hash(keys, hash.seeds, hash.positions);
+	return hash;
+}
+
+void expect_every_key_round_trips(std::span<std::string_view const> keys)
+{
+	auto const hash = build(keys);
+
+	std::vector<bool> seen(std::size(keys));
+	for (std::size_t key{}; key < std::size(keys); ++key)
+	{
+		auto const index = perfect_hash_index(hash.seeds, keys[key]);
+		ASSERT_LT(index, std::size(keys));
+		EXPECT_FALSE(seen[index]) << keys[key] << " shares an index";
+		seen[index] = true;
+
+		EXPECT_EQ(perfect_hash_position(hash.seeds, hash.positions, keys[key]),
+		          key)
+		    << keys[key];
+	}
+}
+
+// Distinct random names, like the frame names of a large sheet.
+auto make_random_names(std::size_t count, std::mt19937& random)
+    -> std::vector<std::string>
+{
+	// NOLINTBEGIN(*-magic-numbers)
+	std::uniform_int_distribution<std::size_t> length{1, 24};
+	std::uniform_int_distribution<int>         character{'_', 'z'};
+	// NOLINTEND(*-magic-numbers)
+
+	std::unordered_set<std::string> seen{};
+	std::vector<std::string>        names{};
+	while (std::size(names) < count)
+	{
+		std::string name(length(random), '\0');
+		for (auto& letter: name)
+		{
+			letter = static_cast<char>(character(random));
+		}
+		if (seen.insert(name).second)
+		{
+			names.push_back(std::move(name));
+		}
+	}
+	return names;
+}
+
+TEST(perfect_hash, round_trips_a_single_key)
+{
+	constexpr auto keys = std::array<std::string_view, 1>{"paddle"};
+	expect_every_key_round_trips(keys);
+}
+
+TEST(perfect_hash, round_trips_two_keys)
+{
+	constexpr auto keys = std::array<std::string_view, 2>{"ball", "brick"};
+	expect_every_key_round_trips(keys);
+}
+
+TEST(perfect_hash, round_trips_a_large_random_set)
+{
+	std::mt19937 random{1}; // NOLINT(*-magic-numbers)
+
+	auto const names = make_random_names(large_count, random);
+	auto const keys = std::vector<std::string_view>(std::begin(names),
+	                                                std::end(names));
+	expect_every_key_round_trips(keys);
+}
+
+TEST(perfect_hash, round_trips_while_compiling)
+{
+	static constexpr auto keys =
+	    std::array<std::string_view, 3>{"ball", "brick", "paddle"};
+	static constexpr auto hash = make_perfect_hash(keys);
+
+	static_assert(perfect_hash_position(hash.seeds, hash.positions, "ball") ==
+	              0);
+	static_assert(perfect_hash_position(hash.seeds, hash.positions, "brick") ==
+	              1);
+	static_assert(
+	    perfect_hash_position(hash.seeds, hash.positions, "paddle") == 2);
+}
+
+TEST(perfect_hash, rejects_duplicate_keys)
+{
+	constexpr auto keys =
+	    std::array<std::string_view, 3>{"ball", "brick", "ball"};
+
+	std::array<std::uint32_t, 3> seeds{};
+	std::array<std::uint32_t, 3> positions{};
+	EXPECT_THROW(build_perfect_hash(keys, seeds, positions),
+	             std::invalid_argument);
+}
+
+TEST(perfect_hash, maps_other_strings_into_range)
+{
+	std::mt19937 random{2}; // NOLINT(*-magic-numbers)
+
+	// The first half are keys and the rest are not.
+	constexpr std::size_t key_count{100};
+	auto const names = make_random_names(2 * key_count, random);
+	auto const keys = std::vector<std::string_view>(
+	    std::begin(names), std::next(std::begin(names), key_count));
+	auto const hash = build(keys);
+
+	for (std::size_t other{key_count}; other < std::size(names); ++other)
+	{
+		EXPECT_LT(perfect_hash_index(hash.seeds, names[other]), key_count);
+		EXPECT_LT(
+		    perfect_hash_position(hash.seeds, hash.positions, names[other]),
+		    key_count);
+	}
+}
+} // namespace
@@ -0,0 +1,180 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#include "yaboc/ecs/systems/collision_system.h"
+
+#include "yaboc/ecs/components/all.h"
+
+#include "entt/entt.hpp"
+#include "glm/glm.hpp"
+#include "gtest/gtest.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace
+{
+using namespace yaboc::ecs;
+
+constexpr glm::vec2 brick_pitch{2.0F, 1.0F};
+constexpr glm::vec2 ball_size{0.5F, 0.5F};
+
+class collision_system_test : public testing::Test
+{
+protected:
+	// Declared before the system, which disconnects from it on destruction.
+	entt::registry               registry{};
+	std::vector<system::contact> contacts{};
+
+	auto add_brick(glm::vec2 position, glm::vec2 size = brick_pitch)
+	    -> entt::entity
+	{
+		auto const brick = registry.create();
+		registry.emplace<components::transform>(brick, position);
+		registry.emplace<components::sprite>(
+		    brick, components::sprite_frame{}, size, glm::vec4{1.0F});
+		registry.emplace<tags::brick>(brick);
+		return brick;
+	}
+
+	auto add_ball(glm::vec2 position, glm::vec2 direction, glm::vec2 speed)
+	    -> entt::entity
+	{
+		auto const ball = registry.create();
+		registry.emplace<components::transform>(ball, position);
+		registry.emplace<components::sprite>(
+		    ball, components::sprite_frame{}, ball_size, glm::vec4{1.0F});
+		registry.emplace<components::direction>(
+		    ball, direction.x, direction.y);
+		registry.emplace<components::velocity>(ball, speed.x, speed.y);
+		registry.emplace<tags::ball>(ball);
+		return ball;
+	}
+
+	[[nodiscard]]
+	auto position_of(entt::entity entity) -> glm::vec2
+	{
+		return registry.get<components::transform>(entity).position;
+	}
+
+	[[nodiscard]]
+	auto direction_of(entt::entity entity) -> glm::vec2
+	{
+		auto const direction = registry.get<components::direction>(entity);
+		return {direction.horizontal, direction.vertical};
+	}
+};
+
+TEST_F(collision_system_test, bounces_off_a_thin_brick_at_any_speed)
+{
+	// Far thinner than the distance the ball covers in the tick.
+	constexpr glm::vec2 thin_brick{2.0F, 0.1F};
+	auto const brick = add_brick({10.0F, 10.0F}, thin_brick);
+	auto const ball = add_ball({10.0F, 2.0F}, {0.0F, 1.0F}, {0.0F, 1'000.0F});
+
+	system::collision_system collide{registry, brick_pitch, thin_brick};
+	collide(1.0F / 60.0F, contacts);
+
+	ASSERT_EQ(std::size(contacts), 1U);
+	EXPECT_EQ(contacts[0].ball, ball);
+	EXPECT_EQ(contacts[0].other, brick);
+	EXPECT_EQ(contacts[0].normal, glm::vec2(0.0F, -1.0F));
+	EXPECT_EQ(direction_of(ball), glm::vec2(0.0F, -1.0F));
+	EXPECT_LT(position_of(ball).y, 10.0F - thin_brick.y / 2.0F);
+}
+
+TEST_F(collision_system_test, bounces_back_from_an_exact_corner)
+{
+	// The ball's corner meets the brick's halfway through the tick.
+	auto const brick = add_brick({10.0F, 10.0F});
+	auto const ball = add_ball({8.5F, 9.0F}, {1.0F, 1.0F}, {1.0F, 1.0F});
+
+	system::collision_system collide{registry, brick_pitch, brick_pitch};
+	collide(0.5F, contacts);
+
+	ASSERT_EQ(std::size(contacts), 1U);
+	EXPECT_EQ(contacts[0].other, brick);
+	EXPECT_EQ(contacts[0].normal, glm::vec2(-1.0F, -1.0F));
+	EXPECT_FLOAT_EQ(contacts[0].time, 0.5F);
+	EXPECT_EQ(direction_of(ball), glm::vec2(-1.0F, -1.0F));
+	EXPECT_EQ(position_of(ball), glm::vec2(8.5F, 9.0F));
+}
+
+TEST_F(collision_system_test, slides_past_a_face_it_only_grazes)
+{
+	// The top of the ball runs along the bottom of the brick.
+	add_brick({10.0F, 10.0F});
+	auto const ball = add_ball({5.0F, 9.25F}, {1.0F, 1.0F}, {10.0F, 0.0F});
+
+	system::collision_system collide{registry, brick_pitch, brick_pitch};
+	collide(1.0F, contacts);
+
+	EXPECT_TRUE(std::empty(contacts));
+	EXPECT_EQ(position_of(ball), glm::vec2(15.0F, 9.25F));
+	EXPECT_EQ(direction_of(ball), glm::vec2(1.0F, 1.0F));
+}
+
+TEST_F(collision_system_test, leaves_a_ball_that_does_not_move_alone)
+{
+	add_brick({10.0F, 10.0F});
+	auto const ball = add_ball({10.0F, 9.25F}, {0.0F, 1.0F}, {0.0F, 0.0F});
+
+	system::collision_system collide{registry, brick_pitch, brick_pitch};
+	collide(1.0F, contacts);
+
+	EXPECT_TRUE(std::empty(contacts));
+	EXPECT_EQ(position_of(ball), glm::vec2(10.0F, 9.25F));
+	EXPECT_EQ(direction_of(ball), glm::vec2(0.0F, 1.0F));
+}
+
+TEST_F(collision_system_test, pushes_out_a_ball_that_starts_inside_a_brick)
+{
+	auto const brick = add_brick({10.0F, 10.0F});
+	auto const ball = add_ball({10.0F, 9.5F}, {0.0F, 1.0F}, {0.0F, 1.0F});
+
+	system::collision_system collide{registry, brick_pitch, brick_pitch};
+	collide(1.0F, contacts);
+
+	ASSERT_EQ(std::size(contacts), 1U);
+	EXPECT_EQ(contacts[0].other, brick);
+	EXPECT_EQ(contacts[0].normal, glm::vec2(0.0F, -1.0F));
+	EXPECT_FLOAT_EQ(contacts[0].time, 0.0F);
+	EXPECT_EQ(direction_of(ball), glm::vec2(0.0F, -1.0F));
+	// Out below the brick, then on down for the whole tick.
+	EXPECT_FLOAT_EQ(position_of(ball).y, 8.25F);
+}
+
+TEST_F(collision_system_test, hits_several_bricks_in_one_tick)
+{
+	auto const below = add_brick({10.0F, 10.0F});
+	auto const above = add_brick({10.0F, 14.0F});
+	auto const ball = add_ball({10.0F, 12.0F}, {0.0F, 1.0F}, {0.0F, 10.0F});
+
+	system::collision_system collide{registry, brick_pitch, brick_pitch};
+	collide(1.0F, contacts);
+
+	// Up into the brick above, down into the one below, then back up through
+	// where the first was, as broken bricks are not hit twice.
+	ASSERT_EQ(std::size(contacts), 2U);
+	EXPECT_EQ(contacts[0].other, above);
+	EXPECT_EQ(contacts[0].normal, glm::vec2(0.0F, -1.0F));
+	EXPECT_FLOAT_EQ(contacts[0].time, 0.125F);
+	EXPECT_EQ(contacts[1].other, below);
+	EXPECT_EQ(contacts[1].normal, glm::vec2(0.0F, 1.0F));
+	EXPECT_FLOAT_EQ(contacts[1].time, 0.375F);
+	EXPECT_EQ(direction_of(ball), glm::vec2(0.0F, 1.0F));
+	EXPECT_FLOAT_EQ(position_of(ball).y, 17.0F);
+}
+} // namespace
@@ -0,0 +1,244 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#include "yaboc/ecs/scheduler.h"
+
+#include "yaboc/core/thread_pool.h"
+#include "yaboc/ecs/command_buffer.h"
+#include "yaboc/ecs/components/all.h"
+
+#include "entt/entt.hpp"
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <numeric>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+using namespace yaboc;
+using namespace yaboc::ecs;
+
+constexpr std::size_t worker_count{4};
+constexpr std::size_t item_count{1'000};
+constexpr std::size_t grain{16};
+constexpr std::size_t failing_item{item_count / 2};
+constexpr std::size_t system_count{8};
+
+// How long a system waits for another to join it before giving up, far
+// beyond what it takes when the scheduler lets them overlap.
+constexpr std::chrono::seconds overlap_timeout{10};
+
+TEST(scheduler, rethrows_from_a_parallel_for_and_applies_nothing)
+{
+	entt::registry    registry{};
+	core::thread_pool workers{worker_count};
+	scheduler         systems{&workers};
+
+	auto const doomed = registry.create();
+	auto const target = registry.create();
+
+	std::size_t recorded_runs{};
+	bool        fail{true};
+
+	// Records its commands before the one reading velocity starts.
+	systems.add<components::velocity>(
+	    "record",
+	    [doomed, target, &recorded_runs](entt::registry& /*registry*/,
+	                                     command_buffer& commands) {
+		    commands.destroy(doomed);
+		    commands.emplace_or_replace<components::velocity>(
+		        target, 1.0F, 2.0F);
+		    commands.record(
+		        [&recorded_runs](entt::registry& /*registry*/) {
+			        ++recorded_runs;
+		        });
+	    });
+	systems.add<components::velocity const>(
+	    "fail",
+	    [&workers, &fail](entt::registry& /*registry*/,
+	                      command_buffer& /*commands*/) {
+		    std::atomic<std::size_t> visited{};
+		    workers.parallel_for(
+		        item_count,
+		        grain,
+		        [&visited, &fail](std::size_t begin, std::size_t end) {
+			        visited += end - begin;
+			        if (fail && begin <= failing_item && failing_item < end)
+			        {
+				        throw std::runtime_error{"system failed"};
+			        }
+		        });
+		    if (!fail)
+		    {
+			    EXPECT_EQ(visited.load(), item_count);
+		    }
+	    });
+
+	EXPECT_THROW(systems.run(registry), std::runtime_error);
+	EXPECT_TRUE(registry.valid(doomed));
+	EXPECT_FALSE(registry.all_of<components::velocity>(target));
+	EXPECT_EQ(recorded_runs, 0U);
+
+	// What the failed run recorded is gone, not applied by the next one.
+	fail = false;
+	systems.run(registry);
+	EXPECT_FALSE(registry.valid(doomed));
+	EXPECT_TRUE(registry.all_of<components::velocity>(target));
+	EXPECT_EQ(recorded_runs, 1U);
+}
+
+TEST(scheduler, runs_systems_writing_a_component_in_the_order_added)
+{
+	entt::registry    registry{};
+	core::thread_pool workers{worker_count};
+	scheduler         systems{&workers};
+
+	std::mutex               order_mutex{};
+	std::vector<std::size_t> order{};
+
+	for (std::size_t system{}; system < system_count; ++system)
+	{
+		systems.add<components::velocity>(
+		    "write " + std::to_string(system),
+		    [system, &order_mutex, &order](entt::registry& /*registry*/,
+		                                   command_buffer& /*commands*/) {
+			    // The first added sleep longest, so any that were let run
+			    // at the same time would finish out of order.
+			    std::this_thread::sleep_for(
+			        std::chrono::milliseconds{system_count - system});
+
+			    std::scoped_lock const lock{order_mutex};
+			    order.push_back(system);
+		    });
+	}
+
+	std::vector<std::size_t> added(system_count);
+	std::iota(std::begin(added), std::end(added), std::size_t{});
+
+	constexpr std::size_t runs{3};
+	for (std::size_t run{}; run < runs; ++run)
+	{
+		order.clear();
+		systems.run(registry);
+		EXPECT_EQ(order, added);
+	}
+}
+
+TEST(scheduler, lets_systems_reading_a_component_overlap)
+{
+	entt::registry    registry{};
+	core::thread_pool workers{worker_count};
+	scheduler         systems{&workers};
+
+	constexpr std::size_t    reader_count{2};
+	std::atomic<std::size_t> started{};
+	std::atomic<std::size_t> overlapped{};
+
+	for (std::size_t reader{}; reader < reader_count; ++reader)
+	{
+		systems.add<components::velocity const>(
+		    "read " + std::to_string(reader),
+		    [&started, &overlapped](entt::registry& /*registry*/,
+		                            command_buffer& /*commands*/) {
+			    ++started;
+
+			    // Each waits for the other, which only returns early if
+			    // both are running at once.
+			    auto const deadline =
+			        std::chrono::steady_clock::now() + overlap_timeout;
+			    while (started.load() < reader_count &&
+			           std::chrono::steady_clock::now() < deadline)
+			    {
+				    std::this_thread::yield();
+			    }
+
+			    if (started.load() == reader_count)
+			    {
+				    ++overlapped;
+			    }
+		    });
+	}
+
+	systems.run(registry);
+	EXPECT_EQ(overlapped.load(), reader_count);
+}
+
+TEST(scheduler, applies_every_command_recorded_on_the_workers)
+{
+	entt::registry    registry{};
+	core::thread_pool workers{worker_count};
+	scheduler         systems{&workers};
+
+	std::vector<entt::entity> targets(system_count);
+	std::vector<entt::entity> doomed(system_count);
+	for (std::size_t system{}; system < system_count; ++system)
+	{
+		targets[system] = registry.create();
+		doomed[system] = registry.create();
+	}
+
+	std::mutex                threads_mutex{};
+	std::set<std::thread::id> threads{};
+	std::atomic<std::size_t>  applied{};
+
+	// Read only, so that they are spread over the workers.
+	for (std::size_t system{}; system < system_count; ++system)
+	{
+		systems.add<components::velocity const>(
+		    "record " + std::to_string(system),
+		    [system, &targets, &doomed, &threads_mutex, &threads, &applied](
+		        entt::registry& /*registry*/,
+		        command_buffer& commands) {
+			    {
+				    std::scoped_lock const lock{threads_mutex};
+				    threads.insert(std::this_thread::get_id());
+			    }
+
+			    commands.emplace_or_replace<components::velocity>(
+			        targets[system], static_cast<float>(system), 0.0F);
+			    commands.destroy(doomed[system]);
+			    commands.record(
+			        [&applied](entt::registry& /*registry*/) { ++applied; });
+
+			    // Long enough for the other workers to take the rest.
+			    std::this_thread::sleep_for(std::chrono::milliseconds{5});
+		    });
+	}
+
+	systems.run(registry);
+
+	EXPECT_GT(std::size(threads), 1U);
+	EXPECT_EQ(applied.load(), system_count);
+	for (std::size_t system{}; system < system_count; ++system)
+	{
+		ASSERT_TRUE(registry.all_of<components::velocity>(targets[system]));
+		EXPECT_EQ(registry.get<components::velocity>(targets[system]).x,
+		          static_cast<float>(system));
+		EXPECT_FALSE(registry.valid(doomed[system]));
+	}
+
+	// The buffers were emptied, so nothing is applied twice.
+	systems.run(registry);
+	EXPECT_EQ(applied.load(), 2 * system_count);
+}
+} // namespace
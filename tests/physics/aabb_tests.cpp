@@ -0,0 +1,179 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#include "yaboc/physics/aabb.h"
+
+#include "glm/glm.hpp"
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace
+{
+using namespace yaboc::physics;
+
+// A unit box with its corner at the origin.
+constexpr aabb unit_box{.min = {0.0F, 0.0F}, .max = {1.0F, 1.0F}};
+
+// Every count up to a few blocks of four, so that each leaves every possible
+// tail, and a large one.
+constexpr std::size_t max_small_count{13};
+constexpr std::size_t large_count{1'001};
+
+// Corners on a coarse grid, so that many boxes only touch the query box and
+// some have no area at all.
+auto make_random_box(std::mt19937& random) -> aabb
+{
+	// NOLINTNEXTLINE(*-magic-numbers)
+	std::uniform_int_distribution<int> coordinate{0, 8};
+
+	std::array<float, 4> corners{};
+	for (auto& corner: corners)
+	{
+		corner = static_cast<float>(coordinate(random));
+	}
+	return {.min = {std::min(corners[0], corners[1]),
+	                std::min(corners[2], corners[3])},
+	        .max = {std::max(corners[0], corners[1]),
+	                std::max(corners[2], corners[3])}};
+}
+
+void expect_find_overlaps_matches_scalar(std::size_t   count,
+                                         std::mt19937& random)
+{
+	aabb_batch batch{};
+	for (std::size_t i{}; i < count; ++i)
+	{
+		batch.push_back(make_random_box(random));
+	}
+
+	auto const box = make_random_box(random);
+
+	std::vector<std::uint32_t> expected{};
+	for (std::size_t i{}; i < count; ++i)
+	{
+		if (overlaps(box, batch[i]))
+		{
+			expected.push_back(static_cast<std::uint32_t>(i));
+		}
+	}
+
+	std::vector<std::uint32_t> hits(count);
+	hits.resize(find_overlaps(box, batch, hits));
+	EXPECT_EQ(hits, expected) << "with " << count << " boxes";
+}
+
+TEST(find_overlaps, matches_scalar_for_every_tail)
+{
+	std::mt19937 random{1}; // NOLINT(*-magic-numbers)
+
+	// Several batches of each size, as one query hits only a few boxes.
+	constexpr std::size_t queries{16};
+	for (std::size_t count{}; count <= max_small_count; ++count)
+	{
+		for (std::size_t query{}; query < queries; ++query)
+		{
+			expect_find_overlaps_matches_scalar(count, random);
+		}
+	}
+}
+
+TEST(find_overlaps, matches_scalar_for_a_large_batch)
+{
+	std::mt19937 random{2}; // NOLINT(*-magic-numbers)
+
+	expect_find_overlaps_matches_scalar(large_count, random);
+}
+
+TEST(find_overlaps, ignores_boxes_that_only_touch)
+{
+	aabb_batch batch{};
+	batch.push_back({.min = {1.0F, 0.0F}, .max = {2.0F, 1.0F}});
+	batch.push_back({.min = {0.0F, -1.0F}, .max = {1.0F, 0.0F}});
+	batch.push_back({.min = {0.5F, 0.5F}, .max = {1.5F, 1.5F}});
+	batch.push_back({.min = {-1.0F, -1.0F}, .max = {0.0F, 0.0F}});
+
+	std::vector<std::uint32_t> hits(batch.size());
+	hits.resize(find_overlaps(unit_box, batch, hits));
+	EXPECT_EQ(hits, std::vector<std::uint32_t>{2});
+}
+
+TEST(find_impact, stops_at_a_thin_obstacle_however_fast)
+{
+	constexpr aabb wall{.min = {10.0F, -1.0F}, .max = {10.01F, 2.0F}};
+	constexpr glm::vec2 displacement{1'000.0F, 0.0F};
+
+	auto const impact = find_impact(unit_box, displacement, wall);
+
+	ASSERT_TRUE(impact.has_value());
+	EXPECT_FLOAT_EQ(impact->time, 9.0F / 1'000.0F);
+	EXPECT_EQ(impact->normal, glm::vec2(-1.0F, 0.0F));
+}
+
+TEST(find_impact, reports_both_normals_at_an_exact_corner)
+{
+	constexpr aabb      obstacle{.min = {2.0F, 2.0F}, .max = {3.0F, 3.0F}};
+	constexpr glm::vec2 displacement{2.0F, 2.0F};
+
+	auto const impact = find_impact(unit_box, displacement, obstacle);
+
+	ASSERT_TRUE(impact.has_value());
+	EXPECT_FLOAT_EQ(impact->time, 0.5F);
+	EXPECT_EQ(impact->normal, glm::vec2(-1.0F, -1.0F));
+}
+
+TEST(find_impact, ignores_a_face_it_only_grazes)
+{
+	// The top of the box slides along the bottom of the obstacle.
+	constexpr aabb      obstacle{.min = {2.0F, 1.0F}, .max = {3.0F, 2.0F}};
+	constexpr glm::vec2 displacement{5.0F, 0.0F};
+
+	EXPECT_FALSE(find_impact(unit_box, displacement, obstacle).has_value());
+}
+
+TEST(find_impact, never_hits_without_moving)
+{
+	constexpr aabb apart{.min = {2.0F, 0.0F}, .max = {3.0F, 1.0F}};
+	constexpr aabb overlapping{.min = {0.5F, 0.5F}, .max = {1.5F, 1.5F}};
+
+	EXPECT_FALSE(find_impact(unit_box, {}, apart).has_value());
+	EXPECT_FALSE(find_impact(unit_box, {}, overlapping).has_value());
+}
+
+TEST(find_impact, leaves_overlaps_it_starts_in_to_find_penetration)
+{
+	constexpr aabb      obstacle{.min = {0.0F, 0.75F}, .max = {1.0F, 2.0F}};
+	constexpr glm::vec2 displacement{0.0F, 1.0F};
+
+	EXPECT_FALSE(find_impact(unit_box, displacement, obstacle).has_value());
+
+	auto const [normal, depth] = find_penetration(unit_box, obstacle);
+	EXPECT_EQ(normal, glm::vec2(0.0F, -1.0F));
+	EXPECT_FLOAT_EQ(depth, 0.25F);
+}
+
+TEST(find_impact, misses_what_it_does_not_reach_or_moves_away_from)
+{
+	constexpr aabb obstacle{.min = {3.0F, 0.0F}, .max = {4.0F, 1.0F}};
+
+	EXPECT_FALSE(find_impact(unit_box, {1.0F, 0.0F}, obstacle).has_value());
+	EXPECT_FALSE(find_impact(unit_box, {-5.0F, 0.0F}, obstacle).has_value());
+}
+} // namespace
@@ -0,0 +1,263 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#include "yaboc/physics/brick_grid.h"
+
+#include "entt/entt.hpp"
+#include "glm/glm.hpp"
+#include "gtest/gtest.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace
+{
+using namespace yaboc::physics;
+
+// Powers of two apart, so that every edge below is exact and a box touching
+// a brick does so exactly.
+constexpr glm::vec2 pitch{1.0F, 0.5F};
+constexpr glm::vec2 brick_size{0.75F, 0.25F};
+constexpr glm::vec2 group_offset{3.0F, -2.0F};
+
+// Wide enough that rows span several words of the occupancy bitset.
+constexpr int columns{100};
+constexpr int rows{6};
+
+// Large enough to reach every cell, and far beyond.
+constexpr aabb everything{.min = {-1'000.0F, -1'000.0F},
+                          .max = {1'000.0F, 1'000.0F}};
+
+struct gathered final
+{
+	std::vector<entt::entity> bricks{};
+	aabb_batch                boxes{};
+};
+
+auto gather(brick_grid const& grid, aabb const& box, glm::vec2 offset = {})
+    -> gathered
+{
+	gathered result{};
+	grid.gather(box, offset, result.bricks, result.boxes);
+	return result;
+}
+
+auto brick_box(glm::ivec2 cell, glm::vec2 offset = {}) -> aabb
+{
+	return make_aabb(glm::vec2{cell} * pitch + offset, brick_size);
+}
+
+auto brick_position(glm::ivec2 cell) -> glm::vec2
+{
+	return glm::vec2{cell} * pitch;
+}
+
+void expect_same_box(aabb const& actual, aabb const& expected)
+{
+	EXPECT_EQ(actual.min, expected.min);
+	EXPECT_EQ(actual.max, expected.max);
+}
+
+TEST(brick_grid, gathers_exactly_the_bricks_random_boxes_overlap)
+{
+	std::mt19937 random{1}; // NOLINT(*-magic-numbers)
+
+	// NOLINTBEGIN(*-magic-numbers)
+	std::bernoulli_distribution        taken{0.5};
+	// Corners in eighths, from a little outside the grid on either side.
+	std::uniform_int_distribution<int> eighths_x{-16, (columns + 2) * 8};
+	std::uniform_int_distribution<int> eighths_y{-16, (rows + 2) * 4};
+	std::uniform_int_distribution<int> extent{0, 48};
+	// NOLINTEND(*-magic-numbers)
+
+	brick_grid                grid{pitch, brick_size};
+	std::vector<glm::ivec2>   cells{};
+	std::vector<entt::entity> bricks{};
+	for (auto y = 0; y < rows; ++y)
+	{
+		for (auto x = 0; x < columns; ++x)
+		{
+			if (taken(random))
+			{
+				auto const brick =
+				    entt::entity{static_cast<std::uint32_t>(std::size(bricks))};
+				grid.insert(brick, brick_position({x, y}));
+				cells.emplace_back(x, y);
+				bricks.push_back(brick);
+			}
+		}
+	}
+	ASSERT_EQ(grid.size(), std::size(bricks));
+
+	constexpr std::size_t queries{500};
+	for (std::size_t query{}; query < queries; ++query)
+	{
+		// NOLINTNEXTLINE(*-magic-numbers)
+		constexpr float eighth{0.125F};
+		glm::vec2 const min{static_cast<float>(eighths_x(random)) * eighth,
+		                    static_cast<float>(eighths_y(random)) * eighth};
+		glm::vec2 const size{static_cast<float>(extent(random)) * eighth,
+		                     static_cast<float>(extent(random)) * eighth};
+		aabb const      box{.min = min, .max = min + size};
+
+		// Cells were filled in the order the grid walks them.
+		gathered expected{};
+		for (std::size_t i{}; i < std::size(cells); ++i)
+		{
+			auto const candidate = brick_box(cells[i], group_offset);
+			if (overlaps(box, candidate))
+			{
+				expected.bricks.push_back(bricks[i]);
+				expected.boxes.push_back(candidate);
+			}
+		}
+
+		auto const actual = gather(grid, box, group_offset);
+		ASSERT_EQ(actual.bricks, expected.bricks);
+		for (std::size_t i{}; i < std::size(actual.bricks); ++i)
+		{
+			expect_same_box(actual.boxes[i], expected.boxes[i]);
+		}
+	}
+}
+
+TEST(brick_grid, leaves_out_bricks_a_box_only_touches)
+{
+	constexpr glm::ivec2   cell{2, 1};
+	constexpr entt::entity brick{1};
+
+	brick_grid grid{pitch, brick_size};
+	grid.insert(brick, brick_position(cell));
+
+	constexpr float depth{0.125F};
+	constexpr aabb  around{.min = {-10.0F, -10.0F}, .max = {10.0F, 10.0F}};
+	auto const      edges = brick_box(cell);
+
+	// Boxes ending on or starting at each edge of the brick, and the same
+	// reaching just into it.
+	auto left = around;
+	left.max.x = edges.min.x;
+	auto right = around;
+	right.min.x = edges.max.x;
+	auto below = around;
+	below.max.y = edges.min.y;
+	auto above = around;
+	above.min.y = edges.max.y;
+
+	for (auto const& box: {left, right, below, above})
+	{
+		EXPECT_TRUE(gather(grid, box).bricks.empty());
+	}
+
+	left.max.x += depth;
+	right.min.x -= depth;
+	below.max.y += depth;
+	above.min.y -= depth;
+
+	for (auto const& box: {left, right, below, above})
+	{
+		EXPECT_EQ(gather(grid, box).bricks, std::vector{brick});
+	}
+}
+
+TEST(brick_grid, erase_removes_only_that_brick)
+{
+	constexpr auto bricks =
+	    std::array{entt::entity{0}, entt::entity{1}, entt::entity{2}};
+
+	brick_grid grid{pitch, brick_size};
+	for (auto x = 0; x < static_cast<int>(std::size(bricks)); ++x)
+	{
+		grid.insert(bricks[static_cast<std::size_t>(x)],
+		            brick_position({x, 0}));
+	}
+
+	grid.erase(bricks[1]);
+	EXPECT_EQ(grid.size(), 2U);
+	EXPECT_EQ(gather(grid, everything).bricks,
+	          (std::vector{bricks[0], bricks[2]}));
+
+	// Neither a second erase nor one of a brick never inserted changes
+	// anything.
+	grid.erase(bricks[1]);
+	grid.erase(entt::entity{42}); // NOLINT(*-magic-numbers)
+	EXPECT_EQ(grid.size(), 2U);
+	EXPECT_EQ(gather(grid, everything).bricks,
+	          (std::vector{bricks[0], bricks[2]}));
+}
+
+TEST(brick_grid, a_brick_in_a_taken_cell_replaces_the_occupant)
+{
+	constexpr entt::entity first{0};
+	constexpr entt::entity second{1};
+
+	brick_grid grid{pitch, brick_size};
+	grid.insert(first, brick_position({1, 0}));
+	grid.insert(second, brick_position({1, 0}));
+
+	EXPECT_EQ(grid.size(), 1U);
+	EXPECT_EQ(gather(grid, everything).bricks, std::vector{second});
+
+	// The replaced brick is no longer in the grid to erase.
+	grid.erase(first);
+	EXPECT_EQ(gather(grid, everything).bricks, std::vector{second});
+}
+
+TEST(brick_grid, inserting_a_brick_again_moves_it)
+{
+	constexpr entt::entity brick{0};
+	constexpr glm::ivec2   to{4, 1};
+
+	brick_grid grid{pitch, brick_size};
+	grid.insert(brick, brick_position({1, 0}));
+	grid.insert(brick, brick_position(to));
+
+	EXPECT_EQ(grid.size(), 1U);
+	auto const found = gather(grid, everything);
+	ASSERT_EQ(found.bricks, std::vector{brick});
+	expect_same_box(found.boxes[0], brick_box(to));
+}
+
+TEST(brick_grid, growing_keeps_the_bricks_in_their_cells)
+{
+	constexpr entt::entity near{0};
+	constexpr entt::entity far{1};
+	constexpr glm::ivec2   far_cell{70, 3};
+
+	brick_grid grid{pitch, brick_size};
+	grid.insert(near, brick_position({0, 0}));
+	grid.insert(far, brick_position(far_cell));
+
+	auto const found = gather(grid, everything);
+	ASSERT_EQ(found.bricks, (std::vector{near, far}));
+	expect_same_box(found.boxes[0], brick_box({0, 0}));
+	expect_same_box(found.boxes[1], brick_box(far_cell));
+}
+
+TEST(brick_grid, clear_removes_every_brick)
+{
+	brick_grid grid{pitch, brick_size};
+	grid.insert(entt::entity{0}, brick_position({0, 0}));
+	grid.insert(entt::entity{1}, brick_position({3, 2}));
+
+	grid.clear();
+
+	EXPECT_EQ(grid.size(), 0U);
+	EXPECT_TRUE(gather(grid, everything).bricks.empty());
+}
+} // namespace
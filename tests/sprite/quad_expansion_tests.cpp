@@ -0,0 +1,258 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#include "yaboc/sprite/quad_expansion.h"
+
+#include "glm/glm.hpp"
+#include "gtest/gtest.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <span>
+#include <vector>
+
+namespace
+{
+using namespace yaboc::sprite;
+
+constexpr float       pixels_per_metre{64.0F};
+constexpr std::size_t verts_per_quad{6};
+// Wider than any kernel's stream alignment.
+constexpr std::size_t buffer_alignment{64};
+constexpr std::size_t guard_size{64};
+constexpr std::byte   guard{0xCD};
+
+// Every count up to a few blocks of the widest kernel, so that each leaves
+// every possible tail, and a couple of large ones.
+constexpr std::size_t max_small_count{40};
+constexpr auto        large_counts = std::array<std::size_t, 2>{127, 1'001};
+
+// Destinations that start on, just past, and between stream boundaries.
+constexpr auto misalignments = std::array<std::size_t, 6>{0, 4, 8, 12, 20, 28};
+
+struct batch final
+{
+	std::vector<float>         x{};
+	std::vector<float>         y{};
+	std::vector<float>         width{};
+	std::vector<float>         height{};
+	std::vector<glm::vec4>     uv_bounds{};
+	std::vector<glm::vec4>     tint{};
+	std::vector<std::uint32_t> layer{};
+
+	[[nodiscard]]
+	auto input() const -> sprite_batch_input
+	{
+		return {.x = x,
+		        .y = y,
+		        .width = width,
+		        .height = height,
+		        .uv_bounds = uv_bounds,
+		        .tint = tint,
+		        .layer = layer};
+	}
+};
+
+auto make_random_batch(std::size_t count, std::mt19937& random) -> batch
+{
+	// NOLINTBEGIN(*-magic-numbers)
+	std::uniform_real_distribution<float> position{-20.0F, 20.0F};
+	std::uniform_real_distribution<float> extent{0.0F, 4.0F};
+	std::uniform_real_distribution<float> unit{0.0F, 1.0F};
+	// Beyond [0, 1] as well, to cover the clamping of the compact format.
+	std::uniform_real_distribution<float>        colour{-0.25F, 1.25F};
+	std::uniform_int_distribution<std::uint32_t> layer{0, 255};
+	// NOLINTEND(*-magic-numbers)
+
+	batch result{};
+	for (std::size_t i{}; i < count; ++i)
+	{
+		result.x.push_back(position(random));
+		result.y.push_back(position(random));
+		result.width.push_back(extent(random));
+		result.height.push_back(extent(random));
+		result.uv_bounds.emplace_back(unit(random),
+		                              unit(random),
+		                              unit(random),
+		                              unit(random));
+		result.tint.emplace_back(colour(random),
+		                         colour(random),
+		                         colour(random),
+		                         colour(random));
+		result.layer.push_back(layer(random));
+	}
+	return result;
+}
+
+// Expands into a buffer that starts misalignment bytes past a boundary, and
+// checks that the kernel kept to its own bytes.
+auto expand(quad_expansion_kernel     kernel,
+            sprite_batch_input const& sprites,
+            std::size_t               record_size,
+            std::size_t               misalignment) -> std::vector<std::byte>
+{
+	auto const size = record_size * sprites.size();
+
+	std::vector<std::byte> buffer(buffer_alignment + misalignment + size +
+	                                  guard_size,
+	                              guard);
+	auto const address = reinterpret_cast<std::uintptr_t>(std::data(buffer));
+	auto const offset =
+	    (buffer_alignment - address % buffer_alignment) % buffer_alignment +
+	    misalignment;
+
+	auto const output = std::span{buffer}.subspan(offset, size);
+	kernel(sprites, pixels_per_metre, output);
+
+	for (std::size_t i{}; i < offset; ++i)
+	{
+		EXPECT_EQ(buffer[i], guard) << "written before the output at " << i;
+	}
+	for (auto i = offset + size; i < std::size(buffer); ++i)
+	{
+		EXPECT_EQ(buffer[i], guard) << "written past the output at " << i;
+	}
+
+	return {std::begin(output), std::end(output)};
+}
+
+struct record_sizes final
+{
+	vertex_format format{};
+	std::size_t   instance{};
+	std::size_t   quad{};
+};
+
+constexpr auto formats = std::array{
+    record_sizes{.format = vertex_format::full,
+                 .instance = sizeof(sprite_instance),
+                 .quad = sizeof(sprite_vertex) * verts_per_quad},
+    record_sizes{.format = vertex_format::compact,
+                 .instance = sizeof(compact_sprite_instance),
+                 .quad = sizeof(compact_sprite_vertex) * verts_per_quad}
+};
+
+auto supported_simd_levels() -> std::vector<simd_level>
+{
+	std::vector<simd_level> levels{};
+	for (auto const level: {simd_level::sse2, simd_level::avx2})
+	{
+		if (level <= detect_simd_level())
+		{
+			levels.push_back(level);
+		}
+	}
+	return levels;
+}
+
+void expect_same_bytes(quad_expansion_kernel     kernel,
+                       quad_expansion_kernel     reference,
+                       sprite_batch_input const& sprites,
+                       std::size_t               record_size)
+{
+	auto const expected = expand(reference, sprites, record_size, 0);
+
+	for (auto const misalignment: misalignments)
+	{
+		SCOPED_TRACE(::testing::Message()
+		             << "misaligned by " << misalignment);
+
+		auto const actual = expand(kernel, sprites, record_size, misalignment);
+		ASSERT_EQ(std::size(actual), std::size(expected));
+		EXPECT_EQ(std::memcmp(std::data(actual),
+		                      std::data(expected),
+		                      std::size(expected)),
+		          0);
+	}
+}
+
+void expect_kernels_match_scalar(std::size_t count, std::mt19937& random)
+{
+	auto const sprites = make_random_batch(count, random);
+	auto const input = sprites.input();
+
+	for (auto const& sizes: formats)
+	{
+		auto const reference = kernels::scalar(sizes.format);
+
+		for (auto const level: supported_simd_levels())
+		{
+			SCOPED_TRACE(::testing::Message()
+			             << count << " sprites, level "
+			             << static_cast<int>(level) << ", format "
+			             << static_cast<int>(sizes.format));
+
+			auto const candidate =
+			    select_quad_expansion_kernels(level, sizes.format);
+			ASSERT_EQ(candidate.level, level);
+
+			expect_same_bytes(candidate.instances,
+			                  reference.instances,
+			                  input,
+			                  sizes.instance);
+			expect_same_bytes(candidate.vertices,
+			                  reference.vertices,
+			                  input,
+			                  sizes.quad);
+		}
+	}
+}
+
+TEST(quad_expansion, simd_kernels_match_scalar_for_every_tail)
+{
+	if (supported_simd_levels().empty())
+	{
+		GTEST_SKIP() << "no SIMD kernels on this machine";
+	}
+
+	// Fixed, so that a failure can be reproduced.
+	std::mt19937 random{1}; // NOLINT(*-magic-numbers)
+	for (std::size_t count{}; count <= max_small_count; ++count)
+	{
+		expect_kernels_match_scalar(count, random);
+	}
+}
+
+TEST(quad_expansion, simd_kernels_match_scalar_for_large_batches)
+{
+	if (supported_simd_levels().empty())
+	{
+		GTEST_SKIP() << "no SIMD kernels on this machine";
+	}
+
+	std::mt19937 random{2}; // NOLINT(*-magic-numbers)
+	for (auto const count: large_counts)
+	{
+		expect_kernels_match_scalar(count, random);
+	}
+}
+
+TEST(quad_expansion, scalar_kernel_is_selected_below_sse2)
+{
+	for (auto const& sizes: formats)
+	{
+		auto const selected =
+		    select_quad_expansion_kernels(simd_level::scalar, sizes.format);
+		auto const scalar = kernels::scalar(sizes.format);
+
+		EXPECT_EQ(selected.level, simd_level::scalar);
+		EXPECT_EQ(selected.instances, scalar.instances);
+		EXPECT_EQ(selected.vertices, scalar.vertices);
+	}
+}
+} // namespace
@@ -0,0 +1,137 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#include "yaboc/sprite/skyline_packer.h"
+
+#include "glm/glm.hpp"
+#include "gtest/gtest.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <vector>
+
+namespace
+{
+using namespace yaboc::sprite;
+
+constexpr glm::ivec2  page_dimensions{512, 256};
+constexpr std::size_t insert_attempts{2'000};
+
+struct placed_rectangle final
+{
+	glm::ivec2 position{};
+	glm::ivec2 size{};
+};
+
+auto overlaps(placed_rectangle const& first, placed_rectangle const& second)
+    -> bool
+{
+	return first.position.x < second.position.x + second.size.x &&
+	       second.position.x < first.position.x + first.size.x &&
+	       first.position.y < second.position.y + second.size.y &&
+	       second.position.y < first.position.y + first.size.y;
+}
+
+// Inserts random rectangles until many no longer fit, and returns those that
+// did.
+auto fill_randomly(skyline_packer& packer, std::mt19937& random)
+    -> std::vector<placed_rectangle>
+{
+	// NOLINTNEXTLINE(*-magic-numbers)
+	std::uniform_int_distribution<int> extent{1, 48};
+
+	std::vector<placed_rectangle> placed{};
+	for (std::size_t attempt{}; attempt < insert_attempts; ++attempt)
+	{
+		glm::ivec2 const size{extent(random), extent(random)};
+		if (auto const position = packer.insert(size))
+		{
+			placed.push_back({.position = *position, .size = size});
+		}
+	}
+	return placed;
+}
+
+TEST(skyline_packer, keeps_random_rectangles_apart_and_inside_the_page)
+{
+	std::mt19937 random{1}; // NOLINT(*-magic-numbers)
+
+	skyline_packer packer{page_dimensions};
+	auto const     placed = fill_randomly(packer, random);
+	ASSERT_FALSE(placed.empty());
+
+	std::int64_t area{};
+	for (std::size_t i{}; i < std::size(placed); ++i)
+	{
+		auto const& rectangle = placed[i];
+		EXPECT_GE(rectangle.position.x, 0);
+		EXPECT_GE(rectangle.position.y, 0);
+		EXPECT_LE(rectangle.position.x + rectangle.size.x, page_dimensions.x);
+		EXPECT_LE(rectangle.position.y + rectangle.size.y, page_dimensions.y);
+
+		for (std::size_t j{i + 1}; j < std::size(placed); ++j)
+		{
+			EXPECT_FALSE(overlaps(rectangle, placed[j]))
+			    << "rectangles " << i << " and " << j << " overlap";
+		}
+
+		area += static_cast<std::int64_t>(rectangle.size.x) * rectangle.size.y;
+	}
+
+	auto const page_area =
+	    static_cast<std::int64_t>(page_dimensions.x) * page_dimensions.y;
+	EXPECT_FLOAT_EQ(packer.occupancy(),
+	                static_cast<float>(area) / static_cast<float>(page_area));
+}
+
+TEST(skyline_packer, rejects_rectangles_larger_than_the_page)
+{
+	skyline_packer packer{page_dimensions};
+
+	EXPECT_EQ(packer.insert(page_dimensions + glm::ivec2{1, 0}), std::nullopt);
+	EXPECT_EQ(packer.insert(page_dimensions + glm::ivec2{0, 1}), std::nullopt);
+	EXPECT_EQ(packer.occupancy(), 0.0F);
+
+	EXPECT_EQ(packer.insert(page_dimensions), glm::ivec2{});
+	EXPECT_EQ(packer.occupancy(), 1.0F);
+	EXPECT_EQ(packer.insert({1, 1}), std::nullopt);
+}
+
+TEST(skyline_packer, rejects_empty_rectangles)
+{
+	skyline_packer packer{page_dimensions};
+
+	EXPECT_EQ(packer.insert({0, 1}), std::nullopt);
+	EXPECT_EQ(packer.insert({1, -1}), std::nullopt);
+}
+
+TEST(skyline_packer, clear_empties_the_page)
+{
+	std::mt19937 random{2}; // NOLINT(*-magic-numbers)
+
+	skyline_packer packer{page_dimensions};
+	ASSERT_FALSE(fill_randomly(packer, random).empty());
+	ASSERT_GT(packer.occupancy(), 0.0F);
+
+	packer.clear();
+	EXPECT_EQ(packer.occupancy(), 0.0F);
+
+	// The whole page is free again.
+	EXPECT_EQ(packer.insert(page_dimensions), glm::ivec2{});
+	EXPECT_EQ(packer.occupancy(), 1.0F);
+}
+} // namespace
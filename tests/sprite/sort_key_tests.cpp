@@ -0,0 +1,197 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#include "yaboc/sprite/sort_key.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace
+{
+using namespace yaboc::sprite;
+
+// Small enough that keys repeat, so stability is exercised.
+constexpr std::size_t large_count{5'000};
+constexpr auto        small_counts = std::array<std::size_t, 5>{0, 1, 2, 3, 17};
+
+auto make_entries(std::vector<std::uint64_t> const& keys)
+    -> std::vector<sort_entry>
+{
+	std::vector<sort_entry> entries{};
+	entries.reserve(std::size(keys));
+	for (auto const& key: keys)
+	{
+		auto const index = static_cast<std::uint32_t>(std::size(entries));
+		entries.push_back({.key = key, .index = index});
+	}
+	return entries;
+}
+
+void expect_matches_stable_sort(std::vector<std::uint64_t> const& keys)
+{
+	auto expected = make_entries(keys);
+	std::ranges::stable_sort(expected, {}, &sort_entry::key);
+
+	auto                    sorted = make_entries(keys);
+	std::vector<sort_entry> scratch{};
+	radix_sort(sorted, scratch);
+
+	ASSERT_EQ(std::size(sorted), std::size(expected));
+	for (std::size_t i{}; i < std::size(sorted); ++i)
+	{
+		EXPECT_EQ(sorted[i].key, expected[i].key) << "at " << i;
+		EXPECT_EQ(sorted[i].index, expected[i].index) << "at " << i;
+	}
+}
+
+auto make_random_keys(std::size_t   count,
+                      std::mt19937& random,
+                      std::uint64_t varying_bits)
+    -> std::vector<std::uint64_t>
+{
+	std::uniform_int_distribution<std::uint64_t> bits{};
+	auto const                                   fixed = bits(random);
+
+	std::vector<std::uint64_t> keys(count);
+	for (auto& key: keys)
+	{
+		key = (fixed & ~varying_bits) | (bits(random) & varying_bits);
+	}
+	return keys;
+}
+
+TEST(radix_sort, matches_stable_sort_on_random_keys)
+{
+	std::mt19937 random{1}; // NOLINT(*-magic-numbers)
+
+	for (auto const count: small_counts)
+	{
+		expect_matches_stable_sort(make_random_keys(count, random, ~0ULL));
+	}
+	expect_matches_stable_sort(make_random_keys(large_count, random, ~0ULL));
+}
+
+TEST(radix_sort, matches_stable_sort_when_byte_lanes_are_skipped)
+{
+	std::mt19937 random{2}; // NOLINT(*-magic-numbers)
+
+	// NOLINTBEGIN(*-magic-numbers)
+	// Only the depth varies, as with a single sheet, layer and blend mode.
+	expect_matches_stable_sort(
+	    make_random_keys(large_count, random, 0x0000'0000'FFFF'FFFF));
+	// Only the low depth byte, so nearly every key has a duplicate.
+	expect_matches_stable_sort(
+	    make_random_keys(large_count, random, 0x0000'0000'0000'00FF));
+	// Constant lanes between and below varying ones.
+	expect_matches_stable_sort(
+	    make_random_keys(large_count, random, 0xFF00'00FF'00FF'0000));
+	// NOLINTEND(*-magic-numbers)
+
+	// Every lane constant: nothing moves.
+	expect_matches_stable_sort(make_random_keys(large_count, random, 0));
+}
+
+TEST(state_run_length, is_zero_for_no_entries)
+{
+	EXPECT_EQ(state_run_length({}), 0U);
+}
+
+TEST(state_run_length, spans_layer_and_depth_changes)
+{
+	// NOLINTBEGIN(*-magic-numbers)
+	auto const entries = make_entries({
+	    sort_key{.layer = 0, .sheet = 1, .depth = 5}.packed(),
+	    sort_key{.layer = 0, .sheet = 1, .depth = 9}.packed(),
+	    sort_key{.layer = 1, .sheet = 1, .depth = 0}.packed(),
+	    sort_key{.layer = 1, .sheet = 2, .depth = 0}.packed(),
+	});
+	// NOLINTEND(*-magic-numbers)
+
+	EXPECT_EQ(state_run_length(entries), 3U);
+}
+
+TEST(state_run_length, ends_where_the_sheet_or_blend_mode_changes)
+{
+	auto const entries = make_entries({
+	    sort_key{.sheet = 1}.packed(),
+	    sort_key{.sheet = 1, .blend = blend_mode::additive}.packed(),
+	    sort_key{.sheet = 2, .blend = blend_mode::additive}.packed(),
+	});
+
+	auto const all = std::span{entries};
+	EXPECT_EQ(state_run_length(all), 1U);
+	EXPECT_EQ(state_run_length(all.subspan(1)), 1U);
+	EXPECT_EQ(state_run_length(all.subspan(2)), 1U);
+}
+
+TEST(state_run_length, splits_sorted_random_keys_into_uniform_runs)
+{
+	std::mt19937 random{3}; // NOLINT(*-magic-numbers)
+
+	// NOLINTBEGIN(*-magic-numbers)
+	std::uniform_int_distribution<unsigned>      layer{0, 2};
+	std::uniform_int_distribution<unsigned>      sheet{0, 3};
+	std::uniform_int_distribution<unsigned>      blend{0, 1};
+	std::uniform_int_distribution<std::uint32_t> depth{};
+	// NOLINTEND(*-magic-numbers)
+
+	std::vector<std::uint64_t> keys(large_count);
+	for (auto& key: keys)
+	{
+		key = sort_key{.layer = static_cast<std::uint8_t>(layer(random)),
+		               .sheet = static_cast<std::uint16_t>(sheet(random)),
+		               .blend = static_cast<blend_mode>(blend(random)),
+		               .depth = depth(random)}
+		          .packed();
+	}
+
+	auto                    entries = make_entries(keys);
+	std::vector<sort_entry> scratch{};
+	radix_sort(entries, scratch);
+
+	auto const  all = std::span{std::as_const(entries)};
+	std::size_t run_begin{};
+	std::size_t runs{};
+	while (run_begin != std::size(all))
+	{
+		auto const length = state_run_length(all.subspan(run_begin));
+		ASSERT_GT(length, 0U);
+
+		auto const state = all[run_begin].key & sort_key::state_mask;
+		for (auto const& entry: all.subspan(run_begin, length))
+		{
+			EXPECT_EQ(entry.key & sort_key::state_mask, state);
+		}
+
+		run_begin += length;
+		if (run_begin != std::size(all))
+		{
+			EXPECT_NE(all[run_begin].key & sort_key::state_mask, state);
+		}
+		++runs;
+	}
+
+	// Each layer holds every sheet and blend mode, in order.
+	EXPECT_EQ(runs, 3U * 4U * 2U); // NOLINT(*-magic-numbers)
+}
+} // namespace
@@ -1,6 +1,7 @@
 include (FetchContent)
 
-find_package (OpenGL REQUIRED)
+find_package (OpenGL REQUIRED OPTIONAL_COMPONENTS EGL)
+find_package (Threads REQUIRED)
 
 set (SDL_DISABLE_INSTALL OFF)
 
@@ -78,6 +79,51 @@ set_target_properties (
 	SYSTEM TRUE
 )
 
+add_library (stb_image_write)
+add_library (STB::ImageWrite ALIAS stb_image_write)
+
+target_sources (
+	stb_image_write
+
+	PRIVATE
+	${STB_SOURCE_DIR}/stb_image_write.h
+	${STB_BINARY_DIR}/stb_image_write.c
+)
+
+target_include_directories (
+	stb_image_write
+
+	PUBLIC
+	$<BUILD_INTERFACE:${STB_SOURCE_DIR}>
+)
+
+file (
+	WRITE ${STB_BINARY_DIR}/stb_image_write.c
+	"#define STB_IMAGE_WRITE_IMPLEMENTATION\n\n"
+	"#include \"stb_image_write.h\""
+)
+
+set_target_properties (
+	stb_image_write
+
+	PROPERTIES
+	SYSTEM TRUE
+)
+
 FetchContent_MakeAvailable (SDL GLM EnTT json STB)
 
+if (BUILD_TESTING)
+	# An installed GoogleTest is used when there is one.
+	FetchContent_Declare (
+		googletest
+		GIT_REPOSITORY https://github.com/google/googletest
+		GIT_TAG f8d7d77c06936315286eb55f8de22cd23c188571
+		SYSTEM
+		FIND_PACKAGE_ARGS NAMES GTest
+	)
+
+	set (INSTALL_GTEST OFF)
+	FetchContent_MakeAvailable (googletest)
+endif ()
+
 add_subdirectory (external/glad SYSTEM)
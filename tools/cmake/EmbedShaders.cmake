@@ -0,0 +1,76 @@
+# Compiles shader sources into a target, so that they are not read from disk
+# at runtime. Paths are relative to the project root and are what make_shader
+# is asked for. When run as a script, generates the source file itself.
+
+if (CMAKE_SCRIPT_MODE_FILE)
+	string (REPLACE "|" ";" shaders "${SHADERS}")
+
+	set (entries "")
+	foreach (shader IN LISTS shaders)
+		file (READ ${ROOT}/${shader} source)
+		string (
+			APPEND entries
+			"\tembedded_shader{\"${shader}\",\n"
+			"\t                R\"yaboc_glsl(${source})yaboc_glsl\"},\n"
+		)
+	endforeach ()
+
+	# Appended piece by piece, as semicolons in the sources would otherwise
+	# be taken for list separators.
+	set (contents "")
+	string (
+		APPEND contents
+		"// Generated from the shaders under assets/shaders, do not edit.\n"
+		"#include \"yaboc/graphics/embedded_shaders.h\"\n\n"
+		"#include <array>\n\n"
+		"namespace yaboc::graphics\n{\n"
+		"namespace\n{\n"
+		"constexpr std::array shaders{\n"
+	)
+	string (APPEND contents "${entries}")
+	string (
+		APPEND contents
+		"};\n"
+		"} // namespace\n\n"
+		"auto embedded_shaders() -> std::span<embedded_shader const>\n{\n"
+		"\treturn shaders;\n"
+		"}\n"
+		"} // namespace yaboc::graphics\n"
+	)
+
+	# Leave the file alone if nothing changed, so nothing gets rebuilt.
+	if (EXISTS ${OUTPUT})
+		file (READ ${OUTPUT} previous_contents)
+		if (previous_contents STREQUAL contents)
+			return ()
+		endif ()
+	endif ()
+	file (WRITE ${OUTPUT} "${contents}")
+	return ()
+endif ()
+
+function (yaboc_embed_shaders target)
+	set (output ${CMAKE_CURRENT_BINARY_DIR}/generated/embedded_shaders.cpp)
+
+	set (inputs "")
+	foreach (shader IN LISTS ARGN)
+		list (APPEND inputs ${PROJECT_SOURCE_DIR}/${shader})
+	endforeach ()
+
+	# Semicolons would split the list into separate arguments.
+	string (REPLACE ";" "|" shaders "${ARGN}")
+
+	add_custom_command (
+		OUTPUT ${output}
+		COMMAND ${CMAKE_COMMAND}
+		        -DROOT=${PROJECT_SOURCE_DIR}
+		        -DOUTPUT=${output}
+		        -DSHADERS=${shaders}
+		        -P ${CMAKE_CURRENT_FUNCTION_LIST_FILE}
+		DEPENDS ${inputs} ${CMAKE_CURRENT_FUNCTION_LIST_FILE}
+		COMMENT "Embedding shaders into ${target}"
+		VERBATIM
+	)
+
+	target_sources (${target} PRIVATE ${output})
+endfunction ()
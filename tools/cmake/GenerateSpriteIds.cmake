@@ -0,0 +1,99 @@
+# Generates a header with an id for every frame of a TexturePacker sprite
+# sheet, so that code names sprites with constants rather than strings. The
+# sheet is given relative to the project root; sprite_sheet.json becomes
+# yaboc/sprite/sprite_sheet_frames.h, with the enum id and the
+# static_frame_table table in namespace yaboc::sprite::sprite_sheet_frames.
+# Frame entity/paddleRed becomes id::entity_paddle_red. When run as a
+# script, generates the header itself.
+
+if (CMAKE_SCRIPT_MODE_FILE)
+	file (READ ${ROOT}/${SHEET} json)
+	string (JSON frame_count LENGTH "${json}" frames)
+
+	set (enumerators "")
+	set (frames "")
+	if (frame_count GREATER 0)
+		math (EXPR last_frame "${frame_count} - 1")
+		foreach (index RANGE ${last_frame})
+			string (JSON name GET "${json}" frames ${index} filename)
+			string (JSON x GET "${json}" frames ${index} frame x)
+			string (JSON y GET "${json}" frames ${index} frame y)
+			string (JSON w GET "${json}" frames ${index} frame w)
+			string (JSON h GET "${json}" frames ${index} frame h)
+			string (JSON size_x GET "${json}" frames ${index} sourceSize w)
+			string (JSON size_y GET "${json}" frames ${index} sourceSize h)
+			math (EXPR max_x "${x} + ${w}")
+			math (EXPR max_y "${y} + ${h}")
+
+			string (REGEX REPLACE "([a-z0-9])([A-Z])" "\\1_\\2" enumerator
+			        "${name}")
+			string (TOLOWER "${enumerator}" enumerator)
+			string (MAKE_C_IDENTIFIER "${enumerator}" enumerator)
+
+			string (APPEND enumerators "\t${enumerator},\n")
+			string (
+				APPEND frames
+				"\t\tstatic_frame{\"${name}\", "
+				"${x}, ${y}, ${max_x}, ${max_y}, ${size_x}, ${size_y}},\n"
+			)
+		endforeach ()
+	endif ()
+
+	string (TOUPPER "${NAME}" guard)
+	set (guard "YABOC_GENERATED_YABOC_SPRITE_${guard}_H")
+
+	set (contents "")
+	string (
+		APPEND contents
+		"// Generated from ${SHEET}, do not edit.\n"
+		"#ifndef ${guard}\n"
+		"#define ${guard}\n\n"
+		"#include \"yaboc/sprite/static_frame_table.h\"\n\n"
+		"#include <array>\n"
+		"#include <cstdint>\n\n"
+		"namespace yaboc::sprite::${NAME}\n{\n"
+		"enum class id : std::uint16_t\n{\n"
+		"${enumerators}"
+		"};\n\n"
+		"inline constexpr static_frame_table<id, ${frame_count}> table{\n"
+		"\tstd::array<static_frame, ${frame_count}>{\n"
+		"${frames}"
+		"\t}};\n"
+		"} // namespace yaboc::sprite::${NAME}\n\n"
+		"#endif // ${guard}\n"
+	)
+
+	# Leave the file alone if nothing changed, so nothing gets rebuilt.
+	if (EXISTS ${OUTPUT})
+		file (READ ${OUTPUT} previous_contents)
+		if (previous_contents STREQUAL contents)
+			return ()
+		endif ()
+	endif ()
+	file (WRITE ${OUTPUT} "${contents}")
+	return ()
+endif ()
+
+function (yaboc_generate_sprite_ids target sheet)
+	get_filename_component (stem ${sheet} NAME_WE)
+	set (name ${stem}_frames)
+	set (output_directory ${CMAKE_CURRENT_BINARY_DIR}/generated/include)
+	set (output ${output_directory}/yaboc/sprite/${name}.h)
+
+	add_custom_command (
+		OUTPUT ${output}
+		COMMAND ${CMAKE_COMMAND}
+		        -DROOT=${PROJECT_SOURCE_DIR}
+		        -DOUTPUT=${output}
+		        -DSHEET=${sheet}
+		        -DNAME=${name}
+		        -P ${CMAKE_CURRENT_FUNCTION_LIST_FILE}
+		DEPENDS ${PROJECT_SOURCE_DIR}/${sheet}
+		        ${CMAKE_CURRENT_FUNCTION_LIST_FILE}
+		COMMENT "Generating sprite ids for ${sheet}"
+		VERBATIM
+	)
+
+	target_sources (${target} PRIVATE ${output})
+	target_include_directories (${target} PRIVATE ${output_directory})
+endfunction ()
@@ -0,0 +1,372 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#include "bc7_encoder.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <utility>
+
+namespace yaboc::cook
+{
+namespace
+{
+constexpr std::size_t block_pixels{16};
+constexpr std::size_t channels{graphics::image::channels};
+
+using colour = std::array<float, channels>;
+using block = std::array<colour, block_pixels>;
+
+// Interpolation weights of 4-bit indices, out of 64.
+constexpr std::array<int, 16> index_weights{
+    0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+constexpr int   endpoint_bits{7};
+constexpr int   endpoint_max{(1 << endpoint_bits) - 1};
+constexpr float channel_max{255.0F};
+
+struct encoding final
+{
+	std::array<std::array<int, channels>, 2> endpoints{};
+	std::array<int, 2>                        p_bits{};
+	std::array<std::uint8_t, block_pixels>    indices{};
+	float error{std::numeric_limits<float>::max()};
+};
+
+class bit_writer final
+{
+	std::array<std::byte, bc7_block_size> m_bytes{};
+	std::size_t                           m_position{};
+
+public:
+	void write(unsigned int value, int count)
+	{
+		for (int bit{}; bit < count; ++bit, ++m_position)
+		{
+			if (((value >> static_cast<unsigned int>(bit)) & 1U) != 0)
+			{
+				m_bytes[m_position / 8] |= std::byte{1}
+				                           << (m_position % 8);
+			}
+		}
+	}
+
+	[[nodiscard]]
+	auto bytes() const -> std::array<std::byte, bc7_block_size> const&
+	{
+		return m_bytes;
+	}
+};
+
+auto read_block(graphics::image const& picture, int block_x, int block_y)
+    -> block
+{
+	block pixels{};
+	for (int y{}; y < bc7_block_dimension; ++y)
+	{
+		for (int x{}; x < bc7_block_dimension; ++x)
+		{
+			auto const source_x =
+			    std::min(block_x * bc7_block_dimension + x, picture.width - 1);
+			auto const source_y =
+			    std::min(block_y * bc7_block_dimension + y, picture.height - 1);
+			auto const offset = (static_cast<std::size_t>(source_y) *
+			                         static_cast<std::size_t>(picture.width) +
+			                     static_cast<std::size_t>(source_x)) *
+			                    channels;
+
+			auto& pixel = pixels[static_cast<std::size_t>(
+			    y * bc7_block_dimension + x)];
+			for (std::size_t channel{}; channel < channels; ++channel)
+			{
+				pixel[channel] = picture.pixels[offset + channel];
+			}
+		}
+	}
+	return pixels;
+}
+
+// The direction along which the block varies most, by power iteration on
+// its covariance.
+auto principal_axis(block const& pixels, colour const& mean) -> colour
+{
+	std::array<std::array<float, channels>, channels> covariance{};
+	for (auto const& pixel: pixels)
+	{
+		for (std::size_t row{}; row < channels; ++row)
+		{
+			for (std::size_t column{}; column < channels; ++column)
+			{
+				covariance[row][column] +=
+				    (pixel[row] - mean[row]) * (pixel[column] - mean[column]);
+			}
+		}
+	}
+
+	colour axis{1.0F, 1.0F, 1.0F, 1.0F};
+	constexpr int iterations{8};
+	for (int iteration{}; iteration < iterations; ++iteration)
+	{
+		colour next{};
+		for (std::size_t row{}; row < channels; ++row)
+		{
+			for (std::size_t column{}; column < channels; ++column)
+			{
+				next[row] += covariance[row][column] * axis[column];
+			}
+		}
+
+		auto const length = std::sqrt(next[0] * next[0] + next[1] * next[1] +
+		                              next[2] * next[2] + next[3] * next[3]);
+		if (length < std::numeric_limits<float>::epsilon())
+		{
+			return {};
+		}
+		for (std::size_t channel{}; channel < channels; ++channel)
+		{
+			axis[channel] = next[channel] / length;
+		}
+	}
+	return axis;
+}
+
+// The 7-bit value that, with the p-bit appended, comes closest.
+auto quantise(float value, int p_bit) -> int
+{
+	auto const steps = std::lround((value - static_cast<float>(p_bit)) / 2.0F);
+	return std::clamp(static_cast<int>(steps), 0, endpoint_max);
+}
+
+// Tries every combination of p-bits for the endpoints and picks the closest
+// palette entry for each pixel.
+auto fit(block const& pixels, colour const& low, colour const& high)
+    -> encoding
+{
+	encoding best{};
+	for (int p0{}; p0 < 2; ++p0)
+	{
+		for (int p1{}; p1 < 2; ++p1)
+		{
+			encoding candidate{.p_bits = {p0, p1}, .error = 0.0F};
+
+			std::array<std::array<float, channels>, index_weights.size()>
+			    palette{};
+			for (std::size_t channel{}; channel < channels; ++channel)
+			{
+				candidate.endpoints[0][channel] = quantise(low[channel], p0);
+				candidate.endpoints[1][channel] = quantise(high[channel], p1);
+
+				auto const first = (candidate.endpoints[0][channel] << 1) | p0;
+				auto const last = (candidate.endpoints[1][channel] << 1) | p1;
+				for (std::size_t index{}; index < std::size(palette); ++index)
+				{
+					auto const weight = index_weights[index];
+					palette[index][channel] = static_cast<float>(
+					    ((64 - weight) * first + weight * last + 32) >> 6);
+				}
+			}
+
+			for (std::size_t pixel{}; pixel < block_pixels; ++pixel)
+			{
+				auto best_error = std::numeric_limits<float>::max();
+				for (std::size_t index{}; index < std::size(palette); ++index)
+				{
+					float error{};
+					for (std::size_t channel{}; channel < channels; ++channel)
+					{
+						auto const delta =
+						    palette[index][channel] - pixels[pixel][channel];
+						error += delta * delta;
+					}
+					if (error < best_error)
+					{
+						best_error = error;
+						candidate.indices[pixel] =
+						    static_cast<std::uint8_t>(index);
+					}
+				}
+				candidate.error += best_error;
+			}
+
+			if (candidate.error < best.error)
+			{
+				best = candidate;
+			}
+		}
+	}
+	return best;
+}
+
+// Least-squares endpoints for the indices an encoding settled on.
+auto refit(block const& pixels, encoding const& previous)
+    -> std::pair<colour, colour>
+{
+	float low_low{};
+	float low_high{};
+	float high_high{};
+	colour low_sum{};
+	colour high_sum{};
+	for (std::size_t pixel{}; pixel < block_pixels; ++pixel)
+	{
+		auto const weight =
+		    static_cast<float>(index_weights[previous.indices[pixel]]) / 64.0F;
+		auto const inverse = 1.0F - weight;
+
+		low_low += inverse * inverse;
+		low_high += inverse * weight;
+		high_high += weight * weight;
+		for (std::size_t channel{}; channel < channels; ++channel)
+		{
+			low_sum[channel] += inverse * pixels[pixel][channel];
+			high_sum[channel] += weight * pixels[pixel][channel];
+		}
+	}
+
+	auto const determinant = low_low * high_high - low_high * low_high;
+	if (std::abs(determinant) < std::numeric_limits<float>::epsilon())
+	{
+		return {};
+	}
+
+	colour low{};
+	colour high{};
+	for (std::size_t channel{}; channel < channels; ++channel)
+	{
+		low[channel] = std::clamp((high_high * low_sum[channel] -
+		                           low_high * high_sum[channel]) /
+		                              determinant,
+		                          0.0F,
+		                          channel_max);
+		high[channel] = std::clamp((low_low * high_sum[channel] -
+		                            low_high * low_sum[channel]) /
+		                               determinant,
+		                           0.0F,
+		                           channel_max);
+	}
+	return {low, high};
+}
+
+auto encode_block(block const& pixels) -> std::array<std::byte, bc7_block_size>
+{
+	colour mean{};
+	for (auto const& pixel: pixels)
+	{
+		for (std::size_t channel{}; channel < channels; ++channel)
+		{
+			mean[channel] += pixel[channel] / static_cast<float>(block_pixels);
+		}
+	}
+
+	auto const axis = principal_axis(pixels, mean);
+
+	auto lowest = std::numeric_limits<float>::max();
+	auto highest = std::numeric_limits<float>::lowest();
+	for (auto const& pixel: pixels)
+	{
+		float projection{};
+		for (std::size_t channel{}; channel < channels; ++channel)
+		{
+			projection += (pixel[channel] - mean[channel]) * axis[channel];
+		}
+		lowest = std::min(lowest, projection);
+		highest = std::max(highest, projection);
+	}
+
+	colour low{};
+	colour high{};
+	for (std::size_t channel{}; channel < channels; ++channel)
+	{
+		low[channel] = std::clamp(mean[channel] + axis[channel] * lowest,
+		                          0.0F,
+		                          channel_max);
+		high[channel] = std::clamp(mean[channel] + axis[channel] * highest,
+		                           0.0F,
+		                           channel_max);
+	}
+
+	auto best = fit(pixels, low, high);
+	if (best.error > 0.0F)
+	{
+		auto const [refit_low, refit_high] = refit(pixels, best);
+		if (auto refined = fit(pixels, refit_low, refit_high);
+		    refined.error < best.error)
+		{
+			best = refined;
+		}
+	}
+
+	// The first index is stored without its top bit, which must be clear.
+	if (best.indices[0] >= index_weights.size() / 2)
+	{
+		std::swap(best.endpoints[0], best.endpoints[1]);
+		std::swap(best.p_bits[0], best.p_bits[1]);
+		for (auto& index: best.indices)
+		{
+			index = static_cast<std::uint8_t>(index_weights.size() - 1 - index);
+		}
+	}
+
+	constexpr unsigned int mode_6{1U << 6};
+	constexpr int          mode_bits{7};
+
+	bit_writer bits{};
+	bits.write(mode_6, mode_bits);
+	for (std::size_t channel{}; channel < channels; ++channel)
+	{
+		for (auto const& endpoint: best.endpoints)
+		{
+			bits.write(static_cast<unsigned int>(endpoint[channel]),
+			           endpoint_bits);
+		}
+	}
+	for (auto const p_bit: best.p_bits)
+	{
+		bits.write(static_cast<unsigned int>(p_bit), 1);
+	}
+	for (std::size_t pixel{}; pixel < block_pixels; ++pixel)
+	{
+		bits.write(best.indices[pixel], pixel == 0 ? 3 : 4);
+	}
+	return bits.bytes();
+}
+} // namespace
+
+auto encode_bc7(graphics::image const& picture) -> std::vector<std::byte>
+{
+	auto const blocks_x =
+	    (picture.width + bc7_block_dimension - 1) / bc7_block_dimension;
+	auto const blocks_y =
+	    (picture.height + bc7_block_dimension - 1) / bc7_block_dimension;
+
+	std::vector<std::byte> encoded{};
+	encoded.reserve(static_cast<std::size_t>(blocks_x * blocks_y) *
+	                bc7_block_size);
+	for (int block_y{}; block_y < blocks_y; ++block_y)
+	{
+		for (int block_x{}; block_x < blocks_x; ++block_x)
+		{
+			auto const bytes =
+			    encode_block(read_block(picture, block_x, block_y));
+			encoded.insert(std::end(encoded),
+			               std::begin(bytes),
+			               std::end(bytes));
+		}
+	}
+	return encoded;
+}
+} // namespace yaboc::cook
@@ -0,0 +1,37 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#ifndef YABOC_TOOLS_COOK_BC7_ENCODER_H
+#define YABOC_TOOLS_COOK_BC7_ENCODER_H
+
+#include "yaboc/graphics/image.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace yaboc::cook
+{
+inline constexpr int         bc7_block_dimension{4};
+inline constexpr std::size_t bc7_block_size{16};
+
+// Encodes every 4x4 block in mode 6: one RGBA subset with 7-bit endpoints,
+// a p-bit each and 4-bit indices. That is the mode that suits sprites with
+// smooth alpha, and good enough that no other is tried. Edge blocks of
+// images that are not a multiple of 4 repeat the last row and column.
+[[nodiscard]]
+auto encode_bc7(graphics::image const& picture) -> std::vector<std::byte>;
+} // namespace yaboc::cook
+
+#endif // YABOC_TOOLS_COOK_BC7_ENCODER_H
@@ -0,0 +1,345 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (C) 2023 David Brown <d.brown@bigdavedev.com>
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+#include "bc7_encoder.h"
+
+#include "yaboc/assets/level_grid.h"
+#include "yaboc/assets/pack_format.h"
+#include "yaboc/graphics/image.h"
+#include "yaboc/sprite/sprite_sheet.h"
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// Cooks loose assets into a pack for yaboc::assets::asset_pack, see
+// pack_format.h. Entries are named after the paths given on the command
+// line, which are the paths the game would otherwise load them from.
+namespace
+{
+namespace assets = yaboc::assets;
+
+struct cooked_entry final
+{
+	std::string             name{};
+	assets::pack_entry_kind kind{};
+	std::vector<std::byte>  blob{};
+};
+
+template <class T>
+    requires std::is_trivially_copyable_v<T>
+void append(std::vector<std::byte>& blob, T const& value)
+{
+	auto const bytes = std::as_bytes(std::span{&value, 1});
+	blob.insert(std::end(blob), std::begin(bytes), std::end(bytes));
+}
+
+void append(std::vector<std::byte>& blob, std::string_view text)
+{
+	auto const bytes = std::as_bytes(std::span{text});
+	blob.insert(std::end(blob), std::begin(bytes), std::end(bytes));
+}
+
+void pad(std::vector<std::byte>& blob)
+{
+	blob.resize(assets::align_to_pack(std::size(blob)));
+}
+
+auto read_file(std::filesystem::path const& path) -> std::string
+{
+	std::ifstream file{path, std::ios::binary};
+	if (!file)
+	{
+		throw std::runtime_error{"failed to open " + path.string()};
+	}
+
+	std::stringstream contents{};
+	contents << file.rdbuf();
+	return contents.str();
+}
+
+auto cook_texture(std::string const& path, bool compress) -> cooked_entry
+{
+	auto picture = yaboc::graphics::load_png(path);
+	if (!picture)
+	{
+		throw std::runtime_error{"failed to load " + path};
+	}
+
+	// The whole chain, down to 1x1.
+	std::vector<yaboc::graphics::image> levels{};
+	levels.push_back(std::move(*picture));
+	while (levels.back().width > 1 || levels.back().height > 1)
+	{
+		levels.push_back(yaboc::graphics::downsample(levels.back()));
+	}
+
+	// BPTC needs whole blocks at the top level; the levels below round up.
+	using yaboc::cook::bc7_block_dimension;
+	auto const whole_blocks =
+	    levels.front().width % bc7_block_dimension == 0 &&
+	    levels.front().height % bc7_block_dimension == 0;
+	auto const format = compress && whole_blocks
+	                        ? assets::texture_format::bc7
+	                        : assets::texture_format::rgba8;
+
+	std::vector<std::vector<std::byte>> texels{};
+	for (auto const& level: levels)
+	{
+		if (format == assets::texture_format::bc7)
+		{
+			texels.push_back(yaboc::cook::encode_bc7(level));
+		}
+		else
+		{
+			auto const bytes = std::as_bytes(std::span{level.pixels});
+			texels.emplace_back(std::begin(bytes), std::end(bytes));
+		}
+	}
+
+	cooked_entry entry{.name = path, .kind = assets::pack_entry_kind::texture};
+	append(entry.blob,
+	       assets::packed_texture_header{
+	           .format = format,
+	           .width = levels.front().width,
+	           .height = levels.front().height,
+	           .level_count = static_cast<std::uint32_t>(std::size(levels))});
+
+	auto offset = assets::align_to_pack(
+	    std::size(entry.blob) +
+	    std::size(levels) * sizeof(assets::packed_texture_level));
+	for (std::size_t index{}; index < std::size(levels); ++index)
+	{
+		append(entry.blob,
+		       assets::packed_texture_level{.width = levels[index].width,
+		                                    .height = levels[index].height,
+		                                    .offset = offset,
+		                                    .size = std::size(texels[index])});
+		offset = assets::align_to_pack(offset + std::size(texels[index]));
+	}
+
+	for (auto const& level: texels)
+	{
+		pad(entry.blob);
+		entry.blob.insert(std::end(entry.blob),
+		                  std::begin(level),
+		                  std::end(level));
+	}
+	return entry;
+}
+
+// The frame table, and the texture it refers to.
+auto cook_sprite_sheet(std::string const& path, bool compress)
+    -> std::vector<cooked_entry>
+{
+	yaboc::sprite::sprite_sheet const sheet{std::string{path}};
+	auto const&                       meta_data = sheet.meta_data();
+
+	std::string names{};
+	names += meta_data.name;
+
+	std::vector<assets::packed_frame> frames{};
+	for (std::size_t id{}; id < sheet.frame_count(); ++id)
+	{
+		auto const& frame = sheet.frame_data(id);
+		frames.push_back(assets::packed_frame{
+		    .min_x = frame.bounds.min.x,
+		    .min_y = frame.bounds.min.y,
+		    .max_x = frame.bounds.max.x,
+		    .max_y = frame.bounds.max.y,
+		    .size_x = frame.size.x,
+		    .size_y = frame.size.y,
+		    .name_offset = static_cast<std::uint32_t>(std::size(names)),
+		    .name_size = static_cast<std::uint32_t>(std::size(frame.name))});
+		names += frame.name;
+	}
+
+	cooked_entry table{.name = path,
+	                   .kind = assets::pack_entry_kind::sprite_frames};
+	append(table.blob,
+	       assets::packed_frame_table_header{
+	           .frame_count = static_cast<std::uint32_t>(std::size(frames)),
+	           .names_size = static_cast<std::uint32_t>(std::size(names)),
+	           .texture_name_offset = 0,
+	           .texture_name_size =
+	               static_cast<std::uint32_t>(std::size(meta_data.name)),
+	           .width = meta_data.dimensions.x,
+	           .height = meta_data.dimensions.y});
+	for (auto const& frame: frames)
+	{
+		append(table.blob, frame);
+	}
+	append(table.blob, names);
+
+	std::vector<cooked_entry> entries{};
+	entries.push_back(std::move(table));
+	entries.push_back(cook_texture(meta_data.name, compress));
+	return entries;
+}
+
+auto cook_level(std::string const& path) -> cooked_entry
+{
+	std::istringstream text{read_file(path)};
+	auto const         level = assets::parse_level(text);
+
+	cooked_entry entry{.name = path, .kind = assets::pack_entry_kind::level};
+	append(entry.blob,
+	       assets::packed_level_header{.columns = level.columns,
+	                                   .rows = level.rows});
+	auto const cells = std::as_bytes(std::span{level.cells});
+	entry.blob.insert(std::end(entry.blob), std::begin(cells), std::end(cells));
+	return entry;
+}
+
+auto cook_shader(std::string const& path) -> cooked_entry
+{
+	cooked_entry entry{.name = path, .kind = assets::pack_entry_kind::shader};
+	append(entry.blob, read_file(path));
+	entry.blob.push_back(std::byte{});
+	return entry;
+}
+
+auto cook(std::string const& path, bool compress) -> std::vector<cooked_entry>
+{
+	auto const extension = std::filesystem::path{path}.extension();
+	if (extension == ".json")
+	{
+		return cook_sprite_sheet(path, compress);
+	}
+	if (extension == ".txt")
+	{
+		return {cook_level(path)};
+	}
+	if (extension == ".glsl")
+	{
+		return {cook_shader(path)};
+	}
+	throw std::runtime_error{"do not know how to cook " + path};
+}
+
+void write_pack(std::filesystem::path const& output,
+                std::vector<cooked_entry>&   entries)
+{
+	std::ranges::sort(entries, {}, &cooked_entry::name);
+	auto const duplicate = std::ranges::adjacent_find(entries,
+	                                                  {},
+	                                                  &cooked_entry::name);
+	if (duplicate != std::end(entries))
+	{
+		throw std::runtime_error{"cooked twice: " + duplicate->name};
+	}
+
+	std::vector<std::byte> pack{};
+	append(pack, assets::pack_header{});
+
+	std::vector<assets::pack_entry> directory{};
+	std::string                     names{};
+	for (auto const& entry: entries)
+	{
+		pad(pack);
+		directory.push_back(assets::pack_entry{
+		    .name_offset = static_cast<std::uint32_t>(std::size(names)),
+		    .name_size = static_cast<std::uint32_t>(std::size(entry.name)),
+		    .kind = entry.kind,
+		    .offset = std::size(pack),
+		    .size = std::size(entry.blob)});
+		names += entry.name;
+		pack.insert(std::end(pack),
+		            std::begin(entry.blob),
+		            std::end(entry.blob));
+	}
+
+	pad(pack);
+	assets::pack_header const header{
+	    .entry_count = static_cast<std::uint32_t>(std::size(directory)),
+	    .names_size = static_cast<std::uint32_t>(std::size(names)),
+	    .directory_offset = std::size(pack)};
+	std::memcpy(std::data(pack), &header, sizeof(header));
+
+	for (auto const& entry: directory)
+	{
+		append(pack, entry);
+	}
+	append(pack, names);
+
+	// Never leave half a pack behind for the game to find.
+	auto staging = output;
+	staging += ".tmp";
+	{
+		std::ofstream file{staging, std::ios::binary | std::ios::trunc};
+		file.write(reinterpret_cast<char const*>(std::data(pack)),
+		           static_cast<std::streamsize>(std::size(pack)));
+		if (!file)
+		{
+			throw std::runtime_error{"failed to write " + staging.string()};
+		}
+	}
+	std::filesystem::rename(staging, output);
+}
+} // namespace
+
+auto main(int argc, char* argv[]) -> int
+{
+	std::span arguments{argv, static_cast<std::size_t>(argc)};
+	auto const* program = arguments[0];
+	arguments = arguments.subspan(1);
+
+	// Textures are compressed to BC7 unless asked not to.
+	bool compress{true};
+	if (!std::empty(arguments) && arguments[0] == std::string_view{"--rgba8"})
+	{
+		compress = false;
+		arguments = arguments.subspan(1);
+	}
+
+	if (std::size(arguments) < 2)
+	{
+		std::cerr << "usage: " << program
+		          << " [--rgba8] OUTPUT INPUT...\n"
+		             "  --rgba8 store textures uncompressed instead of as BC7\n"
+		             "  *.json  a TexturePacker sprite sheet and its image\n"
+		             "  *.txt   a level\n"
+		             "  *.glsl  a shader\n";
+		return 2;
+	}
+
+	try
+	{
+		std::vector<cooked_entry> entries{};
+		for (auto const* input: arguments.subspan(1))
+		{
+			auto cooked = cook(input, compress);
+			std::ranges::move(cooked, std::back_inserter(entries));
+		}
+		write_pack(arguments[0], entries);
+	}
+	catch (std::exception const& error)
+	{
+		std::cerr << error.what() << '\n';
+		return 1;
+	}
+	return 0;
+}